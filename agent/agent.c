@@ -0,0 +1,191 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/*
+ * Agent library loaded into the tracee either through LD_PRELOAD at
+ * launch or dlopen() from an inferior call. It maps the channel created
+ * by the debugger and serves requests from its own thread, so that bulk
+ * reads, counters and trace records need no ptrace stop at all.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include "agent_abi.h"
+#include "bkpt_agent.h"
+
+static struct bkpt_agent_channel *g_channel = NULL;
+
+static void serve_request(struct bkpt_agent_channel *ch)
+{
+    uint64_t seq = __atomic_load_n(&ch->req_seq, __ATOMIC_ACQUIRE);
+    if (seq == __atomic_load_n(&ch->resp_seq, __ATOMIC_RELAXED))
+        return;
+
+    int64_t status = 0;
+    switch (ch->op)
+    {
+        case BKPT_AGENT_OP_PING:
+            status = 0;
+            break;
+
+        case BKPT_AGENT_OP_READ:
+        {
+            if (ch->len > ch->data_size)
+            {
+                status = -EINVAL;
+                break;
+            }
+
+            /* Reading through the kernel turns bad addresses into
+             * EFAULT instead of crashing the process we live in */
+            struct iovec local = { ch->data, ch->len };
+            struct iovec remote = { (void *)(uintptr_t) ch->addr, ch->len };
+            ssize_t ret = process_vm_readv(getpid(), &local, 1, &remote, 1, 0);
+            status = (ret < 0) ? -errno : ret;
+            break;
+        }
+
+        default:
+            status = -ENOSYS;
+            break;
+    }
+
+    ch->status = status;
+    __atomic_store_n(&ch->resp_seq, seq, __ATOMIC_RELEASE);
+}
+
+static void *service_thread(void *arg)
+{
+    struct bkpt_agent_channel *ch = arg;
+    uint64_t ticks = 0;
+
+    for (;;)
+    {
+        ssize_t ret = read(ch->doorbell_fd, &ticks, sizeof(ticks));
+        if (ret < 0 && errno != EINTR)
+            break;
+
+        serve_request(ch);
+    }
+
+    return NULL;
+}
+
+__attribute__((constructor))
+static void bkpt_agent_init(void)
+{
+    char name[64];
+    snprintf(name, sizeof(name), BKPT_AGENT_NAME_FMT, (int) getpid());
+
+    /* No channel means no debugger asked for us, stay dormant */
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+        return;
+
+    void *mem = mmap(NULL, sizeof(struct bkpt_agent_channel),
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED)
+        return;
+
+    struct bkpt_agent_channel *ch = mem;
+    if (ch->magic != BKPT_AGENT_MAGIC || ch->version != BKPT_AGENT_VERSION)
+    {
+        munmap(mem, sizeof(*ch));
+        return;
+    }
+
+    ch->doorbell_fd = eventfd(0, EFD_CLOEXEC);
+    if (ch->doorbell_fd < 0)
+    {
+        munmap(mem, sizeof(*ch));
+        return;
+    }
+
+    /* Keep every signal on the application's own threads */
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&tid, &attr, service_thread, ch);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err != 0)
+    {
+        close(ch->doorbell_fd);
+        munmap(mem, sizeof(*ch));
+        return;
+    }
+
+    g_channel = ch;
+    __atomic_store_n(&ch->ready, 1, __ATOMIC_RELEASE);
+}
+
+void bkpt_agent_counter_add(unsigned index, uint64_t delta)
+{
+    struct bkpt_agent_channel *ch = g_channel;
+    if (ch == NULL || index >= BKPT_AGENT_COUNTERS)
+        return;
+
+    __atomic_fetch_add(&ch->counters[index], delta, __ATOMIC_RELAXED);
+}
+
+void bkpt_agent_trace(uint64_t id, uint64_t value)
+{
+    struct bkpt_agent_channel *ch = g_channel;
+    if (ch == NULL)
+        return;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t slot = __atomic_fetch_add(&ch->trace_head, 1, __ATOMIC_RELAXED);
+    struct bkpt_agent_record *rec = &ch->trace[slot % BKPT_AGENT_TRACE_SLOTS];
+
+    /* Invalidate before rewriting so a reader racing a lapping
+     * producer never accepts a half written record */
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->timestamp_ns = (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+    rec->id = id;
+    rec->value = value;
+    __atomic_store_n(&rec->seq, slot + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,49 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_AGENT_H
+#define BKPT_AGENT_H
+
+/*
+ * Hooks for code running under the breakpoint agent. Declare them weak
+ * so the same binary still runs when the agent is not loaded:
+ *
+ *     if (bkpt_agent_trace)
+ *         bkpt_agent_trace(id, value);
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void bkpt_agent_counter_add(unsigned index, uint64_t delta) __attribute__((weak));
+void bkpt_agent_trace(uint64_t id, uint64_t value) __attribute__((weak));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -120,15 +120,168 @@ const Command cmd_breakpoint[] = {
     {"",            Action::Invalid,    nullptr}
 };
 
+const Command cmd_agent_load[] = {
+    {"",            Action::AgentLoad,  nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_agent_read_address[] = {
+    {"",            Action::AgentReadCnt, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_agent_read[] = {
+    {"",            Action::AgentReadDef, cmd_agent_read_address},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_agent[] = {
+    {"counters",    Action::AgentCounters, nullptr},
+    {"load",        Action::AgentLoad,  cmd_agent_load},
+    {"read",        Action::Incomplete, cmd_agent_read},
+    {"status",      Action::AgentStatus, nullptr},
+    {"trace",       Action::AgentTrace, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_thread_select[] = {
+    {"",            Action::ThreadSelect, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_thread[] = {
+    {"list",        Action::ThreadList, nullptr},
+    {"select",      Action::Incomplete, cmd_thread_select},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_process_select[] = {
+    {"",            Action::ProcessSelect, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_process_follow[] = {
+    {"",            Action::ProcessFollow, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_process[] = {
+    {"follow",      Action::Incomplete, cmd_process_follow},
+    {"list",        Action::ProcessList, nullptr},
+    {"select",      Action::Incomplete, cmd_process_select},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_step_until[] = {
+    {"",            Action::StepUntil,  nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_step_while_low[] = {
+    {"",            Action::StepWhile,  nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_step_while[] = {
+    {"",            Action::Incomplete, cmd_step_while_low},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_step[] = {
+    {"until",       Action::Incomplete, cmd_step_until},
+    {"while",       Action::Incomplete, cmd_step_while},
+    {"",            Action::StepCount,  nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_step_until[] = {
+    {"",            Action::ProfileStepUntil, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_step[] = {
+    {"until",       Action::Incomplete, cmd_profile_step_until},
+    {"",            Action::ProfileStep, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_sample_format[] = {
+    {"folded",      Action::ProfileSampleFolded, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_sample[] = {
+    {"",            Action::ProfileSample, cmd_profile_sample_format},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_wall_freq[] = {
+    {"",            Action::ProfileWallFreq, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile_wall[] = {
+    {"",            Action::ProfileWall, cmd_profile_wall_freq},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_profile[] = {
+    {"sample",      Action::Incomplete, cmd_profile_sample},
+    {"step",        Action::Incomplete, cmd_profile_step},
+    {"wall",        Action::Incomplete, cmd_profile_wall},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_syscall_trace[] = {
+    {"",            Action::SyscallTraceSel, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_syscall_stats[] = {
+    {"",            Action::SyscallStatsSel, nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_syscall[] = {
+    {"log",         Action::SyscallLog, nullptr},
+    {"off",         Action::SyscallOff, nullptr},
+    {"stats",       Action::SyscallStats, cmd_syscall_stats},
+    {"trace",       Action::SyscallTrace, cmd_syscall_trace},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_signal_set[] = {
+    {"",            Action::SignalSet,  nullptr},
+    {"",            Action::Invalid,    nullptr}
+};
+
+const Command cmd_signal[] = {
+    {"",            Action::SignalShow, cmd_signal_set},
+    {"",            Action::Invalid,    nullptr}
+};
+
 const Command top_level[] = {
+    {"agent",       Action::Incomplete, cmd_agent},
+    {"all",         Action::Broadcast,  nullptr},
+    {"backtrace",   Action::Backtrace,  nullptr},
     {"breakpoint",  Action::Incomplete, cmd_breakpoint},
+    {"call",        Action::Call,       nullptr},
     {"continue",    Action::Continue,   nullptr},
     {"disassemble", Action::Disassmbl,  cmd_disassmbl},
+    {"finish",      Action::StepOut,    nullptr},
     {"help",        Action::Help,       nullptr},
+    {"interrupt",   Action::Interrupt,  nullptr},
     {"memory",      Action::Incomplete, cmd_memory},
+    {"next",        Action::StepOver,   nullptr},
+    {"process",     Action::Incomplete, cmd_process},
+    {"profile",     Action::Incomplete, cmd_profile},
     {"register",    Action::Incomplete, cmd_register},
     {"quit",        Action::Quit,       nullptr},
-    {"step",        Action::StepInst,   nullptr},
+    {"signal",      Action::SignalList, cmd_signal},
+    {"step",        Action::StepLine,   nullptr},
+    {"stepi",       Action::StepInst,   cmd_step},
+    {"syscall",     Action::Incomplete, cmd_syscall},
+    {"thread",      Action::Incomplete, cmd_thread},
     {"",            Action::Invalid,    nullptr}
 };
 
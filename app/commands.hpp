@@ -41,8 +41,44 @@ enum class Action
     MemReadCnt,
     MemWrite,
     Incomplete,
+    AgentLoad,
+    AgentStatus,
+    AgentReadDef,
+    AgentReadCnt,
+    AgentCounters,
+    AgentTrace,
+    Call,
+    Interrupt,
+    ThreadList,
+    ThreadSelect,
+    ProcessList,
+    ProcessSelect,
+    ProcessFollow,
+    Broadcast,
     Continue,
+    StepLine,
+    StepOver,
+    StepOut,
     StepInst,
+    StepCount,
+    StepUntil,
+    StepWhile,
+    ProfileStep,
+    ProfileStepUntil,
+    ProfileSample,
+    ProfileSampleFolded,
+    ProfileWall,
+    ProfileWallFreq,
+    SyscallTrace,
+    SyscallTraceSel,
+    SyscallLog,
+    SyscallOff,
+    SyscallStats,
+    SyscallStatsSel,
+    SignalList,
+    SignalShow,
+    SignalSet,
+    Backtrace,
     Disassmbl,
     Disassmbl1,
     Disassmbl2,
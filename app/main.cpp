@@ -22,12 +22,19 @@
  *
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 #include <charconv>
 #include <cstring>
 #include <type_traits>
+#include <memory>
+#include <filesystem>
+#include <cxxabi.h>
+#include <termios.h>
+#include <sys/socket.h>
 
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -37,15 +44,108 @@
 #include "error.hpp"
 #include "process.hpp"
 #include "disassembler.hpp"
+#include "agent.hpp"
+#include "event_loop.hpp"
+#include "session_manager.hpp"
+#include "step_profiler.hpp"
+#include "perf_sampler.hpp"
+#include "wall_sampler.hpp"
+#include "source_stepper.hpp"
 
 #define COMMANDS_HISTORY "/tmp/breakpoint.txt"
 
 using ProcessPtr = std::unique_ptr<Process>;
+using AgentPtr = std::unique_ptr<Agent>;
+
+// Everything a command may act upon for the debugged processes
+struct DebugContext
+{
+    SessionManager sessions;
+    AgentPtr agent;
+    EventLoop loop;
+
+    // Line being edited, asynchronous output is printed above it
+    linenoiseState *prompt = nullptr;
+
+    // Debugger end of the tracee stdio when it is captured
+    int output_fd = -1;
+};
 
 void print_usage(std::string_view exe_name)
 {
-    std::cout << "Usage: " << exe_name << " -p <pid>\n"
-              << "Usage: " << exe_name << "<executable-file> [args]" << std::endl;
+    std::cout << "Usage: " << exe_name << " [options] -p <pid[,pid...]|pattern>\n"
+              << "Usage: " << exe_name << " [options] <executable-file> [args]\n"
+              << "Options:\n"
+              << "  --agent    Preload the agent library into the launched program\n"
+              << "  --capture  Route the launched program's stdio through the debugger\n"
+              << "  --seize    Attach without stopping the process\n"
+              << "  --non-stop Stop only the thread that hit a breakpoint\n"
+              << "  --follow-fork Trace forked children instead of detaching them\n"
+              << "  --stop-at <exec|entry|main|none> Where the launched program is handed over\n"
+              << "  --break <location> Breakpoint set before the program moves on, repeatable\n"
+              << "  --trace-syscalls <name[,name...]> Stop the launched program on these system\n"
+              << "             calls only and log them, forked children are followed"
+              << std::endl;
+}
+
+StopAt parse_stop_at(std::string_view arg)
+{
+    if (arg == "exec")
+        return StopAt::Exec;
+    if (arg == "entry")
+        return StopAt::Entry;
+    if (arg == "main")
+        return StopAt::Main;
+    if (arg == "none")
+        return StopAt::None;
+    throw std::invalid_argument("Unknown stop [" + std::string(arg) + "], use exec, entry, main or none");
+}
+
+std::string demangle(std::string_view name)
+{
+    std::string mangled(name);
+    int status = 0;
+    char *plain = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+    if (status != 0 || plain == nullptr)
+        return mangled;
+
+    std::string res(plain);
+    std::free(plain);
+    return res;
+}
+
+// "file.c:12" for an address with a line table row
+std::string source_label(ProcessPtr &proc, virt_addr addr)
+{
+    auto entry = proc->source_line(addr);
+    if (!entry || entry->file.empty())
+        return {};
+
+    std::string file = std::filesystem::path(entry->file).filename().string();
+    return fmt::format("{}:{}", file, entry->line);
+}
+
+// "name+0x10" for an address inside a symbol of the executable
+std::string symbol_label(ProcessPtr &proc, virt_addr addr, bool with_offset = true)
+{
+    auto sym = proc->symbolize(addr);
+    if (!sym)
+        return {};
+
+    std::string label = demangle(sym->first->name);
+    if (with_offset && sym->second != 0)
+        label += fmt::format("+{:#x}", sym->second);
+    return label;
+}
+
+// "USR1" or "RTMIN+3", real-time signals have no abbreviation of their own
+std::string signal_name(int signo)
+{
+    if (signo >= SIGRTMIN && signo <= SIGRTMAX)
+        return signo == SIGRTMIN ? "RTMIN" : fmt::format("RTMIN+{}", signo - SIGRTMIN);
+
+    const char *name = sigabbrev_np(signo);
+    return name ? name : std::to_string(signo);
 }
 
 void print_stop_reason(ProcessPtr &proc, std::uint8_t ret)
@@ -56,17 +156,63 @@ void print_stop_reason(ProcessPtr &proc, std::uint8_t ret)
             fmt::println("Process exited with status {}", static_cast<int>(ret));
             break;
         case ProcessState::Terminated:
-            fmt::println("Process terminated with signal {}", sigabbrev_np(ret));
+            fmt::println("Process terminated with signal {}", signal_name(ret));
             break;
         case ProcessState::Stopped:
-            fmt::println("Process stopped with signal {} at {:#016x}",
-                sigabbrev_np(ret), proc->get_pc());
+            if (proc->stop_reason() == StopReason::Exec)
+                fmt::println("Process {} is executing new program {}",
+                    proc->get_pid(), proc->exe_path());
+            else
+            {
+                virt_addr pc = proc->get_pc();
+                std::string label = symbol_label(proc, pc);
+                if (label.empty() == false)
+                    label = " <" + label + ">";
+
+                if (proc->threads().size() > 1)
+                    fmt::println("Thread {} stopped with signal {} at {:#016x}{}",
+                        proc->current_thread(), signal_name(ret), pc, label);
+                else
+                    fmt::println("Process stopped with signal {} at {:#016x}{}",
+                        signal_name(ret), pc, label);
+            }
             break;
         default:
             break;
     }
 }
 
+// Prints while a line is being edited, linenoise raw mode turns output
+// post processing off so it is switched back on for the duration
+template <typename F>
+void print_async(DebugContext &ctx, F &&print)
+{
+    if (ctx.prompt == nullptr)
+    {
+        print();
+        std::fflush(stdout);
+        return;
+    }
+
+    termios saved;
+    bool tty = (tcgetattr(STDOUT_FILENO, &saved) == 0);
+    linenoiseHide(ctx.prompt);
+    if (tty)
+    {
+        termios cooked = saved;
+        cooked.c_oflag |= OPOST;
+        tcsetattr(STDOUT_FILENO, TCSADRAIN, &cooked);
+    }
+
+    print();
+    std::cout.flush();
+    std::fflush(stdout);
+
+    if (tty)
+        tcsetattr(STDOUT_FILENO, TCSADRAIN, &saved);
+    linenoiseShow(ctx.prompt);
+}
+
 bool sv_is_hex(std::string_view sv)
 {
     return (sv.size() >= 2) && (sv[0] == '0') && (sv[1] == 'x' || sv[1] == 'X');
@@ -143,6 +289,147 @@ parse_vector(std::string_view token)
     return bytes;
 }
 
+std::string_view trim(std::string_view sv)
+{
+    std::size_t start = sv.find_first_not_of(" \t");
+    if (start == std::string_view::npos)
+        return {};
+
+    std::size_t end = sv.find_last_not_of(" \t");
+    return sv.substr(start, end - start + 1);
+}
+
+RegisterValue parse_call_argument(std::string_view token)
+{
+    if (token.empty())
+        throw std::invalid_argument("Empty call argument");
+
+    if (sv_is_hex(token) == false && token.find('.') != std::string_view::npos)
+    {
+        bool is_float = (token.back() == 'f' || token.back() == 'F');
+        std::string buf(is_float ? token.substr(0, token.size() - 1) : token);
+        try
+        {
+            if (is_float)
+                return std::stof(buf);
+            return std::stod(buf);
+        }
+        catch (const std::exception &)
+        {
+            throw std::invalid_argument("Invalid floating point argument");
+        }
+    }
+
+    if (token[0] == '-')
+    {
+        std::int64_t val = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), val);
+        if (ec != std::errc{} || ptr != token.data() + token.size())
+            throw std::invalid_argument("Invalid signed argument");
+        return static_cast<std::uint64_t>(val);
+    }
+
+    return to_positive_integral(token);
+}
+
+// Parses "<target>(arg, arg, ...)", the argument list may be omitted
+std::pair<std::string_view, std::vector<RegisterValue>>
+parse_call_expression(std::string_view expr)
+{
+    std::vector<RegisterValue> args;
+    std::size_t open = expr.find('(');
+    if (open == std::string_view::npos)
+        return {trim(expr), args};
+
+    if (trim(expr).back() != ')')
+        throw std::invalid_argument("Missing ')' in call expression");
+
+    std::string_view target = trim(expr.substr(0, open));
+    std::string_view list = trim(expr.substr(open + 1));
+    list = trim(list.substr(0, list.size() - 1));
+
+    while (list.empty() == false)
+    {
+        std::size_t comma = list.find(',');
+        args.push_back(parse_call_argument(trim(list.substr(0, comma))));
+        if (comma == std::string_view::npos)
+            break;
+        list = list.substr(comma + 1);
+    }
+
+    return {target, args};
+}
+
+// An integer, "file:line" or a symbol, optionally "symbol+offset", or
+// "module+offset" from the load bias of a module
+virt_addr to_address(const ProcessPtr &proc, std::string_view token)
+{
+    if (token.empty() == false && std::isdigit(static_cast<unsigned char>(token[0])))
+        return to_positive_integral(token);
+
+    // A :: belongs to a qualified function name, file:line ends in digits
+    std::size_t colon = token.rfind(':');
+    if (colon != std::string_view::npos && colon > 0 && token[colon - 1] != ':' &&
+        colon + 1 < token.size() && std::isdigit(static_cast<unsigned char>(token[colon + 1])))
+    {
+        std::string_view file = token.substr(0, colon);
+        auto line = static_cast<std::uint32_t>(to_positive_integral(token.substr(colon + 1)));
+        auto addresses = proc->line_addresses(file, line);
+        if (addresses.empty())
+            throw std::invalid_argument("No code at " + std::string(token));
+        return addresses.front();
+    }
+
+    std::string_view name = token;
+    virt_addr offset = 0;
+    std::size_t plus = token.rfind('+');
+    if (plus != std::string_view::npos && plus + 1 < token.size() &&
+        std::isdigit(static_cast<unsigned char>(token[plus + 1])))
+    {
+        name = token.substr(0, plus);
+        offset = to_positive_integral(token.substr(plus + 1));
+    }
+
+    auto address = proc->symbol_address(name);
+    if (!address && name.size() != token.size())
+        address = proc->load_bias(name);
+    if (!address)
+    {
+        // Qualified names resolve once the background indexing is done
+        const DwarfIndex *index = proc->dwarf_index();
+        if (index != nullptr && index->ready() == false)
+            throw std::invalid_argument("No symbol named " + std::string(name) +
+                                        " yet, the debug info is still being indexed");
+        throw std::invalid_argument("No symbol named " + std::string(name));
+    }
+    return *address + offset;
+}
+
+// A symbol no loaded module defines yet is left pending until the
+// loader brings one in
+void set_breakpoint(ProcessPtr &proc, std::string_view token, bool hardware)
+{
+    virt_addr address = 0;
+    try
+    {
+        address = to_address(proc, token);
+    }
+    catch (const std::invalid_argument &)
+    {
+        bool symbol = token.empty() == false &&
+            std::isdigit(static_cast<unsigned char>(token[0])) == false &&
+            token.find_first_of("+ ") == std::string_view::npos;
+        if (symbol == false || proc->modules().active() == false)
+            throw;
+
+        const PendingBreakpoint &bp = proc->modules().add_breakpoint(std::string(token), hardware);
+        if (bp.address == 0)
+            fmt::println("Breakpoint pending on {}", bp.symbol);
+        return;
+    }
+    proc->create_breakpoint_site(address, hardware).enable();
+}
+
 void display_register(const RegisterID id, const RegisterValue& val)
 {
     fmt::print("{:<6}: ", get_register_name(id));
@@ -219,13 +506,177 @@ void display_disassembly(ProcessPtr &proc, virt_addr addr = 0, std::size_t count
     auto insn = dis.disassemble(count, addr);
     for (auto &ins : insn)
     {
-        fmt::print("{:#018x}: {}\n", ins.addr, ins.text);
+        std::string label = symbol_label(proc, ins.addr);
+        if (label.empty())
+            fmt::print("{:#018x}: {}\n", ins.addr, ins.text);
+        else
+            fmt::print("{:#018x} <{}>: {}\n", ins.addr, label, ins.text);
+    }
+}
+
+void report_stop(ProcessPtr &proc, std::uint8_t ret)
+{
+    print_stop_reason(proc, ret);
+    if (proc->get_state() != ProcessState::Stopped)
+        return;
+
+    std::string source = source_label(proc, proc->get_pc());
+    if (source.empty() == false)
+        fmt::println("  at {}", source);
+    display_disassembly(proc);
+}
+
+void report_steps(ProcessPtr &proc, const StepResult &res)
+{
+    double rate = (res.seconds > 0) ? (res.steps / res.seconds) : 0;
+    fmt::println("Stepped {} instructions in {:.3f}s ({:.0f} steps/s)",
+        res.steps, res.seconds, rate);
+    if (res.end == StepEnd::Breakpoint)
+        fmt::println("Stopped before an enabled breakpoint");
+    report_stop(proc, res.info);
+}
+
+std::string describe_instruction(ProcessPtr &proc, virt_addr pc)
+{
+    // Memory is gone once the process ended
+    if (proc->get_state() == ProcessState::Exited ||
+        proc->get_state() == ProcessState::Terminated)
+        return "??";
+
+    try
+    {
+        Disassembler dis(*proc);
+        auto insn = dis.disassemble(1, pc);
+        return insn.empty() ? std::string("??") : insn[0].text;
+    }
+    catch (const Error &)
+    {
+        return "??";
+    }
+}
+
+void display_hot_instructions(ProcessPtr &proc, const PcHistogram &histogram,
+    double total, std::size_t top)
+{
+    auto entries = histogram.sorted();
+    for (std::size_t i = 0; i < entries.size() && i < top; i++)
+    {
+        const auto &entry = entries[i];
+        fmt::println("{:>12} {:>6.2f}%  {:#018x} {:<24} {}", entry.count,
+            100.0 * entry.count / total, entry.pc, symbol_label(proc, entry.pc),
+            describe_instruction(proc, entry.pc));
+    }
+}
+
+void display_backtrace(ProcessPtr &proc)
+{
+    auto frames = proc->unwinder().unwind();
+    for (std::size_t i = 0; i < frames.size(); i++)
+    {
+        // Return addresses point past the call, one byte back is the call
+        // whose function and line are shown, the offset stays that of pc
+        virt_addr lookup = (i == 0) ? frames[i].pc : frames[i].pc - 1;
+        std::string label;
+        if (auto sym = proc->symbolize(lookup))
+        {
+            virt_addr offset = sym->second + (frames[i].pc - lookup);
+            label = demangle(sym->first->name);
+            if (offset != 0)
+                label += fmt::format("+{:#x}", offset);
+        }
+        std::string source = source_label(proc, lookup);
+        fmt::println("#{:<3} {:#018x} {}{}", i, frames[i].pc, label,
+            source.empty() ? "" : " at " + source);
+    }
+}
+
+// Instruction mix followed by the hottest instructions, disassembled
+void display_step_profile(ProcessPtr &proc, const StepProfiler &profiler,
+    std::size_t top = 20)
+{
+    double total = static_cast<double>(profiler.total());
+    if (profiler.total() == 0)
+        return;
+
+    fmt::println("Instruction mix:");
+    for (std::size_t i = 0; i < static_cast<std::size_t>(InsnClass::Count); i++)
+    {
+        auto cls = static_cast<InsnClass>(i);
+        std::uint64_t count = profiler.class_count(cls);
+        if (count != 0)
+            fmt::println("  {:<8} {:>12} {:>6.2f}%",
+                insn_class_name(cls), count, 100.0 * count / total);
+    }
+
+    fmt::println("Hottest of {} distinct instructions:", profiler.histogram().size());
+    display_hot_instructions(proc, profiler.histogram(), total, top);
+}
+
+// One line per stack, outermost frame first as flame graph tools expect
+// Frames are named by function, addresses without a symbol stay as is
+void display_folded(ProcessPtr &proc, const StackCounts &stacks)
+{
+    for (const auto &[chain, count] : stacks)
+    {
+        std::string line;
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+        {
+            if (line.empty() == false)
+                line += ';';
+            std::string name = symbol_label(proc, *it, false);
+            line += name.empty() ? fmt::format("{:#x}", *it) : name;
+        }
+        fmt::println("{} {}", line, count);
+    }
+}
+
+void display_samples(ProcessPtr &proc, const PerfSampler &sampler, bool folded,
+    std::size_t top = 20)
+{
+    fmt::println("{} samples, {} lost", sampler.samples(), sampler.lost());
+    if (sampler.samples() == 0)
+        return;
+
+    if (folded == false)
+    {
+        display_hot_instructions(proc, sampler.histogram(),
+            static_cast<double>(sampler.samples()), top);
+        return;
     }
+
+    display_folded(proc, sampler.stacks());
+}
+
+// Names the process as well once more than one is debugged, a process
+// that ended makes way for one of the same session that is still alive
+void report_event(DebugContext &ctx, Session &session, std::uint8_t ret)
+{
+    ProcessPtr &proc = session.current();
+    if (session.size() > 1 || ctx.sessions.tracers().size() > 1)
+        fmt::print("[process {}] ", proc->get_pid());
+    report_stop(proc, ret);
+
+    if (session.size() < 2 ||
+        (proc->get_state() != ProcessState::Exited &&
+         proc->get_state() != ProcessState::Terminated))
+        return;
+
+    // The agent lives inside one process and goes away with it
+    if (ctx.agent && &ctx.agent->process() == proc.get())
+        ctx.agent.reset();
+
+    if (session.prune())
+        fmt::println("Switched to process {}", session.current()->get_pid());
 }
 
 void display_breakpoints(ProcessPtr &proc)
 {
-    if (proc->breakpoint_sites().empty())
+    bool any = proc->modules().breakpoints().empty() == false;
+    proc->breakpoint_sites().for_each([&](BreakpointSite &site)
+    {
+        any = any || site.is_internal() == false;
+    });
+    if (any == false)
     {
         fmt::println("No breakpoints set");
         return;
@@ -243,79 +694,700 @@ void display_breakpoints(ProcessPtr &proc)
     };
 
     proc->breakpoint_sites().for_each(func);
+
+    for (const auto &bp : proc->modules().breakpoints())
+    {
+        if (bp.address == 0)
+            fmt::println("-: {} pending{}", bp.symbol, bp.hardware ? ", hardware" : "");
+    }
 }
 
-bool handle_command(std::string_view line, ProcessPtr &proc)
+void display_threads(ProcessPtr &proc)
 {
-    auto [action, tokens] = process_line(line);
+    pid_t current = proc->current_thread();
+    for (const auto &[tid, thread] : proc->threads())
+    {
+        if (thread.state != ProcessState::Stopped)
+        {
+            fmt::println("{} {:<8} running", tid == current ? '*' : ' ', tid);
+            continue;
+        }
 
-    if (action == Action::Quit)
+        // Registers of other threads are fetched on first selection
+        proc->select_thread(tid);
+        virt_addr pc = proc->registers().read<std::uint64_t>(RegisterID::REG64_PC);
+        fmt::println("{} {:<8} {:#018x} {}",
+            tid == current ? '*' : ' ', tid, pc,
+            thread.stop_info ? signal_name(thread.stop_info) : "-");
+    }
+
+    if (proc->current_thread() != current)
+        proc->select_thread(current);
+}
+
+std::string_view state_name(ProcessState state)
+{
+    switch (state)
     {
-        return false;
+        case ProcessState::Stopped:    return "stopped";
+        case ProcessState::Running:    return "running";
+        case ProcessState::Exited:     return "exited";
+        case ProcessState::Terminated: return "terminated";
+        default:                       return "-";
     }
-    else if (action == Action::None)
+}
+
+pid_t current_pid(DebugContext &ctx)
+{
+    return ctx.sessions.current().run([](Session &session)
     {
-        return true;
+        return session.current()->get_pid();
+    });
+}
+
+// Each tracer lists its own processes, the main thread waits meanwhile
+void display_processes(DebugContext &ctx)
+{
+    pid_t current = current_pid(ctx);
+    for (const auto &tracer : ctx.sessions.tracers())
+    {
+        tracer->run([&](Session &session)
+        {
+            for (const auto &[pid, proc] : session.processes())
+            {
+                fmt::println("{} {:<8} {:<10} {}", pid == current ? '*' : ' ',
+                    pid, state_name(proc->get_state()), proc->exe_path());
+            }
+        });
     }
-    else if (action == Action::Invalid)
+
+    ForkPolicy policy = ctx.sessions.current().run([](Session &session)
     {
-        std::cout << "Invalid Command" << std::endl;
-        return true;
+        return session.fork_policy();
+    });
+    fmt::println("Forked children are {}",
+        policy == ForkPolicy::Follow ? "followed" : "detached");
+}
+
+void drain_output(DebugContext &ctx)
+{
+    char buf[4096];
+    ssize_t len = recv(ctx.output_fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (len < 0 && errno == EAGAIN)
+        return;
+
+    if (len <= 0)
+    {
+        ctx.loop.unwatch_fd(ctx.output_fd);
+        close(ctx.output_fd);
+        ctx.output_fd = -1;
+        return;
     }
-    else if (action == Action::Incomplete)
+
+    print_async(ctx, [&]() { std::fwrite(buf, 1, len, stdout); });
+}
+
+// Commands that do not need the tracee to be stopped
+bool allowed_while_running(Action action)
+{
+    switch (action)
     {
-        std::cout << "Incomplete Command" << std::endl;
-        return true;
+        case Action::Interrupt:
+        case Action::ThreadList:
+        case Action::ThreadSelect:
+        case Action::AgentStatus:
+        case Action::AgentReadDef:
+        case Action::AgentReadCnt:
+        case Action::AgentCounters:
+        case Action::AgentTrace:
+        case Action::ProfileSample:
+        case Action::ProfileSampleFolded:
+        case Action::ProfileWall:
+        case Action::ProfileWallFreq:
+        case Action::SyscallTrace:
+        case Action::SyscallTraceSel:
+        case Action::SyscallLog:
+        case Action::SyscallOff:
+        case Action::SyscallStats:
+        case Action::SyscallStatsSel:
+        case Action::SignalList:
+        case Action::SignalShow:
+        case Action::SignalSet:
+        case Action::Help:
+            return true;
+        default:
+            return false;
     }
-    else if (action == Action::Ambiguous)
+}
+
+// Comma separated system call names, an unknown one is a usage error
+std::vector<int> to_syscalls(std::string_view names)
+{
+    try
     {
-        std::cout << "Ambiguous Command" << std::endl;
-        return true;
+        return SyscallTracer::parse(names);
     }
+    catch (const Error &err)
+    {
+        throw std::invalid_argument(err.what());
+    }
+}
 
+void enable_syscall_trace(ProcessPtr &proc, std::vector<int> select)
+{
     try
     {
-        if (action == Action::Continue)
-        {
-            proc->resume();
-            std::uint8_t ret = proc->wait();
-            print_stop_reason(proc, ret);
-            if (proc->get_state() == ProcessState::Stopped)
-                display_disassembly(proc);
-        }
-        else if(action == Action::StepInst)
+        proc->syscalls().enable(select);
+    }
+    catch (const Error &err)
+    {
+        throw std::invalid_argument(err.what());
+    }
+
+    std::string names;
+    for (int nr : select.empty() ? proc->syscalls().filtered() : select)
+        names += (names.empty() ? "" : ", ") + std::string(SyscallTracer::name(nr));
+    fmt::println("Tracing {}", names);
+}
+
+// Drains the log, "[tid] openat(0xffffff9c, 0xaaaae0c0, 0x0, 0x0) = 0x3 <12us>"
+void display_syscalls(ProcessPtr &proc)
+{
+    SyscallTracer &tracer = proc->syscalls();
+    if (tracer.dropped() != 0)
+        fmt::println("{} older records dropped", tracer.dropped());
+
+    for (const auto &record : tracer.take())
+    {
+        std::string_view name = SyscallTracer::name(record.number);
+        std::string line = fmt::format("[{}] ", record.tid);
+        line += name.empty() ? fmt::format("syscall_{}", record.number) : std::string(name);
+
+        line += '(';
+        for (int i = 0; i < SyscallTracer::arg_count(record.number); i++)
+            line += fmt::format("{}{:#x}", i == 0 ? "" : ", ", record.args[i]);
+        line += ')';
+
+        if (!record.ret)
         {
-            std::uint8_t ret = proc->step_instruction();
-            print_stop_reason(proc, ret);
-            if (proc->get_state() == ProcessState::Stopped)
-                display_disassembly(proc);
+            fmt::println("{} = ?", line);
+            continue;
         }
-        else if (action == Action::ReadReg)
+
+        // Failures come back as -errno
+        std::int64_t ret = *record.ret;
+        auto took = std::chrono::duration_cast<std::chrono::microseconds>(record.left - record.entered);
+        if (ret < 0 && ret >= -4095)
         {
-            RegisterValue val = proc->registers().read<RegisterValue>(tokens[2]);
-            display_register(get_register_id(tokens[2]), val);
+            const char *abbrev = strerrorname_np(static_cast<int>(-ret));
+            fmt::println("{} = -1 {} ({}) <{}us>", line, abbrev != nullptr ? abbrev : "E?",
+                std::strerror(static_cast<int>(-ret)), took.count());
         }
-        else if (action == Action::ReadRegGPR)
+        else
         {
-            std::size_t curr = 0;
-            std::size_t end = static_cast<std::size_t>(RegisterID::REG32_W30);
-            for (; curr <= end; curr++)
-            {
-                RegisterID id = static_cast<RegisterID>(curr);
-                RegisterValue val = proc->registers().read<RegisterValue>(id);
-                display_register(id, val);
-            }
+            fmt::println("{} = {:#x} <{}us>", line, ret, took.count());
         }
-        else if (action == Action::ReadRegAll)
-        {
-            std::size_t curr = 0;
-            std::size_t end = static_cast<std::size_t>(RegisterID::REG32_FPCR);
-            for (; curr <= end; curr++)
-            {
-                RegisterID id = static_cast<RegisterID>(curr);
-                RegisterValue val = proc->registers().read<RegisterValue>(id);
-                display_register(id, val);
-            }
+    }
+}
+
+std::string format_ns(std::uint64_t ns)
+{
+    if (ns < 1000)
+        return fmt::format("{}ns", ns);
+    if (ns < 1000000)
+        return fmt::format("{:.1f}us", ns / 1e3);
+    if (ns < 1000000000)
+        return fmt::format("{:.1f}ms", ns / 1e6);
+    return fmt::format("{:.2f}s", ns / 1e9);
+}
+
+// Calls by total time spent in them, then the descriptors data moved through
+void display_syscall_stats(ProcessPtr &proc)
+{
+    const SyscallProfile &profile = proc->syscalls().profile();
+    if (profile.by_number().empty())
+    {
+        fmt::println("No system calls finished");
+        return;
+    }
+
+    std::vector<std::pair<int, const LatencyHistogram *>> calls;
+    for (const auto &[nr, hist] : profile.by_number())
+        calls.emplace_back(nr, &hist);
+    std::sort(calls.begin(), calls.end(), [](const auto &a, const auto &b)
+    {
+        return a.second->total_ns > b.second->total_ns;
+    });
+
+    fmt::println("{:<18} {:>8} {:>10} {:>10} {:>10} {:>10}",
+        "syscall", "calls", "total", "p50", "p99", "max");
+    for (const auto &[nr, hist] : calls)
+    {
+        fmt::println("{:<18} {:>8} {:>10} {:>10} {:>10} {:>10}",
+            SyscallTracer::name(nr), hist->count, format_ns(hist->total_ns),
+            format_ns(hist->percentile(0.5)), format_ns(hist->percentile(0.99)),
+            format_ns(hist->max_ns));
+    }
+
+    if (profile.by_fd().empty())
+        return;
+
+    fmt::println("\n{:<6} {:<10} {:>8} {:>12} {:>8} {:>10} {:>10}",
+        "fd", "syscall", "calls", "bytes", "errors", "total", "p99");
+    for (const auto &[key, stats] : profile.by_fd())
+    {
+        fmt::println("{:<6} {:<10} {:>8} {:>12} {:>8} {:>10} {:>10}",
+            key.first, SyscallTracer::name(key.second), stats.latency.count, stats.bytes,
+            stats.errors, format_ns(stats.latency.total_ns),
+            format_ns(stats.latency.percentile(0.99)));
+    }
+}
+
+// Log2 buckets of one call, bars scaled to the fullest bucket
+void display_syscall_histogram(ProcessPtr &proc, std::string_view name)
+{
+    auto nr = SyscallTracer::number(name);
+    if (!nr)
+        throw std::invalid_argument("Unknown system call " + std::string(name));
+
+    const auto &by_number = proc->syscalls().profile().by_number();
+    auto it = by_number.find(*nr);
+    if (it == by_number.end())
+    {
+        fmt::println("No {} calls finished", name);
+        return;
+    }
+
+    const LatencyHistogram &hist = it->second;
+    std::size_t first = LatencyHistogram::BUCKETS, last = 0;
+    std::uint64_t most = 0;
+    for (std::size_t i = 0; i < LatencyHistogram::BUCKETS; i++)
+    {
+        if (hist.buckets[i] == 0)
+            continue;
+        first = std::min(first, i);
+        last = i;
+        most = std::max(most, hist.buckets[i]);
+    }
+
+    constexpr std::size_t WIDTH = 40;
+    fmt::println("{} calls, {} total, {} max", hist.count, format_ns(hist.total_ns),
+        format_ns(hist.max_ns));
+    for (std::size_t i = first; i <= last; i++)
+    {
+        std::size_t bar = static_cast<std::size_t>(hist.buckets[i] * WIDTH / most);
+        fmt::println("[{:>8}, {:>8}) {:>8} |{:<{}}|", format_ns(std::uint64_t(1) << i),
+            format_ns(std::uint64_t(2) << i), hist.buckets[i], std::string(bar, '@'), WIDTH);
+    }
+}
+
+// Signal by number or name, with or without the SIG prefix
+int to_signal(std::string_view arg)
+{
+    std::string name(arg);
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return std::toupper(c); });
+    if (name.rfind("SIG", 0) == 0)
+        name.erase(0, 3);
+
+    for (int signo = 1; signo <= SIGRTMAX; signo++)
+    {
+        if (signal_name(signo) == name)
+            return signo;
+    }
+
+    int signo = 0;
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), signo);
+    if (ec != std::errc() || end != arg.data() + arg.size() || signo <= 0 || signo > SIGRTMAX)
+        throw std::invalid_argument("Unknown signal " + std::string(arg));
+    return signo;
+}
+
+void display_signal(ProcessPtr &proc, int signo)
+{
+    const SignalPolicy &policy = proc->signal_policy(signo);
+    fmt::println("{:<10} {:<6} {:<6} {:<6}", "SIG" + signal_name(signo),
+        policy.stop ? "Yes" : "No", policy.print ? "Yes" : "No", policy.pass ? "Yes" : "No");
+}
+
+void display_signals(ProcessPtr &proc, std::optional<int> only = std::nullopt)
+{
+    fmt::println("{:<10} {:<6} {:<6} {:<6}", "Signal", "Stop", "Print", "Pass");
+    if (only)
+    {
+        display_signal(proc, *only);
+        return;
+    }
+
+    // Numbers between the classic and the real-time ones belong to libc
+    for (int signo = 1; signo <= SIGRTMAX; signo++)
+    {
+        if (signo < SIGRTMIN && sigabbrev_np(signo) == nullptr)
+            continue;
+        display_signal(proc, signo);
+    }
+}
+
+// Keywords as gdb takes them, stop implies print and noprint nostop
+void set_signal_policy(ProcessPtr &proc, int signo, Span<const std::string_view> keywords)
+{
+    SignalPolicy policy = proc->signal_policy(signo);
+    for (std::string_view word : keywords)
+    {
+        if (word == "stop")
+            policy.stop = policy.print = true;
+        else if (word == "nostop")
+            policy.stop = false;
+        else if (word == "print")
+            policy.print = true;
+        else if (word == "noprint")
+            policy.print = policy.stop = false;
+        else if (word == "pass")
+            policy.pass = true;
+        else if (word == "nopass")
+            policy.pass = false;
+        else
+            throw std::invalid_argument("Unknown keyword [" + std::string(word) +
+                "], use stop, nostop, print, noprint, pass or nopass");
+    }
+
+    try
+    {
+        proc->set_signal_policy(signo, policy);
+    }
+    catch (const Error &err)
+    {
+        throw std::invalid_argument(err.what());
+    }
+    display_signals(proc, signo);
+}
+
+void display_agent_status(DebugContext &ctx)
+{
+    if (!ctx.agent)
+    {
+        fmt::println("Agent not loaded");
+        return;
+    }
+
+    fmt::println("Agent {}, {} trace records dropped",
+        ctx.agent->ready() ? "ready" : "waiting for tracee",
+        ctx.agent->dropped_records());
+}
+
+void display_agent_counters(DebugContext &ctx)
+{
+    for (std::size_t i = 0; i < BKPT_AGENT_COUNTERS; i++)
+    {
+        std::uint64_t val = ctx.agent->counter(i);
+        if (val != 0)
+            fmt::println("counter[{}] = {}", i, val);
+    }
+}
+
+void display_agent_trace(DebugContext &ctx)
+{
+    auto records = ctx.agent->drain_trace();
+    for (auto &rec : records)
+    {
+        fmt::println("{:>20} id = {:<8} value = {:#x}",
+            rec.timestamp_ns, rec.id, rec.value);
+    }
+    fmt::println("{} records", records.size());
+}
+
+// A stopped process runs for the duration and is stopped again, a stop
+// of its own while it ran is reported either way
+template <typename F>
+void sample_for(DebugContext &ctx, ProcessPtr &proc, std::uint64_t seconds, F &&sample)
+{
+    bool stopped = (proc->get_state() == ProcessState::Stopped);
+    if (stopped)
+        proc->resume();
+
+    fmt::println("Sampling process {} for {}s", proc->get_pid(), seconds);
+    sample();
+
+    if (stopped == false)
+    {
+        ctx.sessions.current().poll();
+        return;
+    }
+
+    std::optional<std::uint8_t> ret = proc->try_wait();
+    if (!ret)
+    {
+        proc->interrupt();
+        ret = proc->wait();
+    }
+    report_stop(proc, *ret);
+}
+
+// Runs on the tracer thread of the current process
+bool handle_process_command(Action action, std::vector<std::string_view> &tokens,
+    std::string_view line, DebugContext &ctx, Session &session)
+{
+    ProcessPtr &proc = session.current();
+
+    if (proc->get_state() == ProcessState::Running &&
+        allowed_while_running(action) == false)
+    {
+        std::cout << "Process is running, interrupt it first" << std::endl;
+        return true;
+    }
+
+    try
+    {
+        if (action == Action::Continue)
+        {
+            // The stop is reported from the event loop once it happens,
+            // one collected already is picked up by polling right away
+            proc->resume();
+            if (proc->non_stop())
+                fmt::println("Continuing thread {}", proc->current_thread());
+            ctx.sessions.current().poll();
+        }
+        else if (action == Action::Interrupt)
+        {
+            proc->interrupt();
+        }
+        else if (action == Action::AgentLoad)
+        {
+            if (!ctx.agent)
+                ctx.agent = Agent::create(*proc);
+
+            std::string path = (tokens.size() > 2) ?
+                std::string(tokens[2]) : Agent::default_library_path();
+            ctx.agent->load(path);
+            if (ctx.agent->ready() == false)
+            {
+                // Its thread only gets going once the process runs
+                fmt::println("Agent loaded, it reports in once the process runs");
+                auto timer = std::make_shared<int>(-1);
+                *timer = ctx.loop.add_timer(std::chrono::milliseconds(100), [&ctx, timer]()
+                {
+                    if (ctx.agent && ctx.agent->ready() == false)
+                        return;
+
+                    if (ctx.agent)
+                        print_async(ctx, []() { fmt::println("Agent ready"); });
+                    ctx.loop.cancel_timer(*timer);
+                });
+            }
+        }
+        else if (action == Action::AgentStatus)
+        {
+            display_agent_status(ctx);
+        }
+        else if (action == Action::AgentReadDef || action == Action::AgentReadCnt)
+        {
+            if (!ctx.agent)
+                throw std::invalid_argument("Agent not loaded");
+
+            virt_addr address = to_positive_integral(tokens[2]);
+            std::size_t count = (action == Action::AgentReadCnt) ?
+                to_positive_integral(tokens[3]) : 32;
+            auto data = ctx.agent->read_memory(address, count);
+            display_memory(data, address);
+        }
+        else if (action == Action::AgentCounters || action == Action::AgentTrace)
+        {
+            if (!ctx.agent)
+                throw std::invalid_argument("Agent not loaded");
+
+            if (action == Action::AgentCounters)
+                display_agent_counters(ctx);
+            else
+                display_agent_trace(ctx);
+        }
+        else if (action == Action::Call)
+        {
+            if (tokens.size() < 2)
+                throw std::invalid_argument("Missing call target");
+
+            std::string_view expr = line.substr(tokens[1].data() - line.data());
+            auto [target, args] = parse_call_expression(expr);
+            if (target.empty())
+                throw std::invalid_argument("Missing call target");
+
+            virt_addr address = to_address(proc, target);
+            CallResult res = proc->call_function(address, args);
+            fmt::println("Returned x0 = {:#018x} (u:{} s:{}) d0 = {} s0 = {}",
+                res.x0, res.x0, static_cast<std::int64_t>(res.x0), res.d0, res.s0);
+        }
+        else if (action == Action::ThreadList)
+        {
+            display_threads(proc);
+        }
+        else if (action == Action::SyscallTrace)
+        {
+            enable_syscall_trace(proc, {});
+        }
+        else if (action == Action::SyscallTraceSel)
+        {
+            enable_syscall_trace(proc, to_syscalls(tokens[2]));
+        }
+        else if (action == Action::SyscallLog)
+        {
+            display_syscalls(proc);
+        }
+        else if (action == Action::SyscallOff)
+        {
+            proc->syscalls().disable();
+        }
+        else if (action == Action::SyscallStats)
+        {
+            display_syscall_stats(proc);
+        }
+        else if (action == Action::SyscallStatsSel)
+        {
+            display_syscall_histogram(proc, tokens[2]);
+        }
+        else if (action == Action::SignalList)
+        {
+            display_signals(proc);
+        }
+        else if (action == Action::SignalShow)
+        {
+            display_signals(proc, to_signal(tokens[1]));
+        }
+        else if (action == Action::SignalSet)
+        {
+            set_signal_policy(proc, to_signal(tokens[1]),
+                {tokens.data() + 2, tokens.size() - 2});
+        }
+        else if (action == Action::ThreadSelect)
+        {
+            auto tid = static_cast<pid_t>(to_positive_integral(tokens[2]));
+            auto it = proc->threads().find(tid);
+            if (it == proc->threads().end())
+                throw std::invalid_argument("No such thread");
+
+            bool stopped = (it->second.state == ProcessState::Stopped);
+            if (stopped == false && proc->non_stop() == false)
+                throw std::invalid_argument("Process is running, interrupt it first");
+
+            proc->select_thread(tid);
+            if (stopped)
+                display_disassembly(proc);
+            else
+                fmt::println("Thread {} is running", tid);
+        }
+        else if (action == Action::StepLine || action == Action::StepOver ||
+                 action == Action::StepOut)
+        {
+            SourceStepper stepper(*proc);
+            std::uint8_t ret = (action == Action::StepLine) ? stepper.step_in() :
+                (action == Action::StepOver) ? stepper.step_over() : stepper.step_out();
+            report_stop(proc, ret);
+        }
+        else if(action == Action::StepInst)
+        {
+            std::uint8_t ret = proc->step_instruction();
+            report_stop(proc, ret);
+        }
+        else if (action == Action::StepCount)
+        {
+            StepLimits limits;
+            limits.count = to_positive_integral(tokens[1]);
+            if (limits.count == 0)
+                throw std::invalid_argument("Step count must be positive");
+            report_steps(proc, proc->step_instructions(limits));
+        }
+        else if (action == Action::StepUntil)
+        {
+            StepLimits limits;
+            limits.until = to_address(proc, tokens[2]);
+            report_steps(proc, proc->step_instructions(limits));
+        }
+        else if (action == Action::StepWhile)
+        {
+            StepLimits limits;
+            limits.range = std::make_pair(to_positive_integral(tokens[2]),
+                to_positive_integral(tokens[3]));
+            if (limits.range->first >= limits.range->second)
+                throw std::invalid_argument("Range must be given as <low> <high>");
+            report_steps(proc, proc->step_instructions(limits));
+        }
+        else if (action == Action::ProfileStep || action == Action::ProfileStepUntil)
+        {
+            StepLimits limits;
+            if (action == Action::ProfileStep)
+                limits.count = to_positive_integral(tokens[2]);
+            else
+                limits.until = to_address(proc, tokens[3]);
+            if (action == Action::ProfileStep && limits.count == 0)
+                throw std::invalid_argument("Step count must be positive");
+
+            StepProfiler profiler(*proc);
+            StepResult res = profiler.run(limits);
+            display_step_profile(proc, profiler);
+            report_steps(proc, res);
+        }
+        else if (action == Action::ProfileSample || action == Action::ProfileSampleFolded)
+        {
+            std::uint64_t seconds = to_positive_integral(tokens[2]);
+            if (seconds == 0)
+                throw std::invalid_argument("Sampling time must be positive");
+
+            PerfSampler sampler(*proc);
+            sample_for(ctx, proc, seconds, [&]()
+            {
+                sampler.run_for(std::chrono::seconds(seconds));
+                display_samples(proc, sampler, action == Action::ProfileSampleFolded);
+            });
+        }
+        else if (action == Action::ProfileWall || action == Action::ProfileWallFreq)
+        {
+            std::uint64_t seconds = to_positive_integral(tokens[2]);
+            if (seconds == 0)
+                throw std::invalid_argument("Sampling time must be positive");
+
+            std::uint64_t frequency = (action == Action::ProfileWallFreq) ?
+                to_positive_integral(tokens[3]) : 100;
+            WallClockSampler sampler(*proc, frequency);
+            sample_for(ctx, proc, seconds, [&]()
+            {
+                sampler.run_for(std::chrono::seconds(seconds));
+                fmt::println("{} rounds, {} thread stacks, {}us halted per round",
+                    sampler.rounds(), sampler.samples(),
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        sampler.round_cost()).count());
+                if (sampler.interrupted())
+                    fmt::println("Sampling ended early, the process stopped");
+                display_folded(proc, sampler.stacks());
+            });
+        }
+        else if (action == Action::Backtrace)
+        {
+            display_backtrace(proc);
+        }
+        else if (action == Action::ReadReg)
+        {
+            RegisterValue val = proc->registers().read<RegisterValue>(tokens[2]);
+            display_register(get_register_id(tokens[2]), val);
+        }
+        else if (action == Action::ReadRegGPR)
+        {
+            std::size_t curr = 0;
+            std::size_t end = static_cast<std::size_t>(RegisterID::REG32_W30);
+            for (; curr <= end; curr++)
+            {
+                RegisterID id = static_cast<RegisterID>(curr);
+                RegisterValue val = proc->registers().read<RegisterValue>(id);
+                display_register(id, val);
+            }
+        }
+        else if (action == Action::ReadRegAll)
+        {
+            std::size_t curr = 0;
+            std::size_t end = static_cast<std::size_t>(RegisterID::REG32_FPCR);
+            for (; curr <= end; curr++)
+            {
+                RegisterID id = static_cast<RegisterID>(curr);
+                RegisterValue val = proc->registers().read<RegisterValue>(id);
+                display_register(id, val);
+            }
         }
         else if (action == Action::WriteReg)
         {
@@ -366,13 +1438,11 @@ bool handle_command(std::string_view line, ProcessPtr &proc)
         }
         else if (action == Action::BPSiteSet)
         {
-            virt_addr address = to_positive_integral(tokens[2]);
-            proc->create_breakpoint_site(address).enable();
+            set_breakpoint(proc, tokens[2], false);
         }
         else if (action == Action::BPSiteSetHW)
         {
-            virt_addr address = to_positive_integral(tokens[2]);
-            proc->create_breakpoint_site(address, true).enable();
+            set_breakpoint(proc, tokens[2], true);
         }
         else if (action == Action::BPSiteEn)
         {
@@ -410,48 +1480,414 @@ bool handle_command(std::string_view line, ProcessPtr &proc)
     return true;
 }
 
-void cli_repl(ProcessPtr &proc)
+// Sends a command to every process, tracers carry it out in parallel
+void handle_broadcast(std::string_view line, std::vector<std::string_view> &tokens,
+    DebugContext &ctx)
+{
+    if (tokens.size() < 2)
+        throw std::invalid_argument("Missing command to send to all processes");
+
+    auto [action, args] = process_line(line.substr(tokens[1].data() - line.data()));
+    // Symbols and source lines differ per process, each tracer resolves them
+    std::string target;
+    switch (action)
+    {
+        case Action::Continue:
+        case Action::Interrupt:
+            break;
+        case Action::BPSiteSet:
+        case Action::BPSiteSetHW:
+            target = std::string(args[2]);
+            break;
+        default:
+            throw std::invalid_argument("Command cannot be sent to all processes");
+    }
+
+    // Failures come back as text, only this thread prints
+    auto results = ctx.sessions.broadcast([action, target](Session &session)
+    {
+        std::vector<std::string> errors;
+        for (const auto &[pid, proc] : session.processes())
+        {
+            ProcessState state = proc->get_state();
+            if (state == ProcessState::Exited || state == ProcessState::Terminated)
+                continue;
+
+            try
+            {
+                if (action == Action::Interrupt)
+                {
+                    if (state == ProcessState::Running)
+                        proc->interrupt();
+                }
+                else if (state != ProcessState::Stopped)
+                {
+                    errors.push_back(fmt::format("[process {}] Process is running", pid));
+                }
+                else if (action == Action::Continue)
+                {
+                    proc->resume();
+                }
+                else
+                {
+                    virt_addr address = to_address(proc, target);
+                    proc->create_breakpoint_site(address, action == Action::BPSiteSetHW).enable();
+                }
+            }
+            catch (const Error &err)
+            {
+                errors.push_back(fmt::format("[process {}] Error: {}", pid, err.what()));
+            }
+            catch (const std::invalid_argument &err)
+            {
+                errors.push_back(fmt::format("[process {}] {}", pid, err.what()));
+            }
+        }
+        return errors;
+    });
+
+    for (auto &result : results)
+    {
+        for (const auto &msg : result.get())
+            std::cout << msg << std::endl;
+    }
+
+    // Stops collected while resuming are not announced by SIGCHLD
+    if (action == Action::Continue)
+        ctx.sessions.poll();
+}
+
+// Commands about the set of processes are handled on the main thread
+bool handle_fleet_command(Action action, std::vector<std::string_view> &tokens,
+    std::string_view line, DebugContext &ctx)
+{
+    try
+    {
+        if (action == Action::Broadcast)
+        {
+            handle_broadcast(line, tokens, ctx);
+        }
+        else if (action == Action::ProcessList)
+        {
+            display_processes(ctx);
+        }
+        else if (action == Action::ProcessSelect)
+        {
+            auto pid = static_cast<pid_t>(to_positive_integral(tokens[2]));
+            Tracer *tracer = ctx.sessions.find(pid);
+            if (tracer == nullptr)
+                throw std::invalid_argument("No such process");
+
+            ctx.sessions.select(*tracer);
+            tracer->run([&](Session &session)
+            {
+                session.select(pid);
+                ProcessPtr &selected = session.current();
+                if (selected->get_state() == ProcessState::Stopped)
+                    display_disassembly(selected);
+                else
+                    fmt::println("Process {} is {}", pid, state_name(selected->get_state()));
+            });
+        }
+        else if (action == Action::ProcessFollow)
+        {
+            ForkPolicy policy;
+            if (tokens[2] == "on")
+                policy = ForkPolicy::Follow;
+            else if (tokens[2] == "off")
+                policy = ForkPolicy::Detach;
+            else
+                throw std::invalid_argument("Expected on or off");
+
+            bool filtered = false;
+            for (auto &result : ctx.sessions.broadcast([policy](Session &session)
+            {
+                session.set_fork_policy(policy);
+                for (const auto &[pid, proc] : session.processes())
+                {
+                    if (proc->syscalls().filtered().empty() == false)
+                        return true;
+                }
+                return false;
+            }))
+                filtered |= result.get();
+
+            if (policy == ForkPolicy::Detach && filtered)
+                fmt::println("Children of processes tracing system calls are still followed");
+        }
+    }
+    catch (const std::invalid_argument &err)
+    {
+        std::cout << "Error: " << err.what() << std::endl;
+        return true;
+    }
+    catch (const Error &err)
+    {
+        std::cout << "Error occured for " << tokens[0]
+                  << ": " << err.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool handle_command(std::string_view line, DebugContext &ctx)
+{
+    auto [action, tokens] = process_line(line);
+
+    if (action == Action::Quit)
+    {
+        return false;
+    }
+    else if (action == Action::None)
+    {
+        return true;
+    }
+    else if (action == Action::Invalid)
+    {
+        std::cout << "Invalid Command" << std::endl;
+        return true;
+    }
+    else if (action == Action::Incomplete)
+    {
+        std::cout << "Incomplete Command" << std::endl;
+        return true;
+    }
+    else if (action == Action::Ambiguous)
+    {
+        std::cout << "Ambiguous Command" << std::endl;
+        return true;
+    }
+
+    switch (action)
+    {
+        case Action::Broadcast:
+        case Action::ProcessList:
+        case Action::ProcessSelect:
+        case Action::ProcessFollow:
+            return handle_fleet_command(action, tokens, line, ctx);
+        default:
+            break;
+    }
+
+    // ptrace only serves the thread that attached, the main thread waits
+    return ctx.sessions.current().run([&](Session &session)
+    {
+        return handle_process_command(action, tokens, line, ctx, session);
+    });
+}
+
+// Reports what a tracer collected, the tracer prints while we wait
+void handle_trace_event(DebugContext &ctx, const TraceEvent &event)
 {
-    char *raw_line = NULL;
+    if (event.kind == TraceEventKind::Error)
+    {
+        print_async(ctx, [&]() { std::cout << "Error: " << event.error << std::endl; });
+        ctx.loop.stop();
+        return;
+    }
+
+    if (event.kind == TraceEventKind::Follow)
+    {
+        print_async(ctx, [&]() { fmt::println("Following forked process {}", event.pid); });
+        return;
+    }
+
+    if (event.kind == TraceEventKind::Signal)
+    {
+        print_async(ctx, [&]()
+        {
+            fmt::println("Thread {} of process {} received signal {}",
+                event.tid, event.pid, signal_name(event.info));
+        });
+        return;
+    }
+
+    ctx.sessions.select(*event.tracer);
+    print_async(ctx, [&]()
+    {
+        bool done = event.tracer->run([&](Session &session)
+        {
+            // A command may have resumed it before the report got here
+            if (session.processes().count(event.pid) == 0)
+                return false;
+            session.select(event.pid);
+            if (session.current()->get_state() == ProcessState::Running)
+                return false;
+
+            report_event(ctx, session, event.info);
+            return session.alive() == false;
+        });
+
+        // Nothing left for this tracer, another one takes over
+        if (done && ctx.sessions.prune())
+            fmt::println("Switched to process {}", current_pid(ctx));
+    });
+}
+
+ProcessState current_state(DebugContext &ctx)
+{
+    return ctx.sessions.current().run([](Session &session)
+    {
+        return session.current()->get_state();
+    });
+}
+
+void cli_repl(DebugContext &ctx)
+{
+    linenoiseState state;
+    char line[4096];
 
     linenoiseHistorySetMaxLen(200);
     linenoiseHistoryLoad(COMMANDS_HISTORY);
 
     std::cout << "Welcome to breakpoint!" << std::endl;
-    std::cout << "Attached process ID is: " << proc->get_pid() << std::endl;
+    if (ctx.sessions.tracers().size() == 1)
+        std::cout << "Attached process ID is: " << current_pid(ctx) << std::endl;
+    else
+        std::cout << "Attached to " << ctx.sessions.tracers().size()
+                  << " processes, use process list to see them" << std::endl;
+    if (current_state(ctx) == ProcessState::Running)
+        std::cout << "Process is running, use interrupt to stop it" << std::endl;
 
-    while ((raw_line = linenoise("bkpt> ")) != NULL)
+    auto start_prompt = [&]()
     {
-        // Do nothing if line is empty
-        // TODO: Can treat this as shortcut to run previous command
-        if (raw_line[0] == '\0')
+        linenoiseEditStart(&state, -1, -1, line, sizeof(line), "bkpt> ");
+        ctx.prompt = &state;
+    };
+
+    // State changes of a continued tracee arrive as SIGCHLD, in non-stop
+    // mode other threads report even while the current one is stopped,
+    // tracer threads collect them and queue what they found
+    ctx.loop.watch_signal(SIGCHLD, [&]() { ctx.sessions.poll(); });
+
+    EventQueue &events = ctx.sessions.events();
+    ctx.loop.watch_fd(events.fd(), [&]()
+    {
+        events.clear_fd();
+        while (auto event = events.pop())
+            handle_trace_event(ctx, *event);
+    });
+
+    if (ctx.output_fd >= 0)
+        ctx.loop.watch_fd(ctx.output_fd, [&]() { drain_output(ctx); });
+
+    ctx.loop.watch_fd(STDIN_FILENO, [&]()
+    {
+        char *raw_line = linenoiseEditFeed(&state);
+        if (raw_line == linenoiseEditMore)
+            return;
+
+        linenoiseEditStop(&state);
+        ctx.prompt = nullptr;
+
+        if (raw_line == NULL)
         {
-            free(raw_line);
-            continue;
+            // Ctrl-C stops a running tracee and quits otherwise
+            if (errno == EAGAIN && current_state(ctx) == ProcessState::Running)
+            {
+                handle_command("interrupt", ctx);
+                start_prompt();
+                return;
+            }
+
+            ctx.loop.stop();
+            return;
         }
 
-        if (handle_command(raw_line, proc) == false)
+        // Do nothing if line is empty
+        // TODO: Can treat this as shortcut to run previous command
+        if (raw_line[0] != '\0')
         {
-            free(raw_line);
-            break;
+            if (handle_command(raw_line, ctx) == false)
+            {
+                free(raw_line);
+                ctx.loop.stop();
+                return;
+            }
+
+            linenoiseHistoryAdd(raw_line);
         }
 
-        linenoiseHistoryAdd(raw_line);
         free(raw_line);
-    }
+        start_prompt();
+    });
+
+    start_prompt();
+    ctx.loop.run();
 
     linenoiseHistorySave(COMMANDS_HISTORY);
 }
 
+// Either a comma separated list of pids or a pattern for their command lines
+std::vector<pid_t> parse_pids(std::string_view arg)
+{
+    if (arg.find_first_not_of("0123456789,") != std::string_view::npos)
+        return SessionManager::find_pids(arg);
+
+    std::vector<pid_t> pids;
+    while (arg.empty() == false)
+    {
+        std::size_t comma = arg.find(',');
+        std::string_view token = arg.substr(0, comma);
+        pid_t pid = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), pid);
+        if (ec != std::errc{} || ptr != token.data() + token.size())
+            throw std::runtime_error("Unable to parse process id [" + std::string(token) + "]");
+        if (pid <= 0)
+            throw std::runtime_error("PID must be positive");
+
+        pids.push_back(pid);
+        if (comma == std::string_view::npos)
+            break;
+        arg = arg.substr(comma + 1);
+    }
+    return pids;
+}
+
 int main(int argc, char *argv[])
 {
-    int debug_pid = 0;
-    ProcessPtr proc;
+    DebugContext ctx;
+    LaunchOptions options;
+    bool with_agent = false;
+    bool capture = false;
+    bool seize = false;
+    bool non_stop = false;
+    bool follow_fork = false;
+    bool launched = false;
+    StopAt stop_at = StopAt::Exec;
+    std::optional<std::string_view> stop_at_arg;
+    std::optional<std::string_view> trace_arg;
+    std::vector<std::string_view> breaks;
 
     std::vector<std::string_view> args(argv, argv + argc);
     const std::string_view program_name = args[0];
 
-    if (argc == 1)
+    // Options come first, the first other token selects attach or launch
+    std::size_t idx = 1;
+    for (; idx < args.size(); idx++)
+    {
+        if (args[idx] == "--agent")
+            with_agent = true;
+        else if (args[idx] == "--capture")
+            capture = true;
+        else if (args[idx] == "--seize")
+            seize = true;
+        else if (args[idx] == "--non-stop")
+            non_stop = true;
+        else if (args[idx] == "--follow-fork")
+            follow_fork = true;
+        else if (args[idx] == "--stop-at" && idx + 1 < args.size())
+            stop_at_arg = args[++idx];
+        else if (args[idx] == "--break" && idx + 1 < args.size())
+            breaks.push_back(args[++idx]);
+        else if (args[idx] == "--trace-syscalls" && idx + 1 < args.size())
+            trace_arg = args[++idx];
+        else
+            break;
+    }
+
+    if (idx == args.size())
     {
         print_usage(program_name);
         return 1;
@@ -459,35 +1895,69 @@ int main(int argc, char *argv[])
 
     try
     {
-        if (args[1] == "-h" || args[1] == "--help")
+        if (args[idx] == "-h" || args[idx] == "--help")
         {
             print_usage(program_name);
             return 0;
         }
-        else if (args[1] == "-p")
+        else if (args[idx] == "-p")
         {
-            if (argc < 3)
+            if (idx + 1 >= args.size())
                 throw std::runtime_error("Missing PID after -p");
 
-            try
-            {
-                debug_pid = std::stoi(std::string(args[2]));
-            }
-            catch (...)
-            {
-                throw std::runtime_error("Unable to parse process id [" + std::string(args[2]) + "]");
-            }
+            std::vector<pid_t> pids = parse_pids(args[idx + 1]);
+            if (pids.empty())
+                throw std::runtime_error("No process matches [" + std::string(args[idx + 1]) + "]");
+
+            if (with_agent)
+                throw std::runtime_error("--agent only applies to launch, use 'agent load' after attaching");
+
+            if (capture)
+                throw std::runtime_error("--capture only applies to launch");
+
+            if (stop_at_arg)
+                throw std::runtime_error("--stop-at only applies to launch");
 
-            if (debug_pid <= 0)
-                throw std::runtime_error("PID must be positive");
+            if (trace_arg)
+                throw std::runtime_error("--trace-syscalls only applies to launch");
 
-            proc = Process::attach(debug_pid);
+            for (const auto &msg : ctx.sessions.attach(pids, seize))
+                std::cerr << "Warning: " << msg << std::endl;
+
+            if (ctx.sessions.empty())
+                throw std::runtime_error("Could not attach to any process");
         }
         else
         {
+            if (with_agent)
+                options.preload = Agent::default_library_path();
+
+            if (capture)
+                options.comm = &ctx.output_fd;
+
+            if (seize)
+                throw std::runtime_error("--seize only applies to attach");
+
+            if (stop_at_arg)
+                stop_at = parse_stop_at(*stop_at_arg);
+
+            // Children left without a tracer would see traced calls fail
+            if (trace_arg)
+            {
+                options.trace_syscalls = to_syscalls(*trace_arg);
+                follow_fork = true;
+            }
+
+            // Stops at exec, breakpoints and tracking go in before it moves on
+            std::vector<std::string_view> exec_args(args.begin() + idx, args.end());
+            Tracer &tracer = ctx.sessions.launch(exec_args, options);
+            launched = true;
 
-            std::vector<std::string_view> exec_args(args.begin() + 1, args.end());
-            proc = Process::launch(exec_args);
+            if (with_agent)
+                ctx.agent = tracer.run([](Session &session)
+                {
+                    return Agent::create(*session.current());
+                });
         }
     }
     catch (const std::exception &e)
@@ -497,7 +1967,62 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    cli_repl(proc);
+    for (auto &result : ctx.sessions.broadcast([&](Session &session)
+    {
+        ProcessPtr &proc = session.current();
+        proc->set_non_stop(non_stop);
+        // Indexes the debug info while the prompt is already up
+        proc->dwarf_index();
+
+        // Shared libraries are followed from the first stop on
+        try
+        {
+            if (proc->get_state() == ProcessState::Stopped)
+                proc->modules().start();
+        }
+        catch (const Error &)
+        {
+            // Breakpoints stay limited to the modules loaded so far
+        }
+        if (follow_fork)
+            session.set_fork_policy(ForkPolicy::Follow);
+        if (proc->syscalls().filtered().empty() == false)
+            proc->syscalls().enable();
+
+        // All of them are armed before the process runs at all
+        for (std::string_view location : breaks)
+        {
+            try
+            {
+                if (proc->get_state() != ProcessState::Stopped)
+                    throw std::invalid_argument("Process is running");
+                set_breakpoint(proc, location, false);
+            }
+            catch (const std::exception &e)
+            {
+                fmt::println("Warning: no breakpoint at {}: {}", location, e.what());
+            }
+        }
+
+        if (launched == false)
+            return;
+        try
+        {
+            if (auto ret = proc->run_to(stop_at))
+                report_stop(proc, *ret);
+        }
+        catch (const Error &e)
+        {
+            fmt::println("Warning: {}, staying at the exec stop", e.what());
+        }
+    }))
+        result.get();
+
+    // A stop collected before the event loop runs is not signalled again
+    if (stop_at == StopAt::None)
+        ctx.sessions.poll();
+
+    cli_repl(ctx);
 
     return 0;
 }
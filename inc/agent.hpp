@@ -0,0 +1,87 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_AGENT_HPP
+#define BKPT_LIB_AGENT_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+#include "agent_abi.h"
+
+class Process;
+
+// Debugger side of the shared memory channel to the in-tracee agent
+// Requests are served by an agent thread while the tracee keeps running
+class Agent
+{
+public:
+    Agent() = delete;
+    Agent(const Agent &) = delete;
+    Agent &operator=(const Agent &) = delete;
+    ~Agent();
+
+    // Creates the channel for proc, the agent looks for it by pid when
+    // its constructor runs, so this must precede LD_PRELOAD or dlopen
+    static std::unique_ptr<Agent> create(Process &proc);
+
+    // Library built alongside the running debugger executable
+    static std::string default_library_path();
+
+    // Loads the agent into a stopped tracee through an inferior dlopen()
+    void load(std::string_view library);
+
+    bool ready();
+    bool wait_ready(std::chrono::milliseconds timeout);
+
+    void ping();
+    std::vector<std::uint8_t> read_memory(virt_addr address, std::size_t size);
+
+    std::uint64_t counter(std::size_t index) const;
+    std::vector<bkpt_agent_record> drain_trace();
+    std::uint64_t dropped_records() const { return dropped_; }
+
+    const Process &process() const { return *process_; }
+
+private:
+    Agent(Process &proc, std::string name, bkpt_agent_channel *channel) :
+        process_(&proc), name_(std::move(name)), channel_(channel) {}
+
+    std::int64_t request(std::uint32_t op, virt_addr address, std::uint64_t len);
+
+    Process *process_;
+    std::string name_;
+    bkpt_agent_channel *channel_;
+    int doorbell_fd_ = -1;
+    std::uint64_t seq_ = 0;
+    std::uint64_t trace_tail_ = 0;
+    std::uint64_t dropped_ = 0;
+    std::chrono::milliseconds timeout_{1000};
+};
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_AGENT_ABI_H
+#define BKPT_LIB_AGENT_ABI_H
+
+/*
+ * Memory layout shared between the debugger and the in-tracee agent.
+ * Plain C so that it can be included by both sides, every field that
+ * crosses the boundary is accessed with __atomic builtins.
+ */
+
+#include <stdint.h>
+
+#define BKPT_AGENT_MAGIC        0x31474154504b4231ULL   /* "1BKPTAG1" */
+#define BKPT_AGENT_VERSION      1
+#define BKPT_AGENT_NAME_FMT     "/bkpt-agent-%d"
+#define BKPT_AGENT_COUNTERS     64
+#define BKPT_AGENT_TRACE_SLOTS  4096
+#define BKPT_AGENT_DATA_SIZE    (1u << 20)
+
+#define BKPT_AGENT_CACHELINE    __attribute__((aligned(64)))
+
+enum bkpt_agent_op
+{
+    BKPT_AGENT_OP_NONE = 0,
+    BKPT_AGENT_OP_PING,
+    BKPT_AGENT_OP_READ,
+};
+
+struct bkpt_agent_record
+{
+    uint64_t seq;           /* Slot index + 1, published last */
+    uint64_t timestamp_ns;  /* CLOCK_MONOTONIC */
+    uint64_t id;
+    uint64_t value;
+};
+
+struct bkpt_agent_channel
+{
+    /* Written once by the debugger before the agent starts */
+    uint64_t magic;
+    uint32_t version;
+    uint32_t data_size;
+
+    /* Written once by the agent when its service thread is up */
+    BKPT_AGENT_CACHELINE int32_t doorbell_fd;
+    uint32_t ready;
+
+    /* Debugger -> agent, req_seq is bumped last */
+    BKPT_AGENT_CACHELINE uint64_t req_seq;
+    uint32_t op;
+    uint32_t reserved;
+    uint64_t addr;
+    uint64_t len;
+
+    /* Agent -> debugger, resp_seq is bumped last */
+    BKPT_AGENT_CACHELINE uint64_t resp_seq;
+    int64_t status;
+
+    /* Bumped by instrumented code through bkpt_agent_counter_add() */
+    BKPT_AGENT_CACHELINE uint64_t counters[BKPT_AGENT_COUNTERS];
+
+    /* Multi producer trace ring, consumed by the debugger */
+    BKPT_AGENT_CACHELINE uint64_t trace_head;
+    BKPT_AGENT_CACHELINE struct bkpt_agent_record trace[BKPT_AGENT_TRACE_SLOTS];
+
+    BKPT_AGENT_CACHELINE uint8_t data[BKPT_AGENT_DATA_SIZE];
+};
+
+#endif
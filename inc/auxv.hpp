@@ -0,0 +1,60 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_AUXV_HPP
+#define BKPT_LIB_AUXV_HPP
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <elf.h>
+#include <sys/types.h>
+
+#include "types.hpp"
+
+// The auxiliary vector the kernel handed the process at exec, read once
+// from /proc/<pid>/auxv. It holds where the executable, its program
+// headers and the dynamic loader were mapped, so load biases come from
+// it without going through the maps or the files
+class AuxVector
+{
+public:
+    explicit AuxVector(pid_t pid);
+
+    std::optional<std::uint64_t> get(std::uint64_t type) const;
+
+    // 0 when the kernel left the entry out
+    virt_addr entry() const { return get(AT_ENTRY).value_or(0); }
+    virt_addr phdr() const { return get(AT_PHDR).value_or(0); }
+    std::uint64_t phnum() const { return get(AT_PHNUM).value_or(0); }
+
+    // Load address of the dynamic loader, 0 for static executables
+    virt_addr interpreter_base() const { return get(AT_BASE).value_or(0); }
+
+private:
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> entries_;
+};
+
+#endif
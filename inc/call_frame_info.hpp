@@ -0,0 +1,144 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_CALL_FRAME_INFO_HPP
+#define BKPT_LIB_CALL_FRAME_INFO_HPP
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+class Process;
+
+// How a register of the caller is recovered from the CFA of a frame
+struct RegisterRule
+{
+    enum Kind : uint8_t
+    {
+        Same = 0,
+        Undefined,
+        Offset,
+        ValOffset,
+        Register,
+    };
+
+    Kind kind = Same;
+    std::int64_t value = 0;
+};
+
+// One row of the CFI table, it holds for every pc in [start, end)
+struct CfiRow
+{
+    virt_addr start = 0;
+    virt_addr end = 0;
+
+    std::uint8_t cfa_reg = 31;
+    std::int64_t cfa_offset = 0;
+    std::uint8_t ra_reg = 30;
+
+    // Rules of x0-x30 and sp, vector registers play no part in unwinding
+    std::array<RegisterRule, 32> regs{};
+};
+
+// Call frame instructions copied out of the tracee and where they were,
+// a PC relative DW_CFA_set_loc counts from that address
+struct CfiInstructions
+{
+    Span<const std::uint8_t> bytes;
+    virt_addr address = 0;
+};
+
+// Call frame information of the modules mapped into the tracee, found
+// through their PT_GNU_EH_FRAME segment and read from tracee memory.
+// Rows are decoded on first use and kept per pc range, so unwinding
+// through hot code again skips CIE and FDE interpretation
+class CallFrameInfo
+{
+public:
+    explicit CallFrameInfo(Process &proc) : process_(&proc) {}
+
+    CallFrameInfo(const CallFrameInfo &) = delete;
+    CallFrameInfo &operator=(const CallFrameInfo &) = delete;
+
+    // Null when pc has no usable CFI, rules built from DWARF
+    // expressions count as unusable
+    const CfiRow *find_row(virt_addr pc);
+
+    // Lets the next lookup outside every known module scan the mappings
+    // again, called once per unwind so a bogus pc costs one scan at most
+    void allow_rescan() { rescan_ = true; }
+
+    void forget();
+    std::size_t cached_rows() const { return rows_.size(); }
+
+    // Runs the initial instructions of a CIE then those of an FDE covering
+    // [begin, end) up to pc. row gets the rules and the bounds of the row
+    // reached, false when it cannot be used
+    static bool decode_instructions(const CfiInstructions &cie, const CfiInstructions &fde,
+        std::uint64_t code_align, std::int64_t data_align, std::uint8_t fde_encoding,
+        virt_addr begin, virt_addr end, virt_addr pc, CfiRow &row);
+
+private:
+    struct Module
+    {
+        virt_addr low = 0;
+        virt_addr high = 0;
+        virt_addr eh_frame_hdr = 0;
+
+        // Sorted initial location and FDE address pairs of the hdr table
+        std::vector<std::pair<virt_addr, virt_addr>> table;
+        bool table_loaded = false;
+    };
+
+    struct Cie
+    {
+        std::uint64_t code_align = 1;
+        std::int64_t data_align = 1;
+        std::uint8_t ra_reg = 30;
+        std::uint8_t fde_encoding = 0;
+        bool augmented = false;
+        std::vector<std::uint8_t> instructions;
+        virt_addr instructions_addr = 0;
+    };
+
+    Module *find_module(virt_addr pc);
+    void scan_modules();
+    bool load_table(Module &mod);
+    const Cie *read_cie(virt_addr addr);
+    bool decode_row(const Module &mod, virt_addr fde, virt_addr pc, CfiRow &row);
+
+    std::vector<std::uint8_t> read_entry(virt_addr addr, virt_addr &body);
+
+    Process *process_;
+    std::vector<Module> modules_;
+    std::map<virt_addr, Cie> cies_;
+    std::map<virt_addr, CfiRow> rows_;
+    bool rescan_ = true;
+};
+
+#endif
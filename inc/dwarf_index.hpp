@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_DWARF_INDEX_HPP
+#define BKPT_LIB_DWARF_INDEX_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+
+class Elf;
+struct DwarfSections;
+
+// A function defined in .debug_info, the name is qualified with its
+// namespaces and classes joined by ::, addresses are file addresses.
+// Names point into the index and live as long as it does
+struct DwarfFunction
+{
+    std::string_view name;
+    std::uint32_t base = 0;
+    virt_addr low = 0;
+    virt_addr high = 0;
+    std::uint64_t die_offset = 0;
+
+    std::string_view base_name() const { return name.substr(base); }
+    bool contains(virt_addr address) const { return address >= low && address < high; }
+};
+
+// A named type definition, tag is its DW_TAG_*
+struct DwarfType
+{
+    std::string_view name;
+    std::uint32_t base = 0;
+    std::uint16_t tag = 0;
+    std::uint64_t die_offset = 0;
+
+    std::string_view base_name() const { return name.substr(base); }
+};
+
+// Functions and types of every compile unit of .debug_info. Units are
+// split across worker threads that each build a partial index, the
+// partials are merged into sorted tables that never change afterwards.
+// Indexing runs in the background from construction, lookups wait for
+// it to finish while everything else stays usable meanwhile
+//
+// The tables are laid out flat, the same way in memory as in the cache
+// file named after the build id, so a cached index is used where it is
+// mapped without parsing anything
+class DwarfIndex
+{
+public:
+    // The image has to outlive the index, threads of 0 uses one worker
+    // per hardware thread. Without a cache directory nothing is cached
+    explicit DwarfIndex(const Elf &elf, unsigned threads = 0,
+        const std::filesystem::path &cache_dir = {});
+    ~DwarfIndex();
+
+    DwarfIndex(const DwarfIndex &) = delete;
+    DwarfIndex &operator=(const DwarfIndex &) = delete;
+
+    // $XDG_CACHE_HOME/bkpt or ~/.cache/bkpt, empty without either
+    static std::filesystem::path default_cache_dir();
+
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+    void wait() const;
+
+    // Whether the tables were mapped from the cache
+    bool from_cache() const;
+
+    // Definitions whose qualified name is the query or ends with it at
+    // a :: boundary, lowest address first
+    std::vector<DwarfFunction> functions_named(std::string_view name) const;
+
+    // Function around a file address, none outside all
+    std::optional<DwarfFunction> function_containing(virt_addr address) const;
+
+    // Matched like functions_named, one entry per distinct definition
+    std::vector<DwarfType> types_named(std::string_view name) const;
+
+    std::size_t unit_count() const;
+    std::size_t function_count() const;
+    std::size_t type_count() const;
+
+private:
+    struct Partial;
+    struct FunctionRecord;
+    struct TypeRecord;
+
+    void build(unsigned threads);
+    // False when stopped before the tables were done
+    bool index(unsigned threads);
+    void index_unit(std::uint64_t offset, Partial &partial) const;
+    std::vector<std::uint8_t> merge(std::vector<Partial> &partials, std::uint64_t units) const;
+
+    // Points the tables into a layout, false when it does not hold one
+    bool attach(const std::uint8_t *data, std::size_t size);
+    bool load_cache();
+    void save_cache() const;
+
+    DwarfFunction function(const FunctionRecord &record) const;
+    DwarfType type(const TypeRecord &record) const;
+
+    std::unique_ptr<DwarfSections> sections_;
+    std::filesystem::path cache_path_;
+
+    // Written by the indexing thread only until ready_ is set
+    std::vector<std::uint8_t> owned_;
+    void *mapped_ = nullptr;
+    std::size_t mapped_size_ = 0;
+    std::uint64_t units_ = 0;
+    Span<const FunctionRecord> functions_;
+    Span<const std::uint32_t> functions_by_name_;
+    Span<const TypeRecord> types_;
+    std::string_view strings_;
+
+    std::atomic<bool> ready_{false};
+    std::atomic<bool> stop_{false};
+    mutable std::mutex mutex_;
+    mutable std::condition_variable done_;
+    std::thread thread_;
+};
+
+#endif
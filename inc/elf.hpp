@@ -0,0 +1,118 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_ELF_HPP
+#define BKPT_LIB_ELF_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <elf.h>
+
+#include "types.hpp"
+
+// A function or object symbol, name points into the mapped string table
+struct ElfSymbol
+{
+    std::string_view name;
+    virt_addr address = 0;
+    std::uint64_t size = 0;
+    std::uint8_t type = STT_NOTYPE;
+
+    bool contains(virt_addr addr) const
+    {
+        return addr == address || (addr > address && addr - address < size);
+    }
+};
+
+// Read only view of an ELF64 file mapped into memory, headers, section
+// contents and names are used in place. The symbol indexes are built on
+// the first lookup so opening even a large binary costs one mmap
+//
+// Addresses taken and returned are file addresses, the link time ones
+// load_bias() shifts into the running image
+class Elf
+{
+public:
+    explicit Elf(const std::filesystem::path &path);
+    ~Elf();
+
+    Elf(const Elf &) = delete;
+    Elf &operator=(const Elf &) = delete;
+
+    const std::filesystem::path &path() const { return path_; }
+    const Elf64_Ehdr &header() const { return *header_; }
+
+    Span<const Elf64_Shdr> sections() const { return sections_; }
+    Span<const Elf64_Phdr> program_headers() const { return program_headers_; }
+
+    std::string_view section_name(const Elf64_Shdr &section) const;
+    const Elf64_Shdr *section(std::string_view name) const;
+    const Elf64_Shdr *section_containing(virt_addr address) const;
+    Span<const std::uint8_t> section_contents(const Elf64_Shdr &section) const;
+
+    // NT_GNU_BUILD_ID in lowercase hex, empty when the linker left it out
+    std::string build_id() const;
+
+    // Where file offset 0 sits in the file's own address space
+    virt_addr image_base() const;
+
+    // PT_INTERP, the dynamic loader the kernel maps along, empty for
+    // static executables and shared objects
+    std::string_view interpreter() const;
+
+    virt_addr load_bias() const { return load_bias_; }
+    void set_load_bias(virt_addr bias) { load_bias_ = bias; }
+
+    // Both .symtab and .dynsym, a symbol present in both counts once
+    std::vector<const ElfSymbol *> symbols_by_name(std::string_view name) const;
+    const ElfSymbol *symbol_at(virt_addr address) const;
+    const ElfSymbol *symbol_containing(virt_addr address) const;
+    std::size_t symbol_count() const;
+
+private:
+    void build_symbol_index() const;
+    void add_symbols(const Elf64_Shdr &table) const;
+
+    std::filesystem::path path_;
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+
+    const Elf64_Ehdr *header_ = nullptr;
+    Span<const Elf64_Shdr> sections_;
+    Span<const Elf64_Phdr> program_headers_;
+    const char *section_names_ = nullptr;
+    std::size_t section_names_size_ = 0;
+
+    virt_addr load_bias_ = 0;
+
+    // Sorted by address, the name hash table refers to symbols by position
+    mutable bool indexed_ = false;
+    mutable std::vector<ElfSymbol> symbols_;
+    mutable std::vector<std::uint32_t> name_slots_;
+};
+
+#endif
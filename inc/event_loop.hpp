@@ -0,0 +1,91 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_EVENT_LOOP_HPP
+#define BKPT_LIB_EVENT_LOOP_HPP
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <signal.h>
+
+// Single threaded epoll loop multiplexing file descriptors, timers and
+// signals, so a running tracee never blocks the rest of the debugger
+class EventLoop
+{
+public:
+    using Callback = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    // Calls cb whenever fd is readable, the caller keeps owning fd
+    void watch_fd(int fd, Callback cb);
+    void unwatch_fd(int fd);
+
+    // Returns an id for cancel_timer(), one shot timers cancel themselves
+    int add_timer(std::chrono::milliseconds interval, Callback cb,
+        bool repeat = true);
+    void cancel_timer(int id);
+
+    // Blocks signo for the calling thread and delivers it through the loop
+    // instead, use for SIGCHLD to learn about tracee state changes
+    void watch_signal(int signo, Callback cb);
+
+    // Dispatches ready sources once, returns false if nothing happened
+    // within timeout, a negative timeout waits forever
+    bool run_once(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    // Runs until stop() is called from a callback
+    void run();
+    void stop() { running_ = false; }
+
+private:
+    enum class SourceKind
+    {
+        Fd,
+        Timer,
+        Signal,
+    };
+
+    struct Source
+    {
+        SourceKind kind;
+        Callback callback;
+        bool repeat;
+    };
+
+    void add_source(int fd, SourceKind kind, Callback cb, bool repeat);
+    void remove_source(int fd);
+
+    int epoll_fd_ = -1;
+    bool running_ = false;
+    std::map<int, Source> sources_;
+    sigset_t blocked_;
+};
+
+#endif
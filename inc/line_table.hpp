@@ -0,0 +1,156 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_LINE_TABLE_HPP
+#define BKPT_LIB_LINE_TABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+class Elf;
+struct DwarfSections;
+
+// A row of the line table, the address is a file address
+struct LineEntry
+{
+    virt_addr address = 0;
+    std::string_view file;
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+    bool is_stmt = false;
+    bool prologue_end = false;
+};
+
+// Source lines of .debug_line, DWARF 4 and 5. Only the unit headers of
+// .debug_info are read up front, a compile unit's line program is run
+// the first time an address inside the unit is looked up. The reverse
+// file:line index of a unit is built on the first query for one of the
+// files it names
+class LineTable
+{
+public:
+    explicit LineTable(const Elf &elf);
+    ~LineTable();
+
+    LineTable(const LineTable &) = delete;
+    LineTable &operator=(const LineTable &) = delete;
+
+    // Row covering a file address, none in gaps and past sequence ends
+    std::optional<LineEntry> line_at(virt_addr address);
+
+    // [start, end) of the code of the line around address, it ends at
+    // the next statement of another line or at the end of the sequence
+    std::optional<std::pair<virt_addr, virt_addr>> line_range(virt_addr address);
+
+    // Statement rows of a line, lowest address first, file matches a
+    // full path or its trailing components
+    std::vector<LineEntry> entries_for(std::string_view file, std::uint32_t line);
+
+    std::size_t unit_count();
+    std::size_t decoded_units() const;
+
+private:
+    enum RowFlags : std::uint8_t
+    {
+        ROW_IS_STMT = 1,
+        ROW_END_SEQUENCE = 2,
+        ROW_PROLOGUE_END = 4,
+    };
+
+    struct Row
+    {
+        virt_addr address;
+        std::uint32_t line;
+        std::uint32_t file;
+        std::uint16_t column;
+        std::uint8_t flags;
+    };
+
+    struct Program
+    {
+        std::uint16_t version = 0;
+        std::uint8_t min_inst_length = 1;
+        bool default_is_stmt = true;
+        std::int8_t line_base = 0;
+        std::uint8_t line_range = 1;
+        std::uint8_t opcode_base = 1;
+        std::vector<std::uint8_t> opcode_lengths;
+        std::uint64_t start = 0;
+        std::uint64_t end = 0;
+    };
+
+    struct Unit
+    {
+        std::uint64_t line_offset = 0;
+        std::string_view comp_dir;
+        bool dwarf64 = false;
+        std::uint8_t address_size = 8;
+        std::uint64_t str_offsets_base = 0;
+
+        bool header_read = false;
+        bool decoded = false;
+        bool reverse_built = false;
+        Program program;
+        std::vector<std::string> files;
+
+        // By address, and by file, line then address once asked for
+        std::vector<Row> rows;
+        std::vector<Row> by_line;
+    };
+
+    struct Range
+    {
+        virt_addr low;
+        virt_addr high;
+        std::size_t unit;
+    };
+
+    void scan_units();
+    void read_ranges();
+    void read_header(Unit &unit);
+    void decode(Unit &unit);
+    void build_reverse(Unit &unit);
+    // Row covering address, null in gaps and past sequence ends
+    const Row *locate(virt_addr address, const Unit *&unit);
+    const Row *find_row(const Unit &unit, virt_addr address) const;
+    LineEntry make_entry(const Unit &unit, const Row &row) const;
+
+    std::unique_ptr<DwarfSections> sections_;
+    bool scanned_ = false;
+    std::vector<Unit> units_;
+
+    // Address ranges of units sorted by low, units without any are
+    // decoded in turn once a lookup misses every range
+    std::vector<Range> ranges_;
+    std::vector<std::size_t> unplaced_;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_MODULE_LIST_HPP
+#define BKPT_LIB_MODULE_LIST_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+#include "elf.hpp"
+#include "breakpoint_site.hpp"
+
+class Process;
+
+// A shared object on the link map of the dynamic loader, base is the
+// load bias it was mapped with
+struct LoadedModule
+{
+    std::string path;
+    virt_addr base = 0;
+    virt_addr dynamic = 0;
+
+    // Its link_map entry, told apart from a module loaded later in the
+    // same place by the path and base
+    virt_addr link_map = 0;
+};
+
+// A breakpoint on a symbol of a module that may not be loaded yet
+struct PendingBreakpoint
+{
+    std::string symbol;
+    bool hardware = false;
+
+    // Where it resolved, 0 while no loaded module defines the symbol
+    virt_addr address = 0;
+    virt_addr link_map = 0;
+};
+
+// Modules of a process as the dynamic loader reports them through the
+// r_debug rendezvous. The loader calls r_brk around every change to its
+// link map, an internal breakpoint there keeps the list in step with
+// dlopen and dlclose. Only modules that came or went are looked at, and
+// each new one resolves all pending breakpoints it defines at once
+//
+// Tracking starts on request, the internal breakpoint otherwise shows
+// up in the sites of the process and ends batched steps in the loader
+class ModuleList
+{
+public:
+    ModuleList() = delete;
+    ModuleList(const ModuleList &) = delete;
+    ModuleList &operator=(const ModuleList &) = delete;
+    ~ModuleList();
+
+    // Finds r_debug through auxv and plants the breakpoint on r_brk, the
+    // process must be stopped. False for static executables
+    bool start();
+    bool active() const { return breakpoint_ != 0; }
+
+    // The internal breakpoint on r_brk, 0 while not tracking
+    virt_addr breakpoint_address() const { return breakpoint_; }
+
+    // In link map order, the executable itself is left out
+    const std::vector<LoadedModule> &modules() const { return modules_; }
+
+    // Symbol table of a module with its load bias set, opened on first
+    // use, null when the path is not a readable ELF file
+    const Elf *elf(const LoadedModule &module);
+
+    // Runtime address of the first module symbol with the name
+    std::optional<virt_addr> symbol_address(std::string_view name);
+
+    // Sets a breakpoint on the symbol once a module defines it, right
+    // away when a loaded one does
+    const PendingBreakpoint &add_breakpoint(std::string symbol, bool hardware = false);
+    const std::vector<PendingBreakpoint> &breakpoints() const { return breakpoints_; }
+
+private:
+    friend Process;
+    explicit ModuleList(Process &proc) : process_(&proc) {}
+
+    // Re-reads the link map at a stop on r_brk once the loader reports
+    // it consistent
+    void update();
+
+    // Drops modules and the sites placed in them, the address space is
+    // gone so nothing is written back
+    void forget();
+
+    // A followed fork child starts with the modules of its parent
+    void inherit(const ModuleList &parent);
+
+    void add_module(LoadedModule module);
+    void remove_module(std::size_t index);
+    bool resolve(PendingBreakpoint &bp, const LoadedModule &module, const Elf &image);
+
+    Process *process_;
+    virt_addr rendezvous_ = 0;
+    virt_addr breakpoint_ = 0;
+    std::vector<LoadedModule> modules_;
+
+    // Parallel to modules_, shared with fork children
+    struct Image
+    {
+        std::shared_ptr<Elf> elf;
+        bool opened = false;
+    };
+    std::vector<Image> images_;
+
+    std::vector<PendingBreakpoint> breakpoints_;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_PERF_SAMPLER_HPP
+#define BKPT_LIB_PERF_SAMPLER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+
+#include "types.hpp"
+#include "step_profiler.hpp"
+
+class Process;
+
+// Samples every thread of the tracee with the cpu-clock software event,
+// which needs no PMU and works in VMs. The kernel records the ip and the
+// user callchain into a ring buffer per thread, so the tracee never
+// stops for a sample. Threads created after construction are not sampled
+class PerfSampler
+{
+public:
+    explicit PerfSampler(const Process &proc, std::uint64_t frequency = 999);
+    ~PerfSampler();
+
+    PerfSampler(const PerfSampler &) = delete;
+    PerfSampler &operator=(const PerfSampler &) = delete;
+
+    // Samples for the given time, ring buffers are drained as they fill
+    void run_for(std::chrono::milliseconds duration);
+
+    // Samples per ip
+    const PcHistogram &histogram() const { return histogram_; }
+
+    const StackCounts &stacks() const { return stacks_; }
+
+    std::uint64_t samples() const { return samples_; }
+    std::uint64_t lost() const { return lost_; }
+
+private:
+    struct Buffer
+    {
+        pid_t tid = 0;
+        int fd = -1;
+        std::uint8_t *base = nullptr;
+    };
+
+    void open_thread(pid_t tid, std::uint64_t frequency);
+    void release();
+    void set_enabled(bool enable);
+    void drain(Buffer &buf);
+    void copy_out(const Buffer &buf, std::uint64_t offset,
+        void *dest, std::size_t size) const;
+    void record_sample(const std::uint8_t *data, std::size_t size);
+
+    std::vector<Buffer> buffers_;
+    std::size_t page_size_ = 0;
+    std::size_t data_size_ = 0;
+
+    PcHistogram histogram_;
+    StackCounts stacks_;
+    std::uint64_t samples_ = 0;
+    std::uint64_t lost_ = 0;
+};
+
+#endif
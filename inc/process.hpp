@@ -25,15 +25,29 @@
 #ifndef BKPT_LIB_PROCESS_H
 #define BKPT_LIB_PROCESS_H
 
+#include <array>
+#include <csignal>
+#include <functional>
+#include <map>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <sys/types.h>
 
 #include "types.hpp"
 #include "registers.hpp"
 #include "stoppoint_collection.hpp"
 #include "breakpoint_site.hpp"
+#include "scratch_allocator.hpp"
+#include "unwinder.hpp"
+#include "elf.hpp"
+#include "line_table.hpp"
+#include "dwarf_index.hpp"
+#include "module_list.hpp"
+#include "auxv.hpp"
+#include "syscall_tracer.hpp"
 
 enum class ProcessState : uint8_t
 {
@@ -44,6 +58,139 @@ enum class ProcessState : uint8_t
     Terminated,
 };
 
+// Where a launched process is handed over
+enum class StopAt : uint8_t
+{
+    Exec = 0,   // The exec stop, before the dynamic loader ran
+    Entry,      // AT_ENTRY of the executable
+    Main,       // The main symbol
+    None,       // Left running
+};
+
+struct LaunchOptions
+{
+    StopAt stop_at = StopAt::Exec;
+
+    // Receives the debugger end of a socket wired to the tracee stdio
+    std::optional<int*> comm = std::nullopt;
+
+    // Shared library prepended to LD_PRELOAD of the tracee
+    std::string preload;
+
+    // System calls a seccomp filter hands to the tracer, see SyscallTracer.
+    // Children that are not followed keep the filter without a tracer and
+    // see these calls fail with ENOSYS
+    std::vector<int> trace_syscalls;
+};
+
+// What the last stop of a thread was caused by
+enum class StopReason : uint8_t
+{
+    Signal = 0,
+    Exec,
+};
+
+// Per thread bookkeeping, every traced thread owns its register cache
+struct ThreadState
+{
+    pid_t tid = 0;
+    ProcessState state = ProcessState::Stopped;
+
+    // Signal of the last stop reported for this thread
+    std::uint8_t stop_info = 0;
+    StopReason reason = StopReason::Signal;
+
+    // A stop we requested is still due and must be swallowed, a queued
+    // SIGSTOP or for seized threads a PTRACE_INTERRUPT
+    bool expect_stop = false;
+
+    // Register cache matches the thread, refreshed lazily on selection
+    bool regs_valid = false;
+
+    // Stop collected while halting the thread, reported by the next wait
+    std::optional<int> pending_status;
+
+    // Inside a traced system call, resumed with PTRACE_SYSCALL to see it return
+    bool syscall_exit = false;
+
+    // Signal held back from its stop, delivered when the thread is resumed
+    int pending_signal = 0;
+
+    std::unique_ptr<Registers> regs;
+};
+
+// Bounds of a batched step, it ends on whichever is met first
+struct StepLimits
+{
+    // Most instructions to execute, zero for no limit
+    std::uint64_t count = 0;
+
+    // Ends once pc reaches this address
+    std::optional<virt_addr> until;
+
+    // Ends once pc leaves [first, second)
+    std::optional<std::pair<virt_addr, virt_addr>> range;
+};
+
+// Why a batched step ended
+enum class StepEnd : uint8_t
+{
+    Count = 0,
+    Until,
+    Range,
+    Breakpoint,
+    Signal,
+    Exited,
+};
+
+// Sees the pc of every instruction a batched step is about to execute
+using StepObserver = std::function<void(virt_addr pc)>;
+
+struct StepResult
+{
+    std::uint64_t steps = 0;
+    StepEnd end = StepEnd::Count;
+
+    // Same as returned by step_instruction() for the last step
+    std::uint8_t info = 0;
+    double seconds = 0;
+};
+
+// Registers a frame pointer unwind starts from
+struct FrameRegisters
+{
+    virt_addr pc = 0;
+    virt_addr sp = 0;
+    virt_addr fp = 0;
+    virt_addr lr = 0;
+};
+
+// Values left by an inferior call in the AAPCS64 result registers
+struct CallResult
+{
+    std::uint64_t x0;
+    std::uint64_t x1;
+    double d0;
+    float s0;
+};
+
+// What a signal on its way to the tracee does. Without stop it is passed
+// on from within wait(), with stop the next resume() delivers it
+struct SignalPolicy
+{
+    bool stop = true;
+    bool print = true;
+    bool pass = true;
+};
+
+class Process;
+
+// Receives a forked child, which is stopped and carries our breakpoints
+using ForkHandler = std::function<void(std::unique_ptr<Process>)>;
+
+// Told of signals that went by without a stop but are to be printed
+using SignalObserver = std::function<void(pid_t tid, int signo)>;
+
 class Process
 {
 public:
@@ -58,14 +205,75 @@ public:
         std::optional<int*> comm = std::nullopt);
 
     static std::unique_ptr<Process>
-    attach(pid_t pid);
+    launch(std::vector<std::string_view> &exec_args,
+        const LaunchOptions &options);
+
+    // Moves a process on from its exec stop. Entry and main are reached
+    // through a one-shot internal breakpoint and the stop is returned, a
+    // stop that comes first is returned as is. None resumes without waiting
+    std::optional<std::uint8_t> run_to(StopAt where);
 
+    // With seize the tracee keeps running, PTRACE_SEIZE replaces the
+    // SIGSTOP of PTRACE_ATTACH and stops are requested by PTRACE_INTERRUPT
+    static std::unique_ptr<Process>
+    attach(pid_t pid, bool seize = false);
+
+    // Blocks until any thread reports a stop or the process ends, clone
+    // events and thread exits are handled internally, the reporting
+    // thread becomes current and every other thread is halted
     std::uint8_t wait();
+
+    // Same as wait() but only consumes events that are already queued
+    std::optional<std::uint8_t> try_wait();
+
     void resume();
     std::uint8_t step_instruction();
 
-    pid_t get_pid() { return pid_; }
-    ProcessState get_state() { return state_; }
+    // Single steps the current thread until a limit is met, reading back
+    // only the general purpose registers in between, an enabled
+    // breakpoint about to be executed ends it as well
+    StepResult step_instructions(const StepLimits &limits,
+        const StepObserver &observer = nullptr);
+
+    // Asks a running tracee to stop, the stop is reported by wait()
+    void interrupt();
+
+    // Halts every running thread in place without reporting a stop, a
+    // thread that stops for another reason keeps it pending for wait()
+    // Returns the threads release_threads() continues again
+    std::vector<pid_t> halt_threads();
+    void release_threads(const std::vector<pid_t> &tids);
+
+    // Read with a single NT_PRSTATUS fetch when the cache is stale
+    FrameRegisters frame_registers(pid_t tid);
+
+    // In non-stop mode a stop halts only the reporting thread and resume()
+    // continues only the current one, the rest keep running throughout
+    void set_non_stop(bool enable);
+    bool non_stop() const { return non_stop_; }
+    bool seized() const { return seized_; }
+
+    // Without a handler forked children are detached, with their copy
+    // of our breakpoints removed first. Children of a process launched
+    // with trace_syscalls keep its filter and need a handler, detached
+    // the calls it traces fail with ENOSYS
+    void set_fork_handler(ForkHandler handler) { fork_handler_ = std::move(handler); }
+
+    // Defaults follow gdb, SIGTRAP and SIGSTOP carry our own stops so
+    // they always stop and are never passed. Forked children inherit it
+    void set_signal_policy(int signo, SignalPolicy policy);
+    const SignalPolicy &signal_policy(int signo) const;
+    void set_signal_observer(SignalObserver observer) { signal_observer_ = std::move(observer); }
+
+    pid_t get_pid() const { return pid_; }
+    ProcessState get_state() const { return state_; }
+    StopReason stop_reason() const { return threads_.at(current_tid_).reason; }
+    const std::string &exe_path() const { return exe_path_; }
+
+    // Thread selected for register access, stepping and memory pokes
+    pid_t current_thread() const { return current_tid_; }
+    void select_thread(pid_t tid);
+    const std::map<pid_t, ThreadState> &threads() const { return threads_; }
 
     virt_addr get_pc();
     void set_pc(virt_addr address);
@@ -81,11 +289,72 @@ public:
     void clear_hw_breakpoint(int index);
     void clear_hw_watchpoint(int index);
 
+    // Removes a site whose code was unmapped, nothing is written back
+    void discard_breakpoint_site(virt_addr address);
+
     StoppointCollection<BreakpointSite>&
     breakpoint_sites() { return breakpoint_sites_; }
     const StoppointCollection<BreakpointSite>&
     breakpoint_sites() const { return breakpoint_sites_; }
 
+    // Runs a single syscall inside the stopped tracee and returns raw x0
+    // Register state and the clobbered stub location are restored after
+    template <typename... Args>
+    std::uint64_t inject_syscall(std::uint64_t nr, Args... args)
+    {
+        static_assert(sizeof...(Args) <= 6,
+            "AArch64 syscalls take at most six arguments");
+        const std::uint64_t argv[] = {static_cast<std::uint64_t>(args)..., 0};
+        return inject_syscall_args(nr, {argv, sizeof...(Args)});
+    }
+
+    // Calls fn inside the tracee following AAPCS64, integer arguments go
+    // to x0-x7 and floating point ones to v0-v7 before spilling to stack
+    CallResult call_function(virt_addr fn, const std::vector<RegisterValue> &args);
+
+    ScratchAllocator &scratch() { return *scratch_; }
+    const ScratchAllocator &scratch() const { return *scratch_; }
+
+    // Backtraces of stopped threads, keeps the last stack of each thread
+    Unwinder &unwinder() { return *unwinder_; }
+
+    // Shared objects and breakpoints waiting for them, once started
+    ModuleList &modules() { return *modules_; }
+
+    // System calls the launch filter selected, once enabled
+    SyscallTracer &syscalls() { return *syscalls_; }
+
+    // Auxiliary vector of the current image, read on first use
+    const AuxVector &auxv();
+
+    // Executable image of the process with its load bias set, opened on
+    // first use, null when the file cannot be read as ELF
+    const Elf *elf();
+
+    // Load bias of a module given by path or file name. The executable and
+    // the dynamic loader are placed through auxv, shared objects through
+    // the link map once modules are tracked
+    std::optional<virt_addr> load_bias(std::string_view module);
+
+    // Symbol around a runtime address of the executable and its offset
+    std::optional<std::pair<const ElfSymbol *, virt_addr>> symbolize(virt_addr address);
+
+    // Runtime address of the first symbol of the executable with the
+    // name, else of a loaded module, else of the function the debug
+    // info gives that source name once dwarf_index() has finished
+    std::optional<virt_addr> symbol_address(std::string_view name);
+
+    // Source lines of the executable, decoded as they are looked up
+    LineTable *line_table();
+
+    // Functions and types of the debug info, indexing starts in the
+    // background on the first call
+    const DwarfIndex *dwarf_index();
+
+    // Same as the LineTable lookups with runtime addresses
+    std::optional<LineEntry> source_line(virt_addr address);
+    std::vector<virt_addr> line_addresses(std::string_view file, std::uint32_t line);
+
     std::vector<std::uint8_t>
     read_memory(virt_addr address, std::size_t size) const;
     std::vector<std::uint8_t>
@@ -99,15 +368,87 @@ public:
 
 private:
     Process(pid_t pid, bool kill_on_end) : 
-        pid_(pid), kill_on_end_(kill_on_end), reg_state_(new Registers(*this)){}
+        pid_(pid), current_tid_(pid), kill_on_end_(kill_on_end),
+        debug_state_(new Registers(*this)), scratch_(new ScratchAllocator(*this)),
+        unwinder_(new Unwinder(*this)), modules_(new ModuleList(*this)),
+        syscalls_(new SyscallTracer(*this))
+    {
+        reg_state_ = add_thread(pid).regs.get();
+    }
+    static std::array<SignalPolicy, NSIG> default_signal_policies();
+
     void get_registers();
     void set_registers();
+    void get_registers(ThreadState &thread);
+    void get_gprs(ThreadState &thread);
+    void set_registers(ThreadState &thread);
+
+    ThreadState &add_thread(pid_t tid);
+    void attach_threads();
+    void set_trace_options(pid_t tid);
+    void ensure_debug_state();
+    void write_debug_state_all(int note);
+    void write_debug_state(pid_t tid, int note);
+
+    void wait_thread(pid_t tid, int &status);
+    std::optional<std::uint8_t> wait_for_event(bool block);
+    std::uint8_t report_stop(pid_t tid, int status);
+    std::uint8_t report_exit(int status);
+    pid_t adopt_clone(pid_t parent);
+    void adopt_fork(pid_t parent, bool vfork);
+    bool handle_ptrace_event(ThreadState &thread, int status, bool resume_new);
+    void handle_exec();
+    void lift_software_sites(pid_t tid);
+    void rearm_software_sites(pid_t tid, std::vector<BreakpointSite *> sites);
+    void stop_other_threads(pid_t except);
+    bool is_requested_stop(const ThreadState &thread, int status) const;
+    bool absorb_signal(ThreadState &thread, int status);
+    std::vector<pid_t> lift_breakpoint(BreakpointSite &bp);
+    bool step_over_breakpoint(ThreadState &thread);
+    bool is_rendezvous_stop(ThreadState &thread, int status);
+    bool pass_rendezvous(ThreadState &thread);
+    std::vector<pid_t> running_threads() const;
+    void resume_halted(const std::vector<pid_t> &tids);
+    void resume_thread(ThreadState &thread);
+    int single_step_thread(ThreadState &thread);
+    std::uint8_t complete_step(ThreadState &thread, int status);
+
+    std::uint64_t inject_syscall_args(std::uint64_t nr,
+        Span<const std::uint64_t> args);
+    std::uint64_t run_syscall_stub(std::uint64_t nr,
+        Span<const std::uint64_t> args, virt_addr stub);
 
     pid_t pid_ = 0;
+    pid_t current_tid_ = 0;
     bool kill_on_end_ = true;
+    bool seized_ = false;
+    bool non_stop_ = false;
+    bool debug_state_valid_ = false;
     ProcessState state_ = ProcessState::Init;
-    std::unique_ptr<Registers> reg_state_;
+    std::map<pid_t, ThreadState> threads_;
+    std::string exe_path_;
+    ForkHandler fork_handler_;
+    SignalObserver signal_observer_;
+    std::array<SignalPolicy, NSIG> signal_policies_ = default_signal_policies();
+
+    // Breakpoints taken out of memory shared with a detached vfork child
+    std::vector<virt_addr> lifted_sites_;
+
+    // Register cache of the current thread
+    Registers *reg_state_ = nullptr;
+
+    // Hardware breakpoint and watchpoint slots mirrored into every thread
+    std::unique_ptr<Registers> debug_state_;
     StoppointCollection<BreakpointSite> breakpoint_sites_;
+    std::unique_ptr<ScratchAllocator> scratch_;
+    std::unique_ptr<Unwinder> unwinder_;
+    std::unique_ptr<ModuleList> modules_;
+    std::unique_ptr<SyscallTracer> syscalls_;
+    std::unique_ptr<Elf> elf_;
+    std::unique_ptr<LineTable> lines_;
+    std::unique_ptr<DwarfIndex> index_;
+    std::unique_ptr<AuxVector> auxv_;
+    bool elf_loaded_ = false;
 };
 
 #endif
@@ -210,6 +210,9 @@ private:
     friend Process;
     Process *proc_;
 
+    // Set by writes until the cache is flushed back to the thread
+    bool dirty_ = false;
+
 #if defined(__aarch64__)
     struct user_pt_regs gpr_{};
     struct user_fpsimd_state fpr_{};
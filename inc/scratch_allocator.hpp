@@ -0,0 +1,82 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_SCRATCH_ALLOCATOR_HPP
+#define BKPT_LIB_SCRATCH_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "types.hpp"
+
+class Process;
+
+// Bump allocator over anonymous RWX pages mapped inside the tracee
+// Pages are obtained with an injected mmap() and are only returned
+// to the tracee as a whole through release()
+class ScratchAllocator
+{
+public:
+    ScratchAllocator() = delete;
+    ScratchAllocator(const ScratchAllocator &) = delete;
+    ScratchAllocator &operator=(const ScratchAllocator &) = delete;
+
+    virt_addr allocate(std::size_t size, std::size_t align = 16);
+    void release();
+
+    // Address of the reserved syscall stub slot, 0 until first page is mapped
+    virt_addr stub_address() const { return stub_addr_; }
+
+    // Fixed return address for inferior calls, maps the first page if needed
+    virt_addr trap_address();
+
+    std::size_t mapped_size() const;
+    bool empty() const { return regions_.empty(); }
+
+private:
+    friend Process;
+    explicit ScratchAllocator(Process &proc) : process_(&proc) {}
+
+    // Drops bookkeeping without unmapping, used when the address space is gone
+    void forget() { regions_.clear(); stub_addr_ = 0; }
+
+    struct Region
+    {
+        virt_addr base;
+        std::size_t size;
+        std::size_t used;
+    };
+
+    virt_addr map_region(std::size_t size, std::size_t align);
+
+    // Syscall stub followed by the inferior call return trap
+    static constexpr std::size_t STUB_SLOT_SIZE = 16;
+    static constexpr std::size_t TRAP_OFFSET = 8;
+
+    Process *process_;
+    virt_addr stub_addr_ = 0;
+    std::vector<Region> regions_;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_SESSION_HPP
+#define BKPT_LIB_SESSION_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sys/types.h>
+
+#include "process.hpp"
+
+enum class ForkPolicy : uint8_t
+{
+    Detach = 0,
+    Follow,
+};
+
+// Owns every process of a debugging session, children forked by a
+// traced process join the session or are let go according to policy
+class Session
+{
+public:
+    using ProcessPtr = std::unique_ptr<Process>;
+
+    Session() = default;
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    // The first process added becomes current
+    Process &add(ProcessPtr proc);
+
+    // Followed children are resumed right away, the callback announces them.
+    // Children of a process with a system call filter are always followed
+    void set_fork_policy(ForkPolicy policy);
+    ForkPolicy fork_policy() const { return policy_; }
+    void on_follow(std::function<void(Process &)> callback) { on_follow_ = std::move(callback); }
+
+    // Signals a process passed on without stopping, as its policy asks
+    void on_signal(std::function<void(Process &, pid_t, int)> callback) { on_signal_ = std::move(callback); }
+
+    ProcessPtr &current() { return processes_.at(current_); }
+    void select(pid_t pid);
+    const std::map<pid_t, ProcessPtr> &processes() const { return processes_; }
+    std::size_t size() const { return processes_.size(); }
+
+    // Reports the next stop or end of any process, which becomes current
+    std::optional<std::uint8_t> try_wait();
+    std::uint8_t wait();
+
+    // True while any process has not exited or been terminated
+    bool alive() const;
+
+    // Drops processes that have ended while others are still alive,
+    // true when the current process was among them
+    bool prune();
+
+private:
+    void install_fork_handler(Process &proc);
+    void follow(ProcessPtr child);
+    static bool ended(const Process &proc);
+
+    std::map<pid_t, ProcessPtr> processes_;
+    pid_t current_ = 0;
+    ForkPolicy policy_ = ForkPolicy::Detach;
+    std::function<void(Process &)> on_follow_;
+    std::function<void(Process &, pid_t, int)> on_signal_;
+};
+
+#endif
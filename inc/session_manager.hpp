@@ -0,0 +1,90 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_SESSION_MANAGER_HPP
+#define BKPT_LIB_SESSION_MANAGER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tracer.hpp"
+
+// Debugs any number of independent processes at once, each one gets a
+// tracer thread of its own and their events meet in one queue
+class SessionManager
+{
+public:
+    SessionManager() = default;
+
+    SessionManager(const SessionManager &) = delete;
+    SessionManager &operator=(const SessionManager &) = delete;
+
+    // Attaches to all pids in parallel, failures are returned as messages
+    // and leave no tracer behind, the first process attached becomes current
+    std::vector<std::string> attach(const std::vector<pid_t> &pids, bool seize = false);
+
+    Tracer &launch(std::vector<std::string_view> &exec_args, const LaunchOptions &options);
+
+    // Pids whose command line matches the regular expression, like pgrep -f
+    static std::vector<pid_t> find_pids(std::string_view pattern);
+
+    const std::vector<std::unique_ptr<Tracer>> &tracers() const { return tracers_; }
+    bool empty() const { return tracers_.empty(); }
+
+    Tracer &current() { return *tracers_.at(current_); }
+    void select(const Tracer &tracer);
+
+    // Tracer whose session holds pid, if any
+    Tracer *find(pid_t pid);
+
+    // Asks every tracer to collect the state changes of its processes
+    void poll();
+    EventQueue &events() { return events_; }
+
+    // Runs f(session) on every tracer thread at once and returns as soon
+    // as all of them are done, in the order of tracers()
+    template <typename F>
+    auto broadcast(F f) -> std::vector<std::future<std::invoke_result_t<F, Session &>>>
+    {
+        std::vector<std::future<std::invoke_result_t<F, Session &>>> results;
+        for (auto &tracer : tracers_)
+            results.push_back(tracer->post(f));
+        for (auto &result : results)
+            result.wait();
+        return results;
+    }
+
+    // Drops tracers left without live processes while others still have
+    // some, true when the current tracer was among them
+    bool prune();
+
+private:
+    EventQueue events_;
+    std::vector<std::unique_ptr<Tracer>> tracers_;
+    std::size_t current_ = 0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_SOURCE_STEPPER_HPP
+#define BKPT_LIB_SOURCE_STEPPER_HPP
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+#include "types.hpp"
+
+class Process;
+
+// How an A64 instruction may move pc, as far as stepping cares
+enum class BranchKind : std::uint8_t
+{
+    None = 0,
+    Direct,
+    Conditional,
+    Call,
+    CallIndirect,
+    Indirect,
+    Return,
+};
+
+// Target is set for the pc relative kinds
+BranchKind classify_branch(std::uint32_t insn, virt_addr pc, virt_addr &target);
+
+// Source line stepping of the current thread. Execution runs to the next
+// branch of the line under an internal breakpoint and only the branch is
+// single stepped, calls that are not entered run to a breakpoint at
+// their return address. The functions return what step_instruction()
+// would for the last stop, a stop for any other reason ends them early
+class SourceStepper
+{
+public:
+    explicit SourceStepper(Process &proc) : process_(&proc) {}
+
+    // Next line, entering calls to functions with line information
+    std::uint8_t step_in();
+
+    // Next line of this function or of a caller it returns to
+    std::uint8_t step_over();
+
+    // Until the current function returns to its caller
+    std::uint8_t step_out();
+
+    // Stops the last command took, breakpoint hits and single steps
+    std::uint64_t stops() const { return stops_; }
+
+private:
+    enum class RangeEnd : std::uint8_t
+    {
+        Left = 0,
+        EnteredCall,
+        Stopped,
+    };
+
+    std::uint8_t step_line(bool into);
+    RangeEnd step_range(virt_addr low, virt_addr high, bool into, std::uint8_t &info);
+    bool continue_to(const std::vector<virt_addr> &targets, virt_addr min_sp,
+        std::uint8_t &info);
+    bool enter_function(std::uint8_t &info);
+    bool single_step(std::uint8_t &info);
+
+    virt_addr current_sp() const;
+    std::optional<std::pair<virt_addr, virt_addr>> line_range(virt_addr pc) const;
+
+    Process *process_;
+    pid_t tid_ = 0;
+    std::uint64_t stops_ = 0;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_STEP_PROFILER_HPP
+#define BKPT_LIB_STEP_PROFILER_HPP
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+#include "process.hpp"
+
+// Coarse A64 instruction classes, SIMD loads and stores count as memory
+enum class InsnClass : uint8_t
+{
+    Other = 0,
+    Load,
+    Store,
+    Branch,
+    Simd,
+    System,
+    Count,
+};
+
+InsnClass classify_instruction(std::uint32_t insn);
+std::string_view insn_class_name(InsnClass cls);
+
+// Open addressing table from pc to execution count, doubles as the
+// decoder cache since an instruction is classified on its first run
+class PcHistogram
+{
+public:
+    struct Entry
+    {
+        virt_addr pc = 0;
+        std::uint64_t count = 0;
+        InsnClass cls = InsnClass::Other;
+    };
+
+    explicit PcHistogram(std::size_t capacity = 1024);
+
+    // A new entry has a zero count, pc 0 is reserved for empty slots
+    Entry &find_or_insert(virt_addr pc, bool &inserted);
+    const Entry *find(virt_addr pc) const;
+
+    std::size_t size() const { return size_; }
+
+    // Entries by descending count
+    std::vector<Entry> sorted() const;
+
+private:
+    std::size_t slot_of(virt_addr pc) const;
+    void grow();
+
+    std::vector<Entry> slots_;
+    std::size_t size_ = 0;
+};
+
+// Sample count per callchain, innermost frame first
+using StackCounts = std::map<std::vector<virt_addr>, std::uint64_t>;
+
+// Exact instruction counts for a single stepped region
+class StepProfiler
+{
+public:
+    explicit StepProfiler(Process &proc) : process_(&proc) {}
+
+    // Steps like Process::step_instructions and counts every pc executed
+    StepResult run(const StepLimits &limits);
+
+    const PcHistogram &histogram() const { return histogram_; }
+    std::uint64_t class_count(InsnClass cls) const
+    {
+        return mix_[static_cast<std::size_t>(cls)];
+    }
+    std::uint64_t total() const { return total_; }
+
+private:
+    Process *process_;
+    PcHistogram histogram_;
+    std::array<std::uint64_t, static_cast<std::size_t>(InsnClass::Count)> mix_{};
+    std::uint64_t total_ = 0;
+};
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_SYSCALL_TRACER_HPP
+#define BKPT_LIB_SYSCALL_TRACER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+#include <linux/filter.h>
+
+#include "types.hpp"
+
+class Process;
+struct ThreadState;
+
+// One traced system call, ret is missing while the thread is inside it
+// or when its return was not seen
+struct SyscallRecord
+{
+    pid_t tid = 0;
+    int number = 0;
+    std::array<std::uint64_t, 6> args{};
+    std::optional<std::int64_t> ret;
+
+    std::chrono::steady_clock::time_point entered;
+    std::chrono::steady_clock::time_point left;
+};
+
+// Log2 histogram of latencies in nanoseconds, bucket i counts calls
+// that took [2^i, 2^(i+1)), the last one everything longer
+struct LatencyHistogram
+{
+    static constexpr std::size_t BUCKETS = 40;
+
+    std::array<std::uint64_t, BUCKETS> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns = 0;
+
+    void add(std::uint64_t ns);
+
+    // Upper bound of the bucket holding the given fraction of calls
+    std::uint64_t percentile(double fraction) const;
+};
+
+// One kind of call on one file descriptor
+struct FdStats
+{
+    LatencyHistogram latency;
+    std::uint64_t bytes = 0;
+    std::uint64_t errors = 0;
+};
+
+// Latency of every finished call by number, plus per descriptor totals
+// for the calls that move data, read, write, send and recv with their
+// vector and positional forms. A latency runs from the seccomp stop to
+// the exit stop, one round trip through the tracer included
+class SyscallProfile
+{
+public:
+    void add(const SyscallRecord &record);
+    void clear();
+
+    static bool moves_data(int number);
+
+    const std::map<int, LatencyHistogram> &by_number() const { return by_number_; }
+
+    // Keyed by descriptor then call number
+    const std::map<std::pair<int, int>, FdStats> &by_fd() const { return by_fd_; }
+
+private:
+    std::map<int, LatencyHistogram> by_number_;
+    std::map<std::pair<int, int>, FdStats> by_fd_;
+};
+
+// System calls picked out in the kernel. A seccomp filter installed at
+// launch returns SECCOMP_RET_TRACE for the selected calls only, the rest
+// never stop the tracee. A traced call is read at its seccomp stop with
+// PTRACE_GET_SYSCALL_INFO, and the thread goes on with PTRACE_SYSCALL
+// just long enough to see it return
+//
+// Records go into a bounded buffer, the oldest are dropped once it is
+// full. The profile sees every finished call whether dropped or not
+class SyscallTracer
+{
+public:
+    SyscallTracer() = delete;
+    SyscallTracer(const SyscallTracer &) = delete;
+    SyscallTracer &operator=(const SyscallTracer &) = delete;
+
+    // Names of the generic table AArch64 uses
+    static std::optional<int> number(std::string_view name);
+    static std::string_view name(int number);
+
+    // Arguments the call takes, all six for an unknown one
+    static int arg_count(int number);
+
+    // Comma separated names to numbers, throws Error on an unknown one
+    static std::vector<int> parse(std::string_view names);
+
+    // Of the given calls those a filter can trace. Exec is left out, a
+    // traced execve would fail before the options that let the tracer see
+    // it are in place
+    static std::vector<int> traceable(const std::vector<int> &numbers);
+
+    // BPF program tracing the traceable calls and allowing everything else
+    static std::vector<sock_filter> filter(const std::vector<int> &numbers);
+
+    // Calls the filter of the process traces, empty when it has none
+    const std::vector<int> &filtered() const { return filtered_; }
+
+    // Starts recording the selected calls, all filtered ones when empty.
+    // Throws Error if the process was launched without a filter or a
+    // selected call is not in it
+    void enable(std::vector<int> select = {});
+    void disable() { enabled_ = false; }
+    bool enabled() const { return enabled_; }
+
+    // Finished calls, oldest first
+    const std::deque<SyscallRecord> &records() const { return records_; }
+    std::vector<SyscallRecord> take();
+    std::size_t dropped() const { return dropped_; }
+
+    const SyscallProfile &profile() const { return profile_; }
+    void clear_profile() { profile_.clear(); }
+
+private:
+    friend Process;
+    explicit SyscallTracer(Process &proc) : process_(&proc) {}
+
+    // Seccomp stop on entry and PTRACE_SYSCALL stop on exit of a thread
+    void enter(ThreadState &thread);
+    void leave(ThreadState &thread);
+
+    // A followed fork child carries the filter of its parent
+    void inherit(const SyscallTracer &parent);
+
+    void push(SyscallRecord record);
+    bool selected(int number) const;
+
+    static constexpr std::size_t CAPACITY = 65536;
+
+    Process *process_;
+    std::vector<int> filtered_;
+    std::vector<int> selected_;
+    bool enabled_ = false;
+
+    // Calls threads are inside of, by thread
+    std::map<pid_t, SyscallRecord> open_;
+
+    std::deque<SyscallRecord> records_;
+    std::size_t dropped_ = 0;
+    SyscallProfile profile_;
+};
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_TRACER_HPP
+#define BKPT_LIB_TRACER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "session.hpp"
+
+class Tracer;
+
+enum class TraceEventKind : uint8_t
+{
+    Stop = 0,   // Stop or end of a process, info as returned by wait()
+    Follow,     // A forked child joined the session of the tracer
+    Signal,     // A signal was passed on without a stop, info is its number
+    Error,      // Collecting events failed, error says why
+};
+
+struct TraceEvent
+{
+    TraceEventKind kind = TraceEventKind::Stop;
+    Tracer *tracer = nullptr;
+    pid_t pid = 0;
+    std::uint8_t info = 0;
+    std::string error;
+
+    // Thread the event concerns, when it is not the process as a whole
+    pid_t tid = 0;
+};
+
+// Events from every tracer thread, consumed by the thread running the UI
+class EventQueue
+{
+public:
+    EventQueue();
+    ~EventQueue();
+
+    EventQueue(const EventQueue &) = delete;
+    EventQueue &operator=(const EventQueue &) = delete;
+
+    void push(TraceEvent event);
+    std::optional<TraceEvent> pop();
+
+    // Readable once events are queued, read it before popping them all
+    int fd() const { return fd_; }
+    void clear_fd();
+
+private:
+    int fd_ = -1;
+    std::mutex mutex_;
+    std::deque<TraceEvent> events_;
+};
+
+// ptrace requests are only accepted from the thread that attached, so a
+// tracer thread owns a Session and everything touching it runs there
+class Tracer
+{
+public:
+    explicit Tracer(EventQueue &queue);
+    ~Tracer();
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    // Queues f(session) on the tracer thread, the future carries its
+    // result or the exception it threw
+    template <typename F>
+    auto post(F f) -> std::future<std::invoke_result_t<F, Session &>>
+    {
+        using Result = std::invoke_result_t<F, Session &>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            [this, f = std::move(f)]() mutable { return f(*session_); });
+        auto result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    template <typename F>
+    auto run(F f) { return post(std::move(f)).get(); }
+
+    // Moves whatever the processes reported meanwhile into the queue
+    void poll();
+
+private:
+    void enqueue(std::function<void()> task);
+    void loop();
+
+    EventQueue &queue_;
+    std::unique_ptr<Session> session_;
+    std::atomic<bool> poll_queued_{false};
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> tasks_;
+    bool quit_ = false;
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_UNWINDER_HPP
+#define BKPT_LIB_UNWINDER_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <sys/types.h>
+
+#include "types.hpp"
+#include "call_frame_info.hpp"
+
+class Process;
+struct FrameRegisters;
+
+struct StackFrame
+{
+    virt_addr pc = 0;
+
+    // Frame record of the function, the saved x29/x30 pair, 0 if unknown
+    virt_addr frame = 0;
+};
+
+// Unwinds with the .eh_frame CFI of the code a frame is in, falling back
+// to the AArch64 frame record chain that x29 heads where there is none.
+// Stack is read a window at a time and must lie inside the mapping
+// holding sp. The frames of the previous unwind of a thread are reused
+// when the top function has stored its own frame record and that record
+// is unchanged, so only the top frame is walked again
+class Unwinder
+{
+public:
+    Unwinder() = delete;
+    Unwinder(const Unwinder &) = delete;
+    Unwinder &operator=(const Unwinder &) = delete;
+
+    // Innermost frame first, the thread must be stopped
+    std::vector<StackFrame> unwind();
+    std::vector<StackFrame> unwind(pid_t tid);
+
+    // The last unwind reused the frames of the one before
+    bool last_reused() const { return last_reused_; }
+
+    void set_max_depth(std::size_t depth) { max_depth_ = depth; }
+
+private:
+    friend Process;
+    explicit Unwinder(Process &proc) : process_(&proc), cfi_(proc) {}
+
+    // Drops cached stacks and CFI, used when the address space is replaced
+    void forget()
+    {
+        cache_.clear();
+        cfi_.forget();
+    }
+
+    struct StackRange
+    {
+        virt_addr low = 0;
+        virt_addr high = 0;
+    };
+
+    struct ThreadCache
+    {
+        StackRange stack;
+        std::vector<StackFrame> frames;
+    };
+
+    bool find_stack(pid_t tid, virt_addr sp, StackRange &range) const;
+    bool reuse_frames(ThreadCache &cache, virt_addr pc, virt_addr fp,
+        virt_addr sp, std::vector<StackFrame> &frames);
+    void walk(const StackRange &stack, const FrameRegisters &regs,
+        std::vector<StackFrame> &frames);
+
+    Process *process_;
+    CallFrameInfo cfi_;
+    std::size_t max_depth_ = 128;
+    std::map<pid_t, ThreadCache> cache_;
+    bool last_reused_ = false;
+};
+
+#endif
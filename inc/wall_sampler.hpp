@@ -0,0 +1,83 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_WALL_SAMPLER_HPP
+#define BKPT_LIB_WALL_SAMPLER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "types.hpp"
+#include "step_profiler.hpp"
+
+class Process;
+
+// Halts every thread at a fixed rate and walks its frame records, so
+// threads blocked in the kernel or on a lock are sampled next to the
+// ones on a CPU. Frames are read a level at a time for all threads at
+// once, a leaf function without a frame record hides its caller
+class WallClockSampler
+{
+public:
+    explicit WallClockSampler(Process &proc, std::uint64_t frequency = 100,
+        std::size_t max_depth = 64);
+
+    // Samples until the time is up or a thread stops on its own
+    void run_for(std::chrono::milliseconds duration);
+
+    const StackCounts &stacks() const { return stacks_; }
+
+    // Thread stacks recorded and times the process was halted for them
+    std::uint64_t samples() const { return samples_; }
+    std::uint64_t rounds() const { return rounds_; }
+
+    // Mean time the threads stayed halted per round
+    std::chrono::nanoseconds round_cost() const;
+
+    // A thread stopped for a reason of its own, wait() reports it
+    bool interrupted() const { return interrupted_; }
+
+private:
+    struct Walk
+    {
+        std::vector<virt_addr> chain;
+        virt_addr fp = 0;
+    };
+
+    void sample_round();
+    void walk_frames(pid_t tid, std::vector<Walk> &walks) const;
+
+    Process *process_;
+    std::chrono::nanoseconds interval_;
+    std::size_t max_depth_;
+
+    StackCounts stacks_;
+    std::uint64_t samples_ = 0;
+    std::uint64_t rounds_ = 0;
+    std::chrono::nanoseconds halted_{0};
+    bool interrupted_ = false;
+};
+
+#endif
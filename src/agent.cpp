@@ -0,0 +1,357 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "agent.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <cstdio>
+#include <thread>
+#include <fstream>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+#ifndef SYS_pidfd_getfd
+#define SYS_pidfd_getfd 438
+#endif
+
+namespace
+{
+    struct MapEntry
+    {
+        virt_addr start;
+        virt_addr end;
+        std::uint64_t offset;
+        std::string path;
+    };
+
+    std::vector<MapEntry> read_maps(const std::string &maps_path)
+    {
+        std::vector<MapEntry> entries;
+        std::ifstream maps(maps_path);
+        std::string line;
+
+        while (std::getline(maps, line))
+        {
+            MapEntry entry;
+            int path_pos = 0;
+            unsigned long start = 0, end = 0, offset = 0;
+            if (std::sscanf(line.c_str(), "%lx-%lx %*s %lx %*s %*s %n",
+                &start, &end, &offset, &path_pos) < 3)
+                continue;
+
+            entry.start = start;
+            entry.end = end;
+            entry.offset = offset;
+            if (path_pos > 0 && static_cast<std::size_t>(path_pos) < line.size())
+                entry.path = line.substr(path_pos);
+            entries.push_back(std::move(entry));
+        }
+        return entries;
+    }
+
+    // Base address the file at path is mapped at, 0 if not mapped
+    virt_addr module_base(const std::vector<MapEntry> &maps, const std::string &path)
+    {
+        for (auto &entry : maps)
+        {
+            if (entry.path == path && entry.offset == 0)
+                return entry.start;
+        }
+        return 0;
+    }
+
+    // Translates an address of our own copy of a shared library into the
+    // tracee, valid as long as both processes map the very same file
+    virt_addr remote_address_of(pid_t pid, const void *local)
+    {
+        auto self = read_maps("/proc/self/maps");
+        auto addr = reinterpret_cast<virt_addr>(local);
+
+        for (auto &entry : self)
+        {
+            if (addr < entry.start || addr >= entry.end)
+                continue;
+
+            if (entry.path.empty() || entry.path[0] != '/')
+                break;
+
+            auto remote = read_maps("/proc/" + std::to_string(pid) + "/maps");
+            virt_addr local_base = module_base(self, entry.path);
+            virt_addr remote_base = module_base(remote, entry.path);
+            if (local_base == 0 || remote_base == 0)
+                break;
+
+            return remote_base + (addr - local_base);
+        }
+
+        Error::send("Could not locate matching library inside the tracee");
+    }
+}
+
+std::unique_ptr<Agent> Agent::create(Process &proc)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), BKPT_AGENT_NAME_FMT, proc.get_pid());
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        Error::send_errno("Failed to create agent channel");
+    }
+
+    if (ftruncate(fd, sizeof(bkpt_agent_channel)) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        Error::send_errno("Failed to size agent channel");
+    }
+
+    void *mem = mmap(nullptr, sizeof(bkpt_agent_channel),
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mem == MAP_FAILED)
+    {
+        shm_unlink(name);
+        Error::send_errno("Failed to map agent channel");
+    }
+
+    auto channel = static_cast<bkpt_agent_channel *>(mem);
+    channel->magic = BKPT_AGENT_MAGIC;
+    channel->version = BKPT_AGENT_VERSION;
+    channel->data_size = BKPT_AGENT_DATA_SIZE;
+    channel->doorbell_fd = -1;
+
+    return std::unique_ptr<Agent>(new Agent(proc, name, channel));
+}
+
+Agent::~Agent()
+{
+    if (doorbell_fd_ >= 0)
+        close(doorbell_fd_);
+
+    munmap(channel_, sizeof(bkpt_agent_channel));
+    shm_unlink(name_.c_str());
+}
+
+std::string Agent::default_library_path()
+{
+    char buf[4096];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (len < 0)
+    {
+        Error::send_errno("Failed to resolve debugger executable");
+    }
+
+    std::string path(buf, len);
+    return path.substr(0, path.find_last_of('/') + 1) + "libbkpt_agent.so";
+}
+
+void Agent::load(std::string_view library)
+{
+    if (process_->get_state() != ProcessState::Stopped)
+        Error::send("Agent can only be loaded into a stopped process");
+
+    void *local_dlopen = dlsym(RTLD_DEFAULT, "dlopen");
+    if (local_dlopen == nullptr)
+        Error::send("Could not resolve dlopen in the debugger");
+
+    virt_addr remote_dlopen = remote_address_of(process_->get_pid(), local_dlopen);
+
+    std::string path(library);
+    virt_addr path_addr = process_->scratch().allocate(path.size() + 1);
+    process_->write_memory(path_addr,
+        {reinterpret_cast<const std::uint8_t *>(path.c_str()), path.size() + 1});
+
+    std::uint64_t flags = RTLD_NOW;
+    CallResult res = process_->call_function(remote_dlopen, {path_addr, flags});
+    if (res.x0 == 0)
+        Error::send("dlopen() of agent failed inside the tracee");
+}
+
+bool Agent::ready()
+{
+    if (doorbell_fd_ >= 0)
+        return true;
+
+    if (__atomic_load_n(&channel_->ready, __ATOMIC_ACQUIRE) == 0)
+        return false;
+
+    // The agent owns the eventfd, duplicate it out of the tracee
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, process_->get_pid(), 0));
+    if (pidfd < 0)
+    {
+        Error::send_errno("pidfd_open() failed");
+    }
+
+    doorbell_fd_ = static_cast<int>(syscall(SYS_pidfd_getfd, pidfd, channel_->doorbell_fd, 0));
+    int err = errno;
+    close(pidfd);
+
+    if (doorbell_fd_ < 0)
+    {
+        errno = err;
+        Error::send_errno("pidfd_getfd() failed for agent doorbell");
+    }
+    return true;
+}
+
+bool Agent::wait_ready(std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (ready() == false)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+std::int64_t Agent::request(std::uint32_t op, virt_addr address, std::uint64_t len)
+{
+    if (ready() == false)
+        Error::send("Agent is not running inside the tracee");
+
+    channel_->op = op;
+    channel_->addr = address;
+    channel_->len = len;
+
+    std::uint64_t seq = ++seq_;
+    __atomic_store_n(&channel_->req_seq, seq, __ATOMIC_RELEASE);
+
+    std::uint64_t tick = 1;
+    if (write(doorbell_fd_, &tick, sizeof(tick)) < 0)
+    {
+        Error::send_errno("Failed to ring agent doorbell");
+    }
+
+    // Responses normally land within a few microseconds, spin on the
+    // response cache line first and only then start yielding the CPU
+    auto deadline = std::chrono::steady_clock::now() + timeout_;
+    std::size_t spins = 0;
+    while (__atomic_load_n(&channel_->resp_seq, __ATOMIC_ACQUIRE) != seq)
+    {
+        if (++spins < 4096)
+            continue;
+
+        if (std::chrono::steady_clock::now() >= deadline)
+            Error::send("Agent did not respond, is the tracee stopped?");
+
+        sched_yield();
+    }
+
+    return channel_->status;
+}
+
+void Agent::ping()
+{
+    std::int64_t status = request(BKPT_AGENT_OP_PING, 0, 0);
+    if (status < 0)
+    {
+        errno = static_cast<int>(-status);
+        Error::send_errno("Agent ping failed");
+    }
+}
+
+std::vector<std::uint8_t>
+Agent::read_memory(virt_addr address, std::size_t size)
+{
+    std::vector<std::uint8_t> res(size);
+    std::size_t done = 0;
+
+    while (done < size)
+    {
+        std::size_t chunk = std::min<std::size_t>(size - done, channel_->data_size);
+        std::int64_t status = request(BKPT_AGENT_OP_READ, address + done, chunk);
+        if (status < 0)
+        {
+            errno = static_cast<int>(-status);
+            Error::send_errno("Agent memory read failed");
+        }
+
+        if (status == 0)
+            Error::send("Agent memory read made no progress");
+
+        std::memcpy(res.data() + done, channel_->data, status);
+        done += status;
+    }
+
+    return res;
+}
+
+std::uint64_t Agent::counter(std::size_t index) const
+{
+    if (index >= BKPT_AGENT_COUNTERS)
+        Error::send("Agent counter index out of range");
+
+    return __atomic_load_n(&channel_->counters[index], __ATOMIC_RELAXED);
+}
+
+std::vector<bkpt_agent_record> Agent::drain_trace()
+{
+    std::vector<bkpt_agent_record> records;
+    std::uint64_t head = __atomic_load_n(&channel_->trace_head, __ATOMIC_ACQUIRE);
+
+    // Producers lapped us, everything older than one ring is gone
+    if (head - trace_tail_ > BKPT_AGENT_TRACE_SLOTS)
+    {
+        dropped_ += head - trace_tail_ - BKPT_AGENT_TRACE_SLOTS;
+        trace_tail_ = head - BKPT_AGENT_TRACE_SLOTS;
+    }
+
+    records.reserve(head - trace_tail_);
+    for (; trace_tail_ < head; trace_tail_++)
+    {
+        auto &slot = channel_->trace[trace_tail_ % BKPT_AGENT_TRACE_SLOTS];
+        std::uint64_t seq = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+
+        // Claimed but not yet published, pick it up on the next drain
+        if (seq < trace_tail_ + 1)
+            break;
+
+        bkpt_agent_record rec = slot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq != trace_tail_ + 1 ||
+            __atomic_load_n(&slot.seq, __ATOMIC_RELAXED) != seq)
+        {
+            dropped_++;
+            continue;
+        }
+
+        records.push_back(rec);
+    }
+
+    return records;
+}
@@ -0,0 +1,50 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "auxv.hpp"
+#include "error.hpp"
+
+#include <fstream>
+#include <string>
+
+AuxVector::AuxVector(pid_t pid)
+{
+    std::ifstream file("/proc/" + std::to_string(pid) + "/auxv", std::ios::binary);
+    if (!file)
+        Error::send("Could not open the auxiliary vector of " + std::to_string(pid));
+
+    std::uint64_t entry[2];
+    while (file.read(reinterpret_cast<char *>(entry), sizeof(entry)) && entry[0] != AT_NULL)
+        entries_.emplace_back(entry[0], entry[1]);
+}
+
+std::optional<std::uint64_t> AuxVector::get(std::uint64_t type) const
+{
+    for (const auto &[key, value] : entries_)
+    {
+        if (key == type)
+            return value;
+    }
+    return std::nullopt;
+}
@@ -26,13 +26,15 @@
 #include "process.hpp"
 #include "error.hpp"
 
+#include <atomic>
 #include <sys/ptrace.h>
 
 namespace 
 {
+    // Tracer threads create breakpoints concurrently
     BreakpointSite::id_type get_next_id()
     {
-        static BreakpointSite::id_type id = 0;
+        static std::atomic<BreakpointSite::id_type> id{0};
         return ++id;
     }
 }
@@ -62,7 +64,7 @@ void BreakpointSite::enable()
     }
 
     errno = 0;
-    std::uint64_t data = ptrace(PTRACE_PEEKDATA, process_->get_pid(), address_, nullptr);
+    std::uint64_t data = ptrace(PTRACE_PEEKDATA, process_->current_thread(), address_, nullptr);
     if (errno != 0)
     {
         Error::send_errno("Failed to enable breakpoint site");
@@ -83,7 +85,7 @@ void BreakpointSite::enable()
     // }
     #endif
 
-    if (ptrace(PTRACE_POKEDATA, process_->get_pid(), address_, data) < 0)
+    if (ptrace(PTRACE_POKEDATA, process_->current_thread(), address_, data) < 0)
     {
         Error::send_errno("Failed to enable breakpoint site");
     }
@@ -105,14 +107,14 @@ void BreakpointSite::disable()
     }
 
     errno = 0;
-    std::uint64_t data = ptrace(PTRACE_PEEKDATA, process_->get_pid(), address_, nullptr);
+    std::uint64_t data = ptrace(PTRACE_PEEKDATA, process_->current_thread(), address_, nullptr);
     if (errno != 0)
     {
         Error::send_errno("Failed to disable breakpoint site");
     }
     
     data = saved_data_;
-    if (ptrace(PTRACE_POKEDATA, process_->get_pid(), address_, data) < 0)
+    if (ptrace(PTRACE_POKEDATA, process_->current_thread(), address_, data) < 0)
     {
         Error::send_errno("Failed to disable breakpoint site");
     }
@@ -0,0 +1,718 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "call_frame_info.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <elf.h>
+
+namespace
+{
+    // Pointer encodings of .eh_frame, DW_EH_PE_*
+    constexpr std::uint8_t PE_OMIT = 0xff;
+    constexpr std::uint8_t PE_ABSPTR = 0x00;
+    constexpr std::uint8_t PE_ULEB128 = 0x01;
+    constexpr std::uint8_t PE_UDATA2 = 0x02;
+    constexpr std::uint8_t PE_UDATA4 = 0x03;
+    constexpr std::uint8_t PE_UDATA8 = 0x04;
+    constexpr std::uint8_t PE_SLEB128 = 0x09;
+    constexpr std::uint8_t PE_SDATA2 = 0x0a;
+    constexpr std::uint8_t PE_SDATA4 = 0x0b;
+    constexpr std::uint8_t PE_SDATA8 = 0x0c;
+    constexpr std::uint8_t PE_PCREL = 0x10;
+    constexpr std::uint8_t PE_DATAREL = 0x30;
+    constexpr std::uint8_t PE_INDIRECT = 0x80;
+
+    // Call frame instructions, DW_CFA_*
+    enum : std::uint8_t
+    {
+        CFA_nop = 0x00,
+        CFA_set_loc = 0x01,
+        CFA_advance_loc1 = 0x02,
+        CFA_advance_loc2 = 0x03,
+        CFA_advance_loc4 = 0x04,
+        CFA_offset_extended = 0x05,
+        CFA_restore_extended = 0x06,
+        CFA_undefined = 0x07,
+        CFA_same_value = 0x08,
+        CFA_register = 0x09,
+        CFA_remember_state = 0x0a,
+        CFA_restore_state = 0x0b,
+        CFA_def_cfa = 0x0c,
+        CFA_def_cfa_register = 0x0d,
+        CFA_def_cfa_offset = 0x0e,
+        CFA_def_cfa_expression = 0x0f,
+        CFA_expression = 0x10,
+        CFA_offset_extended_sf = 0x11,
+        CFA_def_cfa_sf = 0x12,
+        CFA_def_cfa_offset_sf = 0x13,
+        CFA_val_offset = 0x14,
+        CFA_val_offset_sf = 0x15,
+        CFA_val_expression = 0x16,
+        CFA_AARCH64_negate_ra_state = 0x2d,
+        CFA_GNU_args_size = 0x2e,
+        CFA_GNU_negative_offset_extended = 0x2f,
+        CFA_advance_loc = 0x40,
+        CFA_offset = 0x80,
+        CFA_restore = 0xc0,
+    };
+
+    // Bounds checked reader over bytes copied out of the tracee
+    class Cursor
+    {
+    public:
+        Cursor(const std::uint8_t *data, std::size_t size, virt_addr base)
+            : data_(data), size_(size), base_(base) {}
+
+        bool done() const { return pos_ >= size_; }
+        virt_addr address() const { return base_ + pos_; }
+        std::size_t pos() const { return pos_; }
+
+        void seek(std::size_t pos)
+        {
+            if (pos > size_)
+                Error::send("Call frame information is truncated");
+            pos_ = pos;
+        }
+
+        template <typename T>
+        T read()
+        {
+            if (size_ - pos_ < sizeof(T) || pos_ > size_)
+                Error::send("Call frame information is truncated");
+            T val;
+            std::memcpy(&val, data_ + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return val;
+        }
+
+        std::uint64_t uleb()
+        {
+            std::uint64_t val = 0;
+            unsigned shift = 0;
+            std::uint8_t byte;
+            do
+            {
+                byte = read<std::uint8_t>();
+                if (shift < 64)
+                    val |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            return val;
+        }
+
+        std::int64_t sleb()
+        {
+            std::int64_t val = 0;
+            unsigned shift = 0;
+            std::uint8_t byte;
+            do
+            {
+                byte = read<std::uint8_t>();
+                if (shift < 64)
+                    val |= static_cast<std::int64_t>(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+
+            if (shift < 64 && (byte & 0x40))
+                val |= -(static_cast<std::int64_t>(1) << shift);
+            return val;
+        }
+
+        // Relative encodings are resolved against the tracee address
+        // of the field itself or of the .eh_frame_hdr section
+        virt_addr encoded(std::uint8_t enc, virt_addr datarel = 0)
+        {
+            if (enc == PE_OMIT)
+                return 0;
+            if (enc & PE_INDIRECT)
+                Error::send("Indirect pointer encoding is not supported");
+
+            virt_addr field = address();
+            std::uint64_t val = 0;
+            switch (enc & 0x0f)
+            {
+                case PE_ABSPTR:
+                case PE_UDATA8:
+                case PE_SDATA8:  val = read<std::uint64_t>(); break;
+                case PE_ULEB128: val = uleb(); break;
+                case PE_UDATA2:  val = read<std::uint16_t>(); break;
+                case PE_UDATA4:  val = read<std::uint32_t>(); break;
+                case PE_SLEB128: val = static_cast<std::uint64_t>(sleb()); break;
+                case PE_SDATA2:
+                    val = static_cast<std::uint64_t>(static_cast<std::int64_t>(read<std::int16_t>()));
+                    break;
+                case PE_SDATA4:
+                    val = static_cast<std::uint64_t>(static_cast<std::int64_t>(read<std::int32_t>()));
+                    break;
+                default:
+                    Error::send("Unknown pointer encoding");
+            }
+
+            switch (enc & 0x70)
+            {
+                case 0:           break;
+                case PE_PCREL:    val += field; break;
+                case PE_DATAREL:  val += datarel; break;
+                default:
+                    Error::send("Unsupported pointer encoding");
+            }
+            return val;
+        }
+
+    private:
+        const std::uint8_t *data_;
+        std::size_t size_;
+        virt_addr base_;
+        std::size_t pos_ = 0;
+    };
+
+    struct RowState
+    {
+        std::uint8_t cfa_reg = 31;
+        std::int64_t cfa_offset = 0;
+        std::array<RegisterRule, 32> regs{};
+
+        // Cleared by rules this unwinder cannot evaluate
+        bool usable = true;
+    };
+
+    void set_rule(RowState &st, std::uint64_t reg, RegisterRule::Kind kind,
+        std::int64_t value = 0)
+    {
+        if (reg < st.regs.size())
+            st.regs[reg] = {kind, value};
+    }
+
+    // Runs call frame instructions from loc on, stopping at the first
+    // advance past target, row_start and row_end bound the row reached
+    void execute(Cursor &c, std::uint64_t code_align, std::int64_t data_align,
+        std::uint8_t fde_encoding, const RowState &initial, RowState &st,
+        virt_addr loc, virt_addr target, virt_addr &row_start, virt_addr &row_end)
+    {
+        std::vector<RowState> saved;
+        row_start = loc;
+
+        auto advance = [&](virt_addr next)
+        {
+            if (next > target)
+            {
+                row_end = std::min(row_end, next);
+                return false;
+            }
+            loc = next;
+            row_start = loc;
+            return true;
+        };
+
+        while (c.done() == false)
+        {
+            std::uint8_t op = c.read<std::uint8_t>();
+            std::uint8_t high = op & 0xc0;
+            std::uint8_t low = op & 0x3f;
+
+            if (high == CFA_advance_loc)
+            {
+                if (advance(loc + low * code_align) == false)
+                    return;
+                continue;
+            }
+            if (high == CFA_offset)
+            {
+                set_rule(st, low, RegisterRule::Offset,
+                    static_cast<std::int64_t>(c.uleb()) * data_align);
+                continue;
+            }
+            if (high == CFA_restore)
+            {
+                if (low < st.regs.size())
+                    st.regs[low] = initial.regs[low];
+                continue;
+            }
+
+            switch (op)
+            {
+                case CFA_nop:
+                    break;
+                case CFA_set_loc:
+                    if (advance(c.encoded(fde_encoding)) == false)
+                        return;
+                    break;
+                case CFA_advance_loc1:
+                    if (advance(loc + c.read<std::uint8_t>() * code_align) == false)
+                        return;
+                    break;
+                case CFA_advance_loc2:
+                    if (advance(loc + c.read<std::uint16_t>() * code_align) == false)
+                        return;
+                    break;
+                case CFA_advance_loc4:
+                    if (advance(loc + c.read<std::uint32_t>() * code_align) == false)
+                        return;
+                    break;
+                case CFA_offset_extended:
+                {
+                    std::uint64_t reg = c.uleb();
+                    set_rule(st, reg, RegisterRule::Offset,
+                        static_cast<std::int64_t>(c.uleb()) * data_align);
+                    break;
+                }
+                case CFA_offset_extended_sf:
+                {
+                    std::uint64_t reg = c.uleb();
+                    set_rule(st, reg, RegisterRule::Offset, c.sleb() * data_align);
+                    break;
+                }
+                case CFA_GNU_negative_offset_extended:
+                {
+                    std::uint64_t reg = c.uleb();
+                    set_rule(st, reg, RegisterRule::Offset,
+                        -static_cast<std::int64_t>(c.uleb()) * data_align);
+                    break;
+                }
+                case CFA_val_offset:
+                {
+                    std::uint64_t reg = c.uleb();
+                    set_rule(st, reg, RegisterRule::ValOffset,
+                        static_cast<std::int64_t>(c.uleb()) * data_align);
+                    break;
+                }
+                case CFA_val_offset_sf:
+                {
+                    std::uint64_t reg = c.uleb();
+                    set_rule(st, reg, RegisterRule::ValOffset, c.sleb() * data_align);
+                    break;
+                }
+                case CFA_restore_extended:
+                {
+                    std::uint64_t reg = c.uleb();
+                    if (reg < st.regs.size())
+                        st.regs[reg] = initial.regs[reg];
+                    break;
+                }
+                case CFA_undefined:
+                    set_rule(st, c.uleb(), RegisterRule::Undefined);
+                    break;
+                case CFA_same_value:
+                    set_rule(st, c.uleb(), RegisterRule::Same);
+                    break;
+                case CFA_register:
+                {
+                    std::uint64_t reg = c.uleb();
+                    std::uint64_t src = c.uleb();
+                    if (src >= st.regs.size())
+                        set_rule(st, reg, RegisterRule::Undefined);
+                    else
+                        set_rule(st, reg, RegisterRule::Register, static_cast<std::int64_t>(src));
+                    break;
+                }
+                case CFA_remember_state:
+                    saved.push_back(st);
+                    break;
+                case CFA_restore_state:
+                    // The CFA comes back too, early return epilogues of
+                    // GCC rely on it after their def_cfa_offset 0
+                    if (saved.empty() == false)
+                    {
+                        st = saved.back();
+                        saved.pop_back();
+                    }
+                    break;
+                case CFA_def_cfa:
+                    st.cfa_reg = static_cast<std::uint8_t>(c.uleb());
+                    st.cfa_offset = static_cast<std::int64_t>(c.uleb());
+                    break;
+                case CFA_def_cfa_sf:
+                    st.cfa_reg = static_cast<std::uint8_t>(c.uleb());
+                    st.cfa_offset = c.sleb() * data_align;
+                    break;
+                case CFA_def_cfa_register:
+                    st.cfa_reg = static_cast<std::uint8_t>(c.uleb());
+                    break;
+                case CFA_def_cfa_offset:
+                    st.cfa_offset = static_cast<std::int64_t>(c.uleb());
+                    break;
+                case CFA_def_cfa_offset_sf:
+                    st.cfa_offset = c.sleb() * data_align;
+                    break;
+                case CFA_def_cfa_expression:
+                    st.usable = false;
+                    c.seek(c.pos() + c.uleb());
+                    break;
+                case CFA_expression:
+                case CFA_val_expression:
+                {
+                    std::uint64_t reg = c.uleb();
+                    if (reg < st.regs.size())
+                        st.usable = false;
+                    c.seek(c.pos() + c.uleb());
+                    break;
+                }
+                case CFA_AARCH64_negate_ra_state:
+                    // Signed return addresses are masked when they are used
+                    break;
+                case CFA_GNU_args_size:
+                    c.uleb();
+                    break;
+                default:
+                    Error::send("Unknown call frame instruction");
+            }
+        }
+    }
+}
+
+void CallFrameInfo::forget()
+{
+    modules_.clear();
+    cies_.clear();
+    rows_.clear();
+    rescan_ = true;
+}
+
+const CfiRow *CallFrameInfo::find_row(virt_addr pc)
+{
+    auto it = rows_.upper_bound(pc);
+    if (it != rows_.begin())
+    {
+        --it;
+        if (pc < it->second.end)
+            return &it->second;
+    }
+
+    Module *mod = find_module(pc);
+    if (mod == nullptr || load_table(*mod) == false || mod->table.empty())
+        return nullptr;
+
+    // Last FDE starting at or before pc, its range is checked on decode
+    auto entry = std::upper_bound(mod->table.begin(), mod->table.end(), pc,
+        [](virt_addr addr, const auto &pair) { return addr < pair.first; });
+    if (entry == mod->table.begin())
+        return nullptr;
+    --entry;
+
+    CfiRow row;
+    try
+    {
+        if (decode_row(*mod, entry->second, pc, row) == false)
+            return nullptr;
+    }
+    catch (const Error &)
+    {
+        return nullptr;
+    }
+
+    auto [pos, inserted] = rows_.emplace(row.start, row);
+    if (inserted == false)
+        pos->second = row;
+    return &pos->second;
+}
+
+CallFrameInfo::Module *CallFrameInfo::find_module(virt_addr pc)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (Module &mod : modules_)
+        {
+            if (pc >= mod.low && pc < mod.high)
+                return &mod;
+        }
+
+        if (pass == 1 || rescan_ == false)
+            break;
+        rescan_ = false;
+        scan_modules();
+    }
+    return nullptr;
+}
+
+// Every file mapped at offset 0 starts with its ELF header, the program
+// headers that follow locate PT_GNU_EH_FRAME
+void CallFrameInfo::scan_modules()
+{
+    struct Mapping
+    {
+        virt_addr base = 0;
+        virt_addr low = std::numeric_limits<virt_addr>::max();
+        virt_addr high = 0;
+    };
+    std::map<std::string, Mapping> files;
+
+    std::ifstream maps("/proc/" + std::to_string(process_->get_pid()) + "/maps");
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        char path[4096] = {0};
+        unsigned long long low = 0, high = 0, offset = 0;
+        char perms[8] = {0};
+        if (std::sscanf(line.c_str(), "%llx-%llx %7s %llx %*s %*s %4095[^\n]",
+                &low, &high, perms, &offset, path) < 5 || path[0] == '\0')
+            continue;
+
+        Mapping &map = files[path];
+        if (offset == 0 && map.base == 0)
+            map.base = low;
+        map.low = std::min<virt_addr>(map.low, low);
+        map.high = std::max<virt_addr>(map.high, high);
+    }
+
+    std::vector<Module> found;
+    for (const auto &[path, map] : files)
+    {
+        if (map.base == 0)
+            continue;
+
+        // Modules seen before keep their decoded table
+        auto known = std::find_if(modules_.begin(), modules_.end(),
+            [&](const Module &mod) { return mod.low == map.low && mod.high == map.high; });
+        if (known != modules_.end())
+        {
+            found.push_back(std::move(*known));
+            continue;
+        }
+
+        try
+        {
+            auto data = process_->read_memory(map.base, sizeof(Elf64_Ehdr));
+            Elf64_Ehdr ehdr;
+            std::memcpy(&ehdr, data.data(), sizeof(ehdr));
+            if (std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0 ||
+                ehdr.e_ident[EI_CLASS] != ELFCLASS64 ||
+                ehdr.e_phentsize != sizeof(Elf64_Phdr))
+                continue;
+
+            auto raw = process_->read_memory(map.base + ehdr.e_phoff,
+                ehdr.e_phnum * sizeof(Elf64_Phdr));
+            std::vector<Elf64_Phdr> phdrs(ehdr.e_phnum);
+            std::memcpy(phdrs.data(), raw.data(), raw.size());
+
+            const Elf64_Phdr *first_load = nullptr;
+            const Elf64_Phdr *eh_frame = nullptr;
+            for (const auto &phdr : phdrs)
+            {
+                if (phdr.p_type == PT_LOAD && first_load == nullptr)
+                    first_load = &phdr;
+                if (phdr.p_type == PT_GNU_EH_FRAME)
+                    eh_frame = &phdr;
+            }
+            if (first_load == nullptr || eh_frame == nullptr)
+                continue;
+
+            virt_addr bias = map.base - (first_load->p_vaddr - first_load->p_offset);
+            Module mod;
+            mod.low = map.low;
+            mod.high = map.high;
+            mod.eh_frame_hdr = eh_frame->p_vaddr + bias;
+            found.push_back(std::move(mod));
+        }
+        catch (const Error &)
+        {
+            // Not readable as an ELF image, left without CFI
+        }
+    }
+
+    modules_ = std::move(found);
+}
+
+// The binary search table of .eh_frame_hdr, read once per module
+bool CallFrameInfo::load_table(Module &mod)
+{
+    if (mod.table_loaded)
+        return true;
+    mod.table_loaded = true;
+
+    try
+    {
+        constexpr std::size_t HEADER_SIZE = 32;
+        auto head = process_->read_memory(mod.eh_frame_hdr, HEADER_SIZE);
+        Cursor c(head.data(), head.size(), mod.eh_frame_hdr);
+        std::uint8_t version = c.read<std::uint8_t>();
+        std::uint8_t ptr_enc = c.read<std::uint8_t>();
+        std::uint8_t count_enc = c.read<std::uint8_t>();
+        std::uint8_t table_enc = c.read<std::uint8_t>();
+
+        // Only the datarel sdata4 table that linkers emit is searchable
+        if (version != 1 || table_enc != (PE_DATAREL | PE_SDATA4))
+            return false;
+
+        c.encoded(ptr_enc, mod.eh_frame_hdr);
+        std::uint64_t count = c.encoded(count_enc, mod.eh_frame_hdr);
+        if (count == 0 || count > (1u << 24))
+            return false;
+
+        virt_addr table = mod.eh_frame_hdr + c.pos();
+        auto raw = process_->read_memory(table, count * 8);
+        mod.table.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::int32_t loc, fde;
+            std::memcpy(&loc, &raw[i * 8], sizeof(loc));
+            std::memcpy(&fde, &raw[i * 8 + 4], sizeof(fde));
+            mod.table.emplace_back(mod.eh_frame_hdr + loc, mod.eh_frame_hdr + fde);
+        }
+    }
+    catch (const Error &)
+    {
+        mod.table.clear();
+        return false;
+    }
+    return true;
+}
+
+// Contents of a CIE or FDE after its length field
+std::vector<std::uint8_t> CallFrameInfo::read_entry(virt_addr addr, virt_addr &body)
+{
+    auto head = process_->read_memory(addr, 12);
+    std::uint32_t length32;
+    std::memcpy(&length32, head.data(), sizeof(length32));
+
+    std::uint64_t length = length32;
+    body = addr + 4;
+    if (length32 == 0xffffffff)
+    {
+        std::memcpy(&length, head.data() + 4, sizeof(length));
+        body = addr + 12;
+    }
+
+    if (length == 0 || length > (1u << 20))
+        Error::send("Bad call frame entry length");
+    return process_->read_memory(body, length);
+}
+
+const CallFrameInfo::Cie *CallFrameInfo::read_cie(virt_addr addr)
+{
+    auto cached = cies_.find(addr);
+    if (cached != cies_.end())
+        return &cached->second;
+
+    virt_addr body = 0;
+    auto data = read_entry(addr, body);
+    Cursor c(data.data(), data.size(), body);
+    if (c.read<std::uint32_t>() != 0)
+        Error::send("Not a CIE");
+
+    Cie cie;
+    std::uint8_t version = c.read<std::uint8_t>();
+    std::string augmentation;
+    for (char ch = c.read<char>(); ch != '\0'; ch = c.read<char>())
+        augmentation += ch;
+
+    if (augmentation.find("eh") != std::string::npos)
+        c.read<std::uint64_t>();
+
+    cie.code_align = c.uleb();
+    cie.data_align = c.sleb();
+    cie.ra_reg = (version == 1) ? c.read<std::uint8_t>() :
+        static_cast<std::uint8_t>(c.uleb());
+
+    if (augmentation.empty() == false && augmentation[0] == 'z')
+    {
+        cie.augmented = true;
+        std::uint64_t length = c.uleb();
+        std::size_t end = c.pos() + length;
+        for (std::size_t i = 1; i < augmentation.size(); i++)
+        {
+            char ch = augmentation[i];
+            if (ch == 'R')
+                cie.fde_encoding = c.read<std::uint8_t>();
+            else if (ch == 'P')
+                c.encoded(c.read<std::uint8_t>());
+            else if (ch == 'L')
+                c.read<std::uint8_t>();
+            else if (ch != 'S' && ch != 'B')
+                break;
+        }
+        c.seek(end);
+    }
+
+    cie.instructions_addr = c.address();
+    cie.instructions.assign(data.begin() + c.pos(), data.end());
+    return &cies_.emplace(addr, std::move(cie)).first->second;
+}
+
+bool CallFrameInfo::decode_row(const Module &mod, virt_addr fde, virt_addr pc,
+    CfiRow &row)
+{
+    virt_addr body = 0;
+    auto data = read_entry(fde, body);
+    Cursor c(data.data(), data.size(), body);
+
+    // The CIE pointer counts back from its own field
+    virt_addr cie_field = c.address();
+    std::uint32_t cie_offset = c.read<std::uint32_t>();
+    if (cie_offset == 0)
+        return false;
+    const Cie *cie = read_cie(cie_field - cie_offset);
+
+    virt_addr begin = c.encoded(cie->fde_encoding, mod.eh_frame_hdr);
+    virt_addr range = c.encoded(cie->fde_encoding & 0x0f);
+    if (pc < begin || pc >= begin + range)
+        return false;
+
+    if (cie->augmented)
+        c.seek(c.pos() + c.uleb());
+
+    CfiInstructions initial{cie->instructions, cie->instructions_addr};
+    CfiInstructions instructions{{data.data() + c.pos(), data.size() - c.pos()}, c.address()};
+    if (decode_instructions(initial, instructions, cie->code_align, cie->data_align,
+        cie->fde_encoding, begin, begin + range, pc, row) == false)
+        return false;
+
+    row.ra_reg = cie->ra_reg;
+    return true;
+}
+
+bool CallFrameInfo::decode_instructions(const CfiInstructions &cie,
+    const CfiInstructions &fde, std::uint64_t code_align, std::int64_t data_align,
+    std::uint8_t fde_encoding, virt_addr begin, virt_addr end, virt_addr pc, CfiRow &row)
+{
+    // The initial instructions of the CIE hold for the whole function
+    RowState initial;
+    Cursor ci(cie.bytes.begin(), cie.bytes.size(), cie.address);
+    virt_addr row_start = begin, row_end = end;
+    execute(ci, code_align, data_align, fde_encoding,
+        initial, initial, begin, std::numeric_limits<virt_addr>::max(), row_start, row_end);
+
+    RowState st = initial;
+    Cursor c(fde.bytes.begin(), fde.bytes.size(), fde.address);
+    row_start = begin;
+    row_end = end;
+    execute(c, code_align, data_align, fde_encoding,
+        initial, st, begin, pc, row_start, row_end);
+
+    if (st.usable == false || st.cfa_reg >= st.regs.size())
+        return false;
+
+    row.start = row_start;
+    row.end = row_end;
+    row.cfa_reg = st.cfa_reg;
+    row.cfa_offset = st.cfa_offset;
+    row.regs = st.regs;
+    return true;
+}
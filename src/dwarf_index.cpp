@@ -0,0 +1,806 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dwarf_index.hpp"
+#include "dwarf_reader.hpp"
+#include "elf.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <system_error>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+    // DIEs whose name prefixes the names of their children
+    bool is_scope(std::uint64_t tag)
+    {
+        return tag == dwarf::TAG_namespace || tag == dwarf::TAG_class_type ||
+            tag == dwarf::TAG_structure_type || tag == dwarf::TAG_union_type;
+    }
+
+    bool is_type(std::uint64_t tag)
+    {
+        return tag == dwarf::TAG_class_type || tag == dwarf::TAG_structure_type ||
+            tag == dwarf::TAG_union_type || tag == dwarf::TAG_enumeration_type ||
+            tag == dwarf::TAG_typedef || tag == dwarf::TAG_base_type;
+    }
+
+    // Start of the last component of a qualified name, a :: within
+    // template arguments does not split it
+    std::uint32_t base_offset(std::string_view name)
+    {
+        int depth = 0;
+        std::size_t base = 0;
+        for (std::size_t i = 0; i < name.size(); i++)
+        {
+            if (name[i] == '<')
+                depth++;
+            else if (name[i] == '>' && depth > 0)
+                depth--;
+            else if (depth == 0 && name.compare(i, 2, "::") == 0)
+                base = ++i + 1;
+        }
+        return static_cast<std::uint32_t>(base);
+    }
+
+    // A query matches the whole name or its trailing components
+    bool name_matches(std::string_view name, std::string_view query)
+    {
+        if (name.size() == query.size())
+            return name == query;
+        return name.size() >= query.size() + 2 &&
+            name.compare(name.size() - query.size(), query.size(), query) == 0 &&
+            name.compare(name.size() - query.size() - 2, 2, "::") == 0;
+    }
+
+    // Address of a reference attribute within .debug_info, 0 for
+    // references into other files or type units
+    std::uint64_t reference(const AttributeSpec &spec, std::uint64_t value,
+        const UnitHeader &unit)
+    {
+        switch (spec.form)
+        {
+            case dwarf::FORM_ref1:
+            case dwarf::FORM_ref2:
+            case dwarf::FORM_ref4:
+            case dwarf::FORM_ref8:
+            case dwarf::FORM_ref_udata:
+                return unit.offset + value;
+            case dwarf::FORM_ref_addr:
+                return value;
+            default:
+                return 0;
+        }
+    }
+}
+
+// What one worker found in the units it was handed
+struct DwarfIndex::Partial
+{
+    struct Function
+    {
+        std::string name;
+        std::uint32_t base;
+        virt_addr low;
+        virt_addr high;
+        std::uint64_t die_offset;
+    };
+
+    struct Type
+    {
+        std::string name;
+        std::uint32_t base;
+        std::uint16_t tag;
+        std::uint64_t die_offset;
+    };
+
+    std::vector<Function> functions;
+    std::vector<Type> types;
+};
+
+// Table rows, names are offsets into the string pool
+struct DwarfIndex::FunctionRecord
+{
+    std::uint64_t low;
+    std::uint64_t high;
+    std::uint64_t die_offset;
+    std::uint64_t name;
+    std::uint32_t name_size;
+    std::uint32_t base;
+};
+
+struct DwarfIndex::TypeRecord
+{
+    std::uint64_t die_offset;
+    std::uint64_t name;
+    std::uint32_t name_size;
+    std::uint32_t base;
+    std::uint16_t tag;
+    std::uint16_t reserved[3];
+};
+
+namespace
+{
+    constexpr char CACHE_MAGIC[8] = {'B', 'K', 'P', 'T', 'I', 'D', 'X', '\0'};
+    constexpr std::uint32_t CACHE_VERSION = 1;
+
+    // Starts the layout, tables follow at 8 byte aligned offsets. The
+    // size of .debug_info tells a stripped copy of a binary, which
+    // shares its build id, from the one with debug info
+    struct CacheHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t info_size;
+        std::uint64_t units;
+        std::uint64_t function_count;
+        std::uint64_t functions;
+        std::uint64_t by_name;
+        std::uint64_t type_count;
+        std::uint64_t types;
+        std::uint64_t strings_size;
+        std::uint64_t strings;
+    };
+
+    // count entries of size bytes at offset lie within total
+    bool table_fits(std::uint64_t offset, std::uint64_t count, std::size_t size, std::size_t total)
+    {
+        return offset <= total && offset % 8 == 0 && count <= (total - offset) / size;
+    }
+
+    std::uint64_t align8(std::uint64_t value)
+    {
+        return (value + 7) & ~std::uint64_t(7);
+    }
+}
+
+DwarfIndex::DwarfIndex(const Elf &elf, unsigned threads,
+    const std::filesystem::path &cache_dir) :
+    sections_(new DwarfSections(elf))
+{
+    std::string build_id = elf.build_id();
+    if (cache_dir.empty() == false && build_id.empty() == false)
+        cache_path_ = cache_dir / (build_id + ".dwidx");
+
+    thread_ = std::thread(&DwarfIndex::build, this, threads);
+}
+
+DwarfIndex::~DwarfIndex()
+{
+    stop_.store(true);
+    if (thread_.joinable())
+        thread_.join();
+    if (mapped_ != nullptr)
+        ::munmap(mapped_, mapped_size_);
+}
+
+std::filesystem::path DwarfIndex::default_cache_dir()
+{
+    if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && xdg[0] == '/')
+        return std::filesystem::path(xdg) / "bkpt";
+    if (const char *home = std::getenv("HOME"); home != nullptr && home[0] != '\0')
+        return std::filesystem::path(home) / ".cache" / "bkpt";
+    return {};
+}
+
+void DwarfIndex::wait() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return ready(); });
+}
+
+bool DwarfIndex::from_cache() const
+{
+    wait();
+    return mapped_ != nullptr;
+}
+
+void DwarfIndex::build(unsigned threads)
+{
+    if (load_cache() == false)
+    {
+        if (index(threads) == false)
+            return;
+        attach(owned_.data(), owned_.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.store(true, std::memory_order_release);
+    }
+    done_.notify_all();
+
+    // Lookups do not wait on the disk, a failed save only costs the
+    // next session the indexing
+    if (mapped_ == nullptr)
+        save_cache();
+}
+
+bool DwarfIndex::index(unsigned threads)
+{
+    // Unit lengths chain the headers, only those are read up front
+    std::vector<std::uint64_t> offsets;
+    DwarfReader info(sections_->info);
+    while (info.done() == false)
+    {
+        try
+        {
+            UnitHeader header = read_unit_header(info);
+            offsets.push_back(header.offset);
+            info.seek(header.end);
+        }
+        catch (const Error &)
+        {
+            break;
+        }
+    }
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads,
+        std::max<std::size_t>(offsets.size(), 1)));
+
+    // Units are handed out one at a time so a few huge ones do not hold
+    // up the share of a single worker
+    std::atomic<std::size_t> next{0};
+    std::vector<Partial> partials(threads);
+    auto work = [&](Partial &partial)
+    {
+        for (std::size_t i = next++; i < offsets.size() && stop_.load() == false; i = next++)
+        {
+            try
+            {
+                index_unit(offsets[i], partial);
+            }
+            catch (const Error &)
+            {
+                // A unit we cannot read leaves the rest usable
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++)
+    {
+        try
+        {
+            workers.emplace_back(work, std::ref(partials[i]));
+        }
+        catch (const std::system_error &)
+        {
+            // Fewer workers only take longer
+            break;
+        }
+    }
+    work(partials[0]);
+    for (auto &worker : workers)
+        worker.join();
+
+    if (stop_.load())
+        return false;
+
+    owned_ = merge(partials, offsets.size());
+    return true;
+}
+
+void DwarfIndex::index_unit(std::uint64_t offset, Partial &partial) const
+{
+    DwarfReader info(sections_->info);
+    info.seek(offset);
+    UnitHeader unit = read_unit_header(info);
+    if (unit.unit_type != dwarf::UT_compile && unit.unit_type != dwarf::UT_partial &&
+        unit.unit_type != dwarf::UT_type)
+        return;
+
+    // Codes usually count up from 1, which makes them the position
+    auto abbrevs = read_abbrevs(*sections_, unit.abbrev_offset);
+    auto find_abbrev = [&](std::uint64_t code) -> const Abbrev *
+    {
+        if (code <= abbrevs.size() && abbrevs[code - 1].code == code)
+            return &abbrevs[code - 1];
+        for (const auto &abbrev : abbrevs)
+        {
+            if (abbrev.code == code)
+                return &abbrev;
+        }
+        return nullptr;
+    };
+
+    // Out of line definitions take the name of the declaration they
+    // refer to, which may come later in the unit
+    std::unordered_map<std::uint64_t, std::string> declared;
+    std::unordered_map<std::uint64_t, std::uint64_t> aliases;
+    std::vector<std::pair<Partial::Function, std::uint64_t>> unnamed;
+
+    // Qualified prefix and where each open DIE with children cut it
+    std::string prefix;
+    std::vector<std::size_t> scopes;
+    bool root = true;
+
+    while (info.pos() < unit.end)
+    {
+        std::uint64_t die_offset = info.pos();
+        std::uint64_t code = info.uleb();
+        if (code == 0)
+        {
+            if (scopes.empty())
+                break;
+            prefix.resize(scopes.back());
+            scopes.pop_back();
+            continue;
+        }
+
+        const Abbrev *abbrev = find_abbrev(code);
+        if (abbrev == nullptr)
+            Error::send("Unknown DWARF abbreviation " + std::to_string(code));
+
+        bool wanted = root || abbrev->tag == dwarf::TAG_subprogram ||
+            is_scope(abbrev->tag) || is_type(abbrev->tag);
+        if (wanted == false)
+        {
+            for (const auto &spec : abbrev->attrs)
+                skip_form(info, spec.form, unit);
+            if (abbrev->has_children)
+                scopes.push_back(prefix.size());
+            continue;
+        }
+
+        std::string_view name;
+        virt_addr low = 0, high = 0;
+        bool high_is_offset = false;
+        bool declaration = false;
+        std::uint64_t origin = 0, sibling = 0;
+        for (const auto &spec : abbrev->attrs)
+        {
+            switch (spec.name)
+            {
+                case dwarf::AT_name:
+                    name = read_form(info, spec, unit, *sections_).str;
+                    break;
+                case dwarf::AT_low_pc:
+                    low = read_form(info, spec, unit, *sections_).value;
+                    break;
+                case dwarf::AT_high_pc:
+                    high = read_form(info, spec, unit, *sections_).value;
+                    high_is_offset = (spec.form != dwarf::FORM_addr);
+                    break;
+                case dwarf::AT_declaration:
+                    declaration = (read_form(info, spec, unit, *sections_).value != 0);
+                    break;
+                case dwarf::AT_specification:
+                case dwarf::AT_abstract_origin:
+                    origin = reference(spec, read_form(info, spec, unit, *sections_).value, unit);
+                    break;
+                case dwarf::AT_sibling:
+                    sibling = reference(spec, read_form(info, spec, unit, *sections_).value, unit);
+                    break;
+                case dwarf::AT_str_offsets_base:
+                    if (root)
+                        unit.str_offsets_base = read_form(info, spec, unit, *sections_).value;
+                    else
+                        skip_form(info, spec.form, unit);
+                    break;
+                case dwarf::AT_addr_base:
+                    if (root)
+                        unit.addr_base = read_form(info, spec, unit, *sections_).value;
+                    else
+                        skip_form(info, spec.form, unit);
+                    break;
+                default:
+                    skip_form(info, spec.form, unit);
+                    break;
+            }
+        }
+        if (high_is_offset)
+            high += low;
+
+        std::string qualified;
+        if (root == false && name.empty() == false)
+        {
+            qualified.reserve(prefix.size() + name.size());
+            qualified.append(prefix).append(name);
+        }
+
+        if (abbrev->tag == dwarf::TAG_subprogram)
+        {
+            // Code the linker dropped keeps a low pc of 0
+            bool defined = declaration == false && low != 0 && high > low;
+            Partial::Function function{std::string(), 0, low, high, die_offset};
+            if (qualified.empty() == false)
+            {
+                declared.emplace(die_offset, qualified);
+                if (defined)
+                {
+                    function.name = std::move(qualified);
+                    partial.functions.push_back(std::move(function));
+                }
+            }
+            else if (origin != 0)
+            {
+                aliases.emplace(die_offset, origin);
+                if (defined)
+                    unnamed.emplace_back(std::move(function), origin);
+            }
+
+            // Nothing below a function body is indexed
+            if (abbrev->has_children && sibling > info.pos() && sibling <= unit.end)
+            {
+                info.seek(sibling);
+                continue;
+            }
+        }
+        else if (is_type(abbrev->tag) && declaration == false && qualified.empty() == false)
+        {
+            partial.types.push_back({std::move(qualified), 0, static_cast<std::uint16_t>(abbrev->tag), die_offset});
+        }
+
+        if (abbrev->has_children)
+        {
+            scopes.push_back(prefix.size());
+            if (is_scope(abbrev->tag) && name.empty() == false)
+                prefix.append(name).append("::");
+        }
+        root = false;
+    }
+
+    // Abstract instances may refer on to the declaration in turn
+    for (auto &[function, origin] : unnamed)
+    {
+        for (int hop = 0; hop < 4 && function.name.empty(); hop++)
+        {
+            auto named = declared.find(origin);
+            if (named != declared.end())
+            {
+                function.name = named->second;
+                break;
+            }
+            auto alias = aliases.find(origin);
+            if (alias == aliases.end())
+                break;
+            origin = alias->second;
+        }
+        if (function.name.empty() == false)
+            partial.functions.push_back(std::move(function));
+    }
+
+    for (auto &function : partial.functions)
+        function.base = base_offset(function.name);
+    for (auto &type : partial.types)
+        type.base = base_offset(type.name);
+}
+
+std::vector<std::uint8_t>
+DwarfIndex::merge(std::vector<Partial> &partials, std::uint64_t units) const
+{
+    std::vector<Partial::Function> functions;
+    std::vector<Partial::Type> types;
+    std::size_t function_total = 0, type_total = 0;
+    for (const auto &partial : partials)
+    {
+        function_total += partial.functions.size();
+        type_total += partial.types.size();
+    }
+    functions.reserve(function_total);
+    types.reserve(type_total);
+    for (auto &partial : partials)
+    {
+        std::move(partial.functions.begin(), partial.functions.end(), std::back_inserter(functions));
+        std::move(partial.types.begin(), partial.types.end(), std::back_inserter(types));
+        partial = Partial();
+    }
+
+    // Inline and template functions are defined by every unit using
+    // them, the linker keeps one copy of the code
+    std::sort(functions.begin(), functions.end(),
+        [](const Partial::Function &a, const Partial::Function &b)
+        {
+            if (a.low != b.low)
+                return a.low < b.low;
+            if (a.name != b.name)
+                return a.name < b.name;
+            return a.die_offset < b.die_offset;
+        });
+    functions.erase(std::unique(functions.begin(), functions.end(),
+        [](const Partial::Function &a, const Partial::Function &b)
+        {
+            return a.low == b.low && a.name == b.name;
+        }), functions.end());
+
+    auto base_of = [](const auto &entry) { return std::string_view(entry.name).substr(entry.base); };
+    std::vector<std::uint32_t> by_name(functions.size());
+    std::iota(by_name.begin(), by_name.end(), 0);
+    std::sort(by_name.begin(), by_name.end(),
+        [&](std::uint32_t a, std::uint32_t b)
+        {
+            const auto &fa = functions[a], &fb = functions[b];
+            if (base_of(fa) != base_of(fb))
+                return base_of(fa) < base_of(fb);
+            if (fa.name != fb.name)
+                return fa.name < fb.name;
+            return a < b;
+        });
+
+    // Each unit repeats the types it uses, the first definition stays
+    std::sort(types.begin(), types.end(),
+        [&](const Partial::Type &a, const Partial::Type &b)
+        {
+            if (base_of(a) != base_of(b))
+                return base_of(a) < base_of(b);
+            if (a.name != b.name)
+                return a.name < b.name;
+            if (a.tag != b.tag)
+                return a.tag < b.tag;
+            return a.die_offset < b.die_offset;
+        });
+    types.erase(std::unique(types.begin(), types.end(),
+        [](const Partial::Type &a, const Partial::Type &b)
+        {
+            return a.tag == b.tag && a.name == b.name;
+        }), types.end());
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.info_size = sections_->info.size();
+    header.units = units;
+    header.function_count = functions.size();
+    header.functions = sizeof(CacheHeader);
+    header.by_name = header.functions + functions.size() * sizeof(FunctionRecord);
+    header.type_count = types.size();
+    header.types = align8(header.by_name + by_name.size() * sizeof(std::uint32_t));
+    header.strings = header.types + types.size() * sizeof(TypeRecord);
+    for (const auto &function : functions)
+        header.strings_size += function.name.size();
+    for (const auto &type : types)
+        header.strings_size += type.name.size();
+
+    std::vector<std::uint8_t> layout(header.strings + header.strings_size);
+    std::memcpy(layout.data(), &header, sizeof(header));
+    std::uint64_t name = 0;
+    auto add_name = [&](const std::string &str)
+    {
+        std::memcpy(layout.data() + header.strings + name, str.data(), str.size());
+        name += str.size();
+        return name - str.size();
+    };
+
+    for (std::size_t i = 0; i < functions.size(); i++)
+    {
+        const auto &function = functions[i];
+        FunctionRecord record = {function.low, function.high, function.die_offset,
+            add_name(function.name), static_cast<std::uint32_t>(function.name.size()), function.base};
+        std::memcpy(layout.data() + header.functions + i * sizeof(record), &record, sizeof(record));
+    }
+    std::memcpy(layout.data() + header.by_name, by_name.data(), by_name.size() * sizeof(std::uint32_t));
+    for (std::size_t i = 0; i < types.size(); i++)
+    {
+        const auto &type = types[i];
+        TypeRecord record = {type.die_offset, add_name(type.name),
+            static_cast<std::uint32_t>(type.name.size()), type.base, type.tag, {}};
+        std::memcpy(layout.data() + header.types + i * sizeof(record), &record, sizeof(record));
+    }
+    return layout;
+}
+
+bool DwarfIndex::attach(const std::uint8_t *data, std::size_t size)
+{
+    CacheHeader header;
+    if (size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION || header.info_size != sections_->info.size())
+        return false;
+    if (table_fits(header.functions, header.function_count, sizeof(FunctionRecord), size) == false ||
+        table_fits(header.by_name, header.function_count, sizeof(std::uint32_t), size) == false ||
+        table_fits(header.types, header.type_count, sizeof(TypeRecord), size) == false ||
+        header.strings > size || header.strings_size > size - header.strings)
+        return false;
+
+    Span<const std::uint32_t> by_name(
+        reinterpret_cast<const std::uint32_t *>(data + header.by_name), header.function_count);
+    for (std::uint32_t i : by_name)
+    {
+        if (i >= header.function_count)
+            return false;
+    }
+
+    units_ = header.units;
+    functions_ = {reinterpret_cast<const FunctionRecord *>(data + header.functions), header.function_count};
+    functions_by_name_ = by_name;
+    types_ = {reinterpret_cast<const TypeRecord *>(data + header.types), header.type_count};
+    strings_ = {reinterpret_cast<const char *>(data + header.strings), header.strings_size};
+    return true;
+}
+
+bool DwarfIndex::load_cache()
+{
+    if (cache_path_.empty())
+        return false;
+
+    int fd = ::open(cache_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<std::size_t>(st.st_size) < sizeof(CacheHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    // A stale or damaged file is indexed over and replaced
+    if (attach(static_cast<const std::uint8_t *>(map), size) == false)
+    {
+        ::munmap(map, size);
+        return false;
+    }
+    mapped_ = map;
+    mapped_size_ = size;
+    return true;
+}
+
+void DwarfIndex::save_cache() const
+{
+    if (cache_path_.empty())
+        return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path_.parent_path(), ec);
+    if (ec)
+        return;
+
+    // Written aside and renamed, readers never map a partial file
+    std::string temp = cache_path_.string() + ".XXXXXX";
+    int fd = ::mkstemp(temp.data());
+    if (fd < 0)
+        return;
+
+    const std::uint8_t *data = owned_.data();
+    std::size_t left = owned_.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            break;
+        data += written;
+        left -= static_cast<std::size_t>(written);
+    }
+
+    bool saved = (::close(fd) == 0 && left == 0);
+    if (saved == false || ::rename(temp.c_str(), cache_path_.c_str()) < 0)
+        ::unlink(temp.c_str());
+}
+
+DwarfFunction DwarfIndex::function(const FunctionRecord &record) const
+{
+    DwarfFunction function;
+    if (record.name <= strings_.size() && record.name_size <= strings_.size() - record.name)
+        function.name = strings_.substr(record.name, record.name_size);
+    function.base = std::min<std::uint32_t>(record.base, static_cast<std::uint32_t>(function.name.size()));
+    function.low = record.low;
+    function.high = record.high;
+    function.die_offset = record.die_offset;
+    return function;
+}
+
+DwarfType DwarfIndex::type(const TypeRecord &record) const
+{
+    DwarfType type;
+    if (record.name <= strings_.size() && record.name_size <= strings_.size() - record.name)
+        type.name = strings_.substr(record.name, record.name_size);
+    type.base = std::min<std::uint32_t>(record.base, static_cast<std::uint32_t>(type.name.size()));
+    type.tag = record.tag;
+    type.die_offset = record.die_offset;
+    return type;
+}
+
+std::vector<DwarfFunction> DwarfIndex::functions_named(std::string_view name) const
+{
+    wait();
+    std::string_view base = name.substr(base_offset(name));
+    auto first = std::lower_bound(functions_by_name_.begin(), functions_by_name_.end(), base,
+        [this](std::uint32_t i, std::string_view b) { return function(functions_.begin()[i]).base_name() < b; });
+    auto last = std::upper_bound(first, functions_by_name_.end(), base,
+        [this](std::string_view b, std::uint32_t i) { return b < function(functions_.begin()[i]).base_name(); });
+
+    std::vector<DwarfFunction> found;
+    for (auto it = first; it != last; ++it)
+    {
+        DwarfFunction candidate = function(functions_.begin()[*it]);
+        if (name_matches(candidate.name, name))
+            found.push_back(candidate);
+    }
+    std::sort(found.begin(), found.end(),
+        [](const DwarfFunction &a, const DwarfFunction &b) { return a.low < b.low; });
+    return found;
+}
+
+std::optional<DwarfFunction> DwarfIndex::function_containing(virt_addr address) const
+{
+    wait();
+    auto it = std::upper_bound(functions_.begin(), functions_.end(), address,
+        [](virt_addr addr, const FunctionRecord &record) { return addr < record.low; });
+    if (it == functions_.begin())
+        return std::nullopt;
+    --it;
+    if (address >= it->high)
+        return std::nullopt;
+    return function(*it);
+}
+
+std::vector<DwarfType> DwarfIndex::types_named(std::string_view name) const
+{
+    wait();
+    std::string_view base = name.substr(base_offset(name));
+    auto first = std::lower_bound(types_.begin(), types_.end(), base,
+        [this](const TypeRecord &record, std::string_view b) { return type(record).base_name() < b; });
+    auto last = std::upper_bound(first, types_.end(), base,
+        [this](std::string_view b, const TypeRecord &record) { return b < type(record).base_name(); });
+
+    std::vector<DwarfType> found;
+    for (auto it = first; it != last; ++it)
+    {
+        DwarfType candidate = type(*it);
+        if (name_matches(candidate.name, name))
+            found.push_back(candidate);
+    }
+    return found;
+}
+
+std::size_t DwarfIndex::unit_count() const
+{
+    wait();
+    return units_;
+}
+
+std::size_t DwarfIndex::function_count() const
+{
+    wait();
+    return functions_.size();
+}
+
+std::size_t DwarfIndex::type_count() const
+{
+    wait();
+    return types_.size();
+}
@@ -0,0 +1,410 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "dwarf_reader.hpp"
+#include "elf.hpp"
+
+#include <string>
+
+namespace
+{
+    std::string_view string_at(Span<const std::uint8_t> section, std::uint64_t offset)
+    {
+        if (offset >= section.size())
+            return {};
+        const char *str = reinterpret_cast<const char *>(section.begin() + offset);
+        return {str, ::strnlen(str, section.size() - offset)};
+    }
+
+    Span<const std::uint8_t> contents(const Elf &elf, std::string_view name)
+    {
+        // Compressed debug sections would need inflating first
+        const Elf64_Shdr *sec = elf.section(name);
+        if (sec == nullptr || (sec->sh_flags & SHF_COMPRESSED))
+            return {};
+        return elf.section_contents(*sec);
+    }
+}
+
+std::uint64_t DwarfReader::uleb()
+{
+    std::uint64_t val = 0;
+    unsigned shift = 0;
+    std::uint8_t byte;
+    do
+    {
+        byte = read<std::uint8_t>();
+        if (shift < 64)
+            val |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return val;
+}
+
+std::int64_t DwarfReader::sleb()
+{
+    std::int64_t val = 0;
+    unsigned shift = 0;
+    std::uint8_t byte;
+    do
+    {
+        byte = read<std::uint8_t>();
+        if (shift < 64)
+            val |= static_cast<std::int64_t>(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    if (shift < 64 && (byte & 0x40))
+        val |= -(static_cast<std::int64_t>(1) << shift);
+    return val;
+}
+
+std::string_view DwarfReader::cstr()
+{
+    const char *str = reinterpret_cast<const char *>(data_ + pos_);
+    std::size_t len = ::strnlen(str, size_ - pos_);
+    if (len == size_ - pos_)
+        Error::send("DWARF string is not terminated");
+    pos_ += len + 1;
+    return {str, len};
+}
+
+std::uint64_t DwarfReader::initial_length(bool &dwarf64)
+{
+    std::uint64_t length = read<std::uint32_t>();
+    dwarf64 = (length == 0xffffffff);
+    if (dwarf64)
+        length = read<std::uint64_t>();
+    else if (length >= 0xfffffff0)
+        Error::send("Reserved DWARF unit length");
+    return length;
+}
+
+DwarfSections::DwarfSections(const Elf &elf) :
+    info(contents(elf, ".debug_info")),
+    abbrev(contents(elf, ".debug_abbrev")),
+    line(contents(elf, ".debug_line")),
+    str(contents(elf, ".debug_str")),
+    line_str(contents(elf, ".debug_line_str")),
+    str_offsets(contents(elf, ".debug_str_offsets")),
+    addr(contents(elf, ".debug_addr")),
+    aranges(contents(elf, ".debug_aranges"))
+{
+}
+
+UnitHeader read_unit_header(DwarfReader &info)
+{
+    UnitHeader unit;
+    unit.offset = info.pos();
+    std::uint64_t length = info.initial_length(unit.dwarf64);
+    if (length > info.size() - info.pos())
+        Error::send("DWARF unit runs past its section");
+    unit.end = info.pos() + length;
+
+    unit.version = info.read<std::uint16_t>();
+    if (unit.version < 2 || unit.version > 5)
+        Error::send("Unsupported DWARF version " + std::to_string(unit.version));
+
+    if (unit.version == 5)
+    {
+        unit.unit_type = info.read<std::uint8_t>();
+        unit.address_size = info.read<std::uint8_t>();
+        unit.abbrev_offset = info.offset(unit.dwarf64);
+
+        // Split and type units carry an id or a signature before the DIEs
+        if (unit.unit_type == dwarf::UT_skeleton || unit.unit_type == dwarf::UT_split_compile)
+            info.skip(8);
+        else if (unit.unit_type == dwarf::UT_type || unit.unit_type == dwarf::UT_split_type)
+            info.skip(8 + (unit.dwarf64 ? 8 : 4));
+    }
+    else
+    {
+        unit.abbrev_offset = info.offset(unit.dwarf64);
+        unit.address_size = info.read<std::uint8_t>();
+    }
+
+    unit.die_offset = info.pos();
+    return unit;
+}
+
+std::vector<Abbrev> read_abbrevs(const DwarfSections &sections,
+    std::uint64_t offset, std::uint64_t stop_at)
+{
+    DwarfReader reader(sections.abbrev);
+    reader.seek(offset);
+
+    std::vector<Abbrev> abbrevs;
+    while (reader.done() == false)
+    {
+        Abbrev abbrev;
+        abbrev.code = reader.uleb();
+        if (abbrev.code == 0)
+            break;
+        abbrev.tag = reader.uleb();
+        abbrev.has_children = (reader.read<std::uint8_t>() != 0);
+
+        while (true)
+        {
+            AttributeSpec spec;
+            spec.name = reader.uleb();
+            spec.form = reader.uleb();
+            if (spec.name == 0 && spec.form == 0)
+                break;
+            if (spec.form == dwarf::FORM_implicit_const)
+                spec.implicit_const = reader.sleb();
+            abbrev.attrs.push_back(spec);
+        }
+
+        abbrevs.push_back(std::move(abbrev));
+        if (stop_at != 0 && abbrevs.back().code == stop_at)
+            break;
+    }
+    return abbrevs;
+}
+
+FormValue read_form(DwarfReader &reader, const AttributeSpec &spec,
+    const UnitHeader &unit, const DwarfSections &sections)
+{
+    using namespace dwarf;
+    FormValue val;
+    unsigned offset_size = unit.dwarf64 ? 8 : 4;
+
+    auto indexed_string = [&](std::uint64_t index)
+    {
+        val.is_string = true;
+        DwarfReader offsets(sections.str_offsets);
+        std::uint64_t at = unit.str_offsets_base + index * offset_size;
+        if (unit.str_offsets_base == 0 || at + offset_size > offsets.size())
+            return;
+        offsets.seek(at);
+        val.str = string_at(sections.str, offsets.read_bytes(offset_size));
+    };
+    auto indexed_address = [&](std::uint64_t index)
+    {
+        DwarfReader addrs(sections.addr);
+        std::uint64_t at = unit.addr_base + index * unit.address_size;
+        if (unit.addr_base == 0 || at + unit.address_size > addrs.size())
+            return;
+        addrs.seek(at);
+        val.value = addrs.read_bytes(unit.address_size);
+    };
+
+    switch (spec.form)
+    {
+        case FORM_addr:
+            val.value = reader.read_bytes(unit.address_size);
+            break;
+        case FORM_data1:
+        case FORM_ref1:
+        case FORM_flag:
+            val.value = reader.read<std::uint8_t>();
+            break;
+        case FORM_data2:
+        case FORM_ref2:
+            val.value = reader.read<std::uint16_t>();
+            break;
+        case FORM_data4:
+        case FORM_ref4:
+        case FORM_ref_sup4:
+            val.value = reader.read<std::uint32_t>();
+            break;
+        case FORM_data8:
+        case FORM_ref8:
+        case FORM_ref_sig8:
+        case FORM_ref_sup8:
+            val.value = reader.read<std::uint64_t>();
+            break;
+        case FORM_data16:
+            reader.skip(16);
+            break;
+        case FORM_sdata:
+            val.value = static_cast<std::uint64_t>(reader.sleb());
+            break;
+        case FORM_udata:
+        case FORM_ref_udata:
+        case FORM_loclistx:
+        case FORM_rnglistx:
+            val.value = reader.uleb();
+            break;
+        case FORM_flag_present:
+            val.value = 1;
+            break;
+        case FORM_implicit_const:
+            val.value = static_cast<std::uint64_t>(spec.implicit_const);
+            break;
+        case FORM_ref_addr:
+            val.value = reader.read_bytes(unit.version == 2 ? unit.address_size : offset_size);
+            break;
+        case FORM_sec_offset:
+        case FORM_GNU_ref_alt:
+        case FORM_strp_sup:
+        case FORM_GNU_strp_alt:
+            val.value = reader.read_bytes(offset_size);
+            break;
+        case FORM_strp:
+            val.value = reader.read_bytes(offset_size);
+            val.str = string_at(sections.str, val.value);
+            val.is_string = true;
+            break;
+        case FORM_line_strp:
+            val.value = reader.read_bytes(offset_size);
+            val.str = string_at(sections.line_str, val.value);
+            val.is_string = true;
+            break;
+        case FORM_string:
+            val.str = reader.cstr();
+            val.is_string = true;
+            break;
+        case FORM_strx:
+            indexed_string(reader.uleb());
+            break;
+        case FORM_strx1:
+        case FORM_strx2:
+        case FORM_strx3:
+        case FORM_strx4:
+            indexed_string(reader.read_bytes(spec.form - FORM_strx1 + 1));
+            break;
+        case FORM_addrx:
+            indexed_address(reader.uleb());
+            break;
+        case FORM_addrx1:
+        case FORM_addrx2:
+        case FORM_addrx3:
+        case FORM_addrx4:
+            indexed_address(reader.read_bytes(spec.form - FORM_addrx1 + 1));
+            break;
+        case FORM_exprloc:
+        case FORM_block:
+            reader.skip(reader.uleb());
+            break;
+        case FORM_block1:
+            reader.skip(reader.read<std::uint8_t>());
+            break;
+        case FORM_block2:
+            reader.skip(reader.read<std::uint16_t>());
+            break;
+        case FORM_block4:
+            reader.skip(reader.read<std::uint32_t>());
+            break;
+        case FORM_indirect:
+        {
+            AttributeSpec actual = spec;
+            actual.form = reader.uleb();
+            return read_form(reader, actual, unit, sections);
+        }
+        default:
+            Error::send("Unknown DWARF form " + std::to_string(spec.form));
+    }
+    return val;
+}
+
+void skip_form(DwarfReader &reader, std::uint64_t form, const UnitHeader &unit)
+{
+    using namespace dwarf;
+    unsigned offset_size = unit.dwarf64 ? 8 : 4;
+
+    switch (form)
+    {
+        case FORM_flag_present:
+        case FORM_implicit_const:
+            break;
+        case FORM_addr:
+            reader.skip(unit.address_size);
+            break;
+        case FORM_data1:
+        case FORM_ref1:
+        case FORM_flag:
+        case FORM_strx1:
+        case FORM_addrx1:
+            reader.skip(1);
+            break;
+        case FORM_data2:
+        case FORM_ref2:
+        case FORM_strx2:
+        case FORM_addrx2:
+            reader.skip(2);
+            break;
+        case FORM_strx3:
+        case FORM_addrx3:
+            reader.skip(3);
+            break;
+        case FORM_data4:
+        case FORM_ref4:
+        case FORM_ref_sup4:
+        case FORM_strx4:
+        case FORM_addrx4:
+            reader.skip(4);
+            break;
+        case FORM_data8:
+        case FORM_ref8:
+        case FORM_ref_sig8:
+        case FORM_ref_sup8:
+            reader.skip(8);
+            break;
+        case FORM_data16:
+            reader.skip(16);
+            break;
+        case FORM_sdata:
+        case FORM_udata:
+        case FORM_ref_udata:
+        case FORM_strx:
+        case FORM_addrx:
+        case FORM_loclistx:
+        case FORM_rnglistx:
+            reader.uleb();
+            break;
+        case FORM_ref_addr:
+            reader.skip(unit.version == 2 ? unit.address_size : offset_size);
+            break;
+        case FORM_sec_offset:
+        case FORM_strp:
+        case FORM_line_strp:
+        case FORM_strp_sup:
+        case FORM_GNU_ref_alt:
+        case FORM_GNU_strp_alt:
+            reader.skip(offset_size);
+            break;
+        case FORM_string:
+            reader.cstr();
+            break;
+        case FORM_exprloc:
+        case FORM_block:
+            reader.skip(reader.uleb());
+            break;
+        case FORM_block1:
+            reader.skip(reader.read<std::uint8_t>());
+            break;
+        case FORM_block2:
+            reader.skip(reader.read<std::uint16_t>());
+            break;
+        case FORM_block4:
+            reader.skip(reader.read<std::uint32_t>());
+            break;
+        case FORM_indirect:
+            skip_form(reader, reader.uleb(), unit);
+            break;
+        default:
+            Error::send("Unknown DWARF form " + std::to_string(form));
+    }
+}
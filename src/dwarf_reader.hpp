@@ -0,0 +1,258 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef BKPT_LIB_DWARF_READER_HPP
+#define BKPT_LIB_DWARF_READER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "types.hpp"
+#include "error.hpp"
+
+class Elf;
+
+// The DWARF 4 and 5 encodings the debugger understands
+namespace dwarf
+{
+    enum Form : std::uint16_t
+    {
+        FORM_addr = 0x01,
+        FORM_block2 = 0x03,
+        FORM_block4 = 0x04,
+        FORM_data2 = 0x05,
+        FORM_data4 = 0x06,
+        FORM_data8 = 0x07,
+        FORM_string = 0x08,
+        FORM_block = 0x09,
+        FORM_block1 = 0x0a,
+        FORM_data1 = 0x0b,
+        FORM_flag = 0x0c,
+        FORM_sdata = 0x0d,
+        FORM_strp = 0x0e,
+        FORM_udata = 0x0f,
+        FORM_ref_addr = 0x10,
+        FORM_ref1 = 0x11,
+        FORM_ref2 = 0x12,
+        FORM_ref4 = 0x13,
+        FORM_ref8 = 0x14,
+        FORM_ref_udata = 0x15,
+        FORM_indirect = 0x16,
+        FORM_sec_offset = 0x17,
+        FORM_exprloc = 0x18,
+        FORM_flag_present = 0x19,
+        FORM_strx = 0x1a,
+        FORM_addrx = 0x1b,
+        FORM_ref_sup4 = 0x1c,
+        FORM_strp_sup = 0x1d,
+        FORM_data16 = 0x1e,
+        FORM_line_strp = 0x1f,
+        FORM_ref_sig8 = 0x20,
+        FORM_implicit_const = 0x21,
+        FORM_loclistx = 0x22,
+        FORM_rnglistx = 0x23,
+        FORM_ref_sup8 = 0x24,
+        FORM_strx1 = 0x25,
+        FORM_strx2 = 0x26,
+        FORM_strx3 = 0x27,
+        FORM_strx4 = 0x28,
+        FORM_addrx1 = 0x29,
+        FORM_addrx2 = 0x2a,
+        FORM_addrx3 = 0x2b,
+        FORM_addrx4 = 0x2c,
+        FORM_GNU_ref_alt = 0x1f20,
+        FORM_GNU_strp_alt = 0x1f21,
+    };
+
+    enum Attribute : std::uint16_t
+    {
+        AT_sibling = 0x01,
+        AT_name = 0x03,
+        AT_stmt_list = 0x10,
+        AT_low_pc = 0x11,
+        AT_high_pc = 0x12,
+        AT_comp_dir = 0x1b,
+        AT_abstract_origin = 0x31,
+        AT_declaration = 0x3c,
+        AT_specification = 0x47,
+        AT_str_offsets_base = 0x72,
+        AT_addr_base = 0x73,
+    };
+
+    enum Tag : std::uint16_t
+    {
+        TAG_class_type = 0x02,
+        TAG_enumeration_type = 0x04,
+        TAG_structure_type = 0x13,
+        TAG_typedef = 0x16,
+        TAG_union_type = 0x17,
+        TAG_base_type = 0x24,
+        TAG_subprogram = 0x2e,
+        TAG_namespace = 0x39,
+    };
+
+    enum UnitType : std::uint8_t
+    {
+        UT_compile = 0x01,
+        UT_type = 0x02,
+        UT_partial = 0x03,
+        UT_skeleton = 0x04,
+        UT_split_compile = 0x05,
+        UT_split_type = 0x06,
+    };
+}
+
+// Bounds checked little endian reader over a section mapped in memory
+class DwarfReader
+{
+public:
+    DwarfReader() = default;
+    DwarfReader(Span<const std::uint8_t> data) : data_(data.begin()), size_(data.size()) {}
+
+    bool done() const { return pos_ >= size_; }
+    std::size_t pos() const { return pos_; }
+    std::size_t size() const { return size_; }
+
+    void seek(std::size_t pos)
+    {
+        if (pos > size_)
+            Error::send("DWARF data is truncated");
+        pos_ = pos;
+    }
+    void skip(std::uint64_t count)
+    {
+        if (count > size_ - pos_)
+            Error::send("DWARF data is truncated");
+        pos_ += count;
+    }
+
+    template <typename T>
+    T read()
+    {
+        if (sizeof(T) > size_ - pos_)
+            Error::send("DWARF data is truncated");
+        T val;
+        std::memcpy(&val, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return val;
+    }
+
+    // Unsigned little endian of 1 to 8 bytes
+    std::uint64_t read_bytes(unsigned count)
+    {
+        if (count > size_ - pos_)
+            Error::send("DWARF data is truncated");
+        std::uint64_t val = 0;
+        for (unsigned i = 0; i < count; i++)
+            val |= static_cast<std::uint64_t>(data_[pos_ + i]) << (8 * i);
+        pos_ += count;
+        return val;
+    }
+
+    std::uint64_t uleb();
+    std::int64_t sleb();
+    std::string_view cstr();
+
+    // Unit length, switching to 64-bit offsets on the escape value
+    std::uint64_t initial_length(bool &dwarf64);
+    std::uint64_t offset(bool dwarf64) { return dwarf64 ? read<std::uint64_t>() : read<std::uint32_t>(); }
+
+private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t pos_ = 0;
+};
+
+// Sections attribute values point into, empty when absent
+struct DwarfSections
+{
+    Span<const std::uint8_t> info;
+    Span<const std::uint8_t> abbrev;
+    Span<const std::uint8_t> line;
+    Span<const std::uint8_t> str;
+    Span<const std::uint8_t> line_str;
+    Span<const std::uint8_t> str_offsets;
+    Span<const std::uint8_t> addr;
+    Span<const std::uint8_t> aranges;
+
+    explicit DwarfSections(const Elf &elf);
+};
+
+struct UnitHeader
+{
+    std::uint64_t offset = 0;
+    std::uint64_t end = 0;
+    std::uint16_t version = 0;
+    std::uint8_t unit_type = dwarf::UT_compile;
+    std::uint8_t address_size = 8;
+    bool dwarf64 = false;
+    std::uint64_t abbrev_offset = 0;
+
+    // Offset of the first DIE within .debug_info
+    std::uint64_t die_offset = 0;
+
+    // Set from the unit DIE, strx and addrx forms index from them
+    std::uint64_t str_offsets_base = 0;
+    std::uint64_t addr_base = 0;
+};
+
+struct AttributeSpec
+{
+    std::uint64_t name = 0;
+    std::uint64_t form = 0;
+    std::int64_t implicit_const = 0;
+};
+
+struct Abbrev
+{
+    std::uint64_t code = 0;
+    std::uint64_t tag = 0;
+    bool has_children = false;
+    std::vector<AttributeSpec> attrs;
+};
+
+// Value of one attribute, str is set for string forms
+struct FormValue
+{
+    std::uint64_t value = 0;
+    std::string_view str;
+    bool is_string = false;
+};
+
+// Reads the header of the unit at the reader position, leaving it at
+// the first DIE
+UnitHeader read_unit_header(DwarfReader &info);
+
+// Declarations of an abbreviation table in code order, stopping early
+// at the code wanted when one is given
+std::vector<Abbrev> read_abbrevs(const DwarfSections &sections,
+    std::uint64_t offset, std::uint64_t stop_at = 0);
+
+FormValue read_form(DwarfReader &reader, const AttributeSpec &spec,
+    const UnitHeader &unit, const DwarfSections &sections);
+void skip_form(DwarfReader &reader, std::uint64_t form, const UnitHeader &unit);
+
+#endif
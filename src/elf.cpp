@@ -0,0 +1,350 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "elf.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+    bool in_bounds(std::uint64_t offset, std::uint64_t size, std::size_t total)
+    {
+        return offset <= total && size <= total - offset;
+    }
+
+    // Only symbols that name code or data take part in symbolization,
+    // AArch64 mapping symbols such as $x and $d are STT_NOTYPE
+    bool indexable(const Elf64_Sym &sym)
+    {
+        auto type = ELF64_ST_TYPE(sym.st_info);
+        if (type != STT_FUNC && type != STT_OBJECT && type != STT_GNU_IFUNC)
+            return false;
+        return sym.st_shndx != SHN_UNDEF && sym.st_value != 0 && sym.st_name != 0;
+    }
+}
+
+Elf::Elf(const std::filesystem::path &path) : path_(path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        Error::send_errno("Could not open ELF file " + path.string());
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0)
+    {
+        ::close(fd);
+        Error::send_errno("Could not stat ELF file " + path.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < sizeof(Elf64_Ehdr))
+    {
+        ::close(fd);
+        Error::send("File too small to be ELF " + path.string());
+    }
+
+    // Pages are only faulted in for the parts we look at
+    void *map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        Error::send_errno("Could not map ELF file " + path.string());
+    data_ = static_cast<const std::uint8_t *>(map);
+
+    header_ = reinterpret_cast<const Elf64_Ehdr *>(data_);
+    const char *problem = nullptr;
+    if (std::memcmp(header_->e_ident, ELFMAG, SELFMAG) != 0)
+        problem = "Not an ELF file ";
+    else if (header_->e_ident[EI_CLASS] != ELFCLASS64 ||
+             header_->e_ident[EI_DATA] != ELFDATA2LSB)
+        problem = "Only little endian ELF64 is supported ";
+    else if ((header_->e_shnum != 0 && header_->e_shentsize != sizeof(Elf64_Shdr)) ||
+             (header_->e_phnum != 0 && header_->e_phentsize != sizeof(Elf64_Phdr)))
+        problem = "Unexpected ELF header entry sizes ";
+    else if (in_bounds(header_->e_shoff, header_->e_shnum * sizeof(Elf64_Shdr), size_) == false ||
+             in_bounds(header_->e_phoff, header_->e_phnum * sizeof(Elf64_Phdr), size_) == false)
+        problem = "ELF headers lie outside the file ";
+
+    if (problem != nullptr)
+    {
+        ::munmap(map, size_);
+        Error::send(problem + path.string());
+    }
+
+    sections_ = {reinterpret_cast<const Elf64_Shdr *>(data_ + header_->e_shoff),
+        header_->e_shnum};
+    program_headers_ = {reinterpret_cast<const Elf64_Phdr *>(data_ + header_->e_phoff),
+        header_->e_phnum};
+
+    if (header_->e_shstrndx < sections_.size())
+    {
+        const Elf64_Shdr &names = *(sections_.begin() + header_->e_shstrndx);
+        if (in_bounds(names.sh_offset, names.sh_size, size_))
+        {
+            section_names_ = reinterpret_cast<const char *>(data_ + names.sh_offset);
+            section_names_size_ = names.sh_size;
+        }
+    }
+}
+
+Elf::~Elf()
+{
+    ::munmap(const_cast<std::uint8_t *>(data_), size_);
+}
+
+std::string_view Elf::section_name(const Elf64_Shdr &section) const
+{
+    if (section_names_ == nullptr || section.sh_name >= section_names_size_)
+        return {};
+    return section_names_ + section.sh_name;
+}
+
+const Elf64_Shdr *Elf::section(std::string_view name) const
+{
+    for (const auto &sec : sections_)
+    {
+        if (section_name(sec) == name)
+            return &sec;
+    }
+    return nullptr;
+}
+
+const Elf64_Shdr *Elf::section_containing(virt_addr address) const
+{
+    for (const auto &sec : sections_)
+    {
+        if ((sec.sh_flags & SHF_ALLOC) && address >= sec.sh_addr &&
+            address - sec.sh_addr < sec.sh_size)
+            return &sec;
+    }
+    return nullptr;
+}
+
+Span<const std::uint8_t> Elf::section_contents(const Elf64_Shdr &section) const
+{
+    if (section.sh_type == SHT_NOBITS ||
+        in_bounds(section.sh_offset, section.sh_size, size_) == false)
+        return {};
+    return {data_ + section.sh_offset, section.sh_size};
+}
+
+std::string Elf::build_id() const
+{
+    // Notes are found through PT_NOTE, section headers may be stripped
+    for (const auto &phdr : program_headers_)
+    {
+        if (phdr.p_type != PT_NOTE || in_bounds(phdr.p_offset, phdr.p_filesz, size_) == false)
+            continue;
+
+        std::size_t pos = phdr.p_offset, end = phdr.p_offset + phdr.p_filesz;
+        while (end - pos >= sizeof(Elf64_Nhdr))
+        {
+            Elf64_Nhdr note;
+            std::memcpy(&note, data_ + pos, sizeof(note));
+            std::size_t name_at = pos + sizeof(note);
+            std::size_t desc_at = name_at + ((note.n_namesz + 3) & ~3u);
+            std::size_t next = desc_at + ((note.n_descsz + 3) & ~3u);
+            if (next > end)
+                break;
+
+            if (note.n_type == NT_GNU_BUILD_ID && note.n_namesz == sizeof(ELF_NOTE_GNU) &&
+                std::memcmp(data_ + name_at, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU)) == 0)
+            {
+                static const char digits[] = "0123456789abcdef";
+                std::string id;
+                for (std::size_t i = 0; i < note.n_descsz; i++)
+                {
+                    id += digits[data_[desc_at + i] >> 4];
+                    id += digits[data_[desc_at + i] & 0xf];
+                }
+                return id;
+            }
+            pos = next;
+        }
+    }
+    return {};
+}
+
+virt_addr Elf::image_base() const
+{
+    for (const auto &phdr : program_headers_)
+    {
+        if (phdr.p_type == PT_LOAD)
+            return phdr.p_vaddr - phdr.p_offset;
+    }
+    return 0;
+}
+
+std::string_view Elf::interpreter() const
+{
+    for (const auto &phdr : program_headers_)
+    {
+        if (phdr.p_type != PT_INTERP || phdr.p_offset > size_ || phdr.p_filesz > size_ - phdr.p_offset)
+            continue;
+
+        auto path = reinterpret_cast<const char *>(data_ + phdr.p_offset);
+        return std::string_view(path, ::strnlen(path, phdr.p_filesz));
+    }
+    return {};
+}
+
+std::vector<const ElfSymbol *> Elf::symbols_by_name(std::string_view name) const
+{
+    build_symbol_index();
+
+    std::vector<const ElfSymbol *> found;
+    std::size_t mask = name_slots_.size() - 1;
+    std::size_t slot = std::hash<std::string_view>{}(name) & mask;
+    for (; name_slots_[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const ElfSymbol &sym = symbols_[name_slots_[slot] - 1];
+        if (sym.name == name)
+            found.push_back(&sym);
+    }
+
+    // Probe order depends on insertion, address order does not
+    std::sort(found.begin(), found.end(),
+        [](const ElfSymbol *a, const ElfSymbol *b) { return a->address < b->address; });
+    return found;
+}
+
+const ElfSymbol *Elf::symbol_at(virt_addr address) const
+{
+    build_symbol_index();
+
+    auto it = std::lower_bound(symbols_.begin(), symbols_.end(), address,
+        [](const ElfSymbol &sym, virt_addr addr) { return sym.address < addr; });
+    if (it == symbols_.end() || it->address != address)
+        return nullptr;
+    return &*it;
+}
+
+const ElfSymbol *Elf::symbol_containing(virt_addr address) const
+{
+    build_symbol_index();
+
+    auto it = std::upper_bound(symbols_.begin(), symbols_.end(), address,
+        [](virt_addr addr, const ElfSymbol &sym) { return addr < sym.address; });
+
+    // Aliases share a start, any of them may be the one with a size
+    if (it == symbols_.begin())
+        return nullptr;
+    virt_addr start = std::prev(it)->address;
+    while (it != symbols_.begin() && std::prev(it)->address == start)
+    {
+        --it;
+        if (it->contains(address))
+            return &*it;
+    }
+    return nullptr;
+}
+
+std::size_t Elf::symbol_count() const
+{
+    build_symbol_index();
+    return symbols_.size();
+}
+
+void Elf::build_symbol_index() const
+{
+    if (indexed_)
+        return;
+    indexed_ = true;
+
+    // .dynsym repeats the exported part of .symtab, stripped binaries
+    // only have the former
+    for (const auto &sec : sections_)
+    {
+        if (sec.sh_type == SHT_SYMTAB || sec.sh_type == SHT_DYNSYM)
+            add_symbols(sec);
+    }
+
+    std::sort(symbols_.begin(), symbols_.end(),
+        [](const ElfSymbol &a, const ElfSymbol &b) { return a.address < b.address; });
+
+    // Duplicates share an address, only runs of equal addresses are searched
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < symbols_.size(); i++)
+    {
+        std::size_t run = kept;
+        while (run > 0 && symbols_[run - 1].address == symbols_[i].address)
+            run--;
+
+        bool duplicate = false;
+        for (std::size_t j = run; j < kept && duplicate == false; j++)
+            duplicate = (symbols_[j].name == symbols_[i].name);
+        if (duplicate == false)
+            symbols_[kept++] = symbols_[i];
+    }
+    symbols_.resize(kept);
+
+    // Open addressing kept at most half full, a slot holds index + 1
+    std::size_t capacity = 16;
+    while (capacity < 2 * symbols_.size())
+        capacity *= 2;
+    name_slots_.assign(capacity, 0);
+
+    for (std::size_t i = 0; i < symbols_.size(); i++)
+    {
+        std::size_t slot = std::hash<std::string_view>{}(symbols_[i].name) & (capacity - 1);
+        while (name_slots_[slot] != 0)
+            slot = (slot + 1) & (capacity - 1);
+        name_slots_[slot] = static_cast<std::uint32_t>(i + 1);
+    }
+}
+
+void Elf::add_symbols(const Elf64_Shdr &table) const
+{
+    if (table.sh_entsize != sizeof(Elf64_Sym) || table.sh_link >= sections_.size())
+        return;
+
+    const Elf64_Shdr &strtab = *(sections_.begin() + table.sh_link);
+    auto syms = section_contents(table);
+    auto strs = section_contents(strtab);
+    if (syms.size() == 0 || strs.size() == 0)
+        return;
+
+    auto *first = reinterpret_cast<const Elf64_Sym *>(syms.begin());
+    std::size_t count = syms.size() / sizeof(Elf64_Sym);
+    const char *names = reinterpret_cast<const char *>(strs.begin());
+
+    symbols_.reserve(symbols_.size() + count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const Elf64_Sym &sym = first[i];
+        if (indexable(sym) == false || sym.st_name >= strs.size())
+            continue;
+
+        // The string table may lack its terminator in a damaged file
+        std::size_t max = strs.size() - sym.st_name;
+        std::size_t len = ::strnlen(names + sym.st_name, max);
+        symbols_.push_back({{names + sym.st_name, len}, sym.st_value,
+            sym.st_size, static_cast<std::uint8_t>(ELF64_ST_TYPE(sym.st_info))});
+    }
+}
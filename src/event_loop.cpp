@@ -0,0 +1,201 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "event_loop.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+EventLoop::EventLoop()
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+    {
+        Error::send_errno("epoll_create1() failed");
+    }
+    sigemptyset(&blocked_);
+}
+
+EventLoop::~EventLoop()
+{
+    for (auto &[fd, source] : sources_)
+    {
+        if (source.kind != SourceKind::Fd)
+            close(fd);
+    }
+
+    pthread_sigmask(SIG_UNBLOCK, &blocked_, nullptr);
+    close(epoll_fd_);
+}
+
+void EventLoop::add_source(int fd, SourceKind kind, Callback cb, bool repeat)
+{
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        Error::send_errno("epoll_ctl() failed");
+    }
+
+    sources_[fd] = Source{kind, std::move(cb), repeat};
+}
+
+void EventLoop::remove_source(int fd)
+{
+    auto it = sources_.find(fd);
+    if (it == sources_.end())
+        return;
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (it->second.kind != SourceKind::Fd)
+        close(fd);
+    sources_.erase(it);
+}
+
+void EventLoop::watch_fd(int fd, Callback cb)
+{
+    add_source(fd, SourceKind::Fd, std::move(cb), true);
+}
+
+void EventLoop::unwatch_fd(int fd)
+{
+    remove_source(fd);
+}
+
+int EventLoop::add_timer(std::chrono::milliseconds interval, Callback cb,
+    bool repeat)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0)
+    {
+        Error::send_errno("timerfd_create() failed");
+    }
+
+    // A zero it_value would disarm the timer
+    auto ms = std::max<std::int64_t>(interval.count(), 1);
+    itimerspec spec{};
+    spec.it_value.tv_sec = ms / 1000;
+    spec.it_value.tv_nsec = (ms % 1000) * 1000000;
+    if (repeat)
+        spec.it_interval = spec.it_value;
+
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0)
+    {
+        close(fd);
+        Error::send_errno("timerfd_settime() failed");
+    }
+
+    add_source(fd, SourceKind::Timer, std::move(cb), repeat);
+    return fd;
+}
+
+void EventLoop::cancel_timer(int id)
+{
+    remove_source(id);
+}
+
+void EventLoop::watch_signal(int signo, Callback cb)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, signo);
+
+    // Blocked first so nothing is lost between creation and delivery
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0)
+    {
+        Error::send("Failed to block signal " + std::to_string(signo));
+    }
+    sigaddset(&blocked_, signo);
+
+    int fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (fd < 0)
+    {
+        Error::send_errno("signalfd() failed");
+    }
+
+    add_source(fd, SourceKind::Signal, std::move(cb), true);
+}
+
+bool EventLoop::run_once(std::chrono::milliseconds timeout)
+{
+    std::array<epoll_event, 16> events;
+    int timeout_ms = timeout.count() < 0 ? -1 : static_cast<int>(timeout.count());
+
+    int count = epoll_wait(epoll_fd_, events.data(), events.size(), timeout_ms);
+    if (count < 0)
+    {
+        if (errno == EINTR)
+            return false;
+        Error::send_errno("epoll_wait() failed");
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        // Earlier callbacks in this batch may have removed the source
+        int fd = events[i].data.fd;
+        auto it = sources_.find(fd);
+        if (it == sources_.end())
+            continue;
+
+        Source &source = it->second;
+        if (source.kind == SourceKind::Timer)
+        {
+            std::uint64_t expirations;
+            if (read(fd, &expirations, sizeof(expirations)) < 0)
+                continue;
+        }
+        else if (source.kind == SourceKind::Signal)
+        {
+            // Pending instances of one signal coalesce, drain them all
+            signalfd_siginfo info;
+            while (read(fd, &info, sizeof(info)) == sizeof(info)) {}
+        }
+
+        // The callback may unregister itself, so it runs from a copy
+        Callback cb = source.callback;
+        if (source.kind == SourceKind::Timer && source.repeat == false)
+            remove_source(fd);
+
+        cb();
+    }
+
+    return count > 0;
+}
+
+void EventLoop::run()
+{
+    running_ = true;
+    while (running_)
+    {
+        run_once();
+    }
+}
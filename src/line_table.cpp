@@ -0,0 +1,657 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "line_table.hpp"
+#include "dwarf_reader.hpp"
+#include "elf.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace
+{
+    // Line number program opcodes, DW_LNS_*, DW_LNE_* and DW_LNCT_*
+    enum : std::uint8_t
+    {
+        LNS_copy = 1,
+        LNS_advance_pc,
+        LNS_advance_line,
+        LNS_set_file,
+        LNS_set_column,
+        LNS_negate_stmt,
+        LNS_set_basic_block,
+        LNS_const_add_pc,
+        LNS_fixed_advance_pc,
+        LNS_set_prologue_end,
+        LNS_set_epilogue_begin,
+        LNS_set_isa,
+    };
+
+    enum : std::uint8_t
+    {
+        LNE_end_sequence = 1,
+        LNE_set_address,
+        LNE_define_file,
+        LNE_set_discriminator,
+    };
+
+    enum : std::uint64_t
+    {
+        LNCT_path = 1,
+        LNCT_directory_index = 2,
+    };
+
+    std::string join_path(std::string_view dir, std::string_view name)
+    {
+        if (dir.empty() || (name.empty() == false && name[0] == '/'))
+            return std::string(name);
+
+        std::string path(dir);
+        if (path.back() != '/')
+            path += '/';
+        path += name;
+        return path;
+    }
+
+    // A relative query matches whole trailing components of a path
+    bool path_matches(std::string_view path, std::string_view query)
+    {
+        if (path.size() < query.size() ||
+            path.compare(path.size() - query.size(), query.size(), query) != 0)
+            return false;
+        return path.size() == query.size() || query[0] == '/' ||
+            path[path.size() - query.size() - 1] == '/';
+    }
+
+    // Entries of a DWARF 5 directory or file name table
+    std::vector<std::pair<std::string_view, std::uint64_t>>
+    read_entry_table(DwarfReader &reader, const UnitHeader &unit,
+        const DwarfSections &sections)
+    {
+        std::uint8_t format_count = reader.read<std::uint8_t>();
+        std::vector<AttributeSpec> formats(format_count);
+        for (auto &format : formats)
+        {
+            format.name = reader.uleb();
+            format.form = reader.uleb();
+        }
+
+        std::uint64_t count = reader.uleb();
+        std::vector<std::pair<std::string_view, std::uint64_t>> entries;
+        for (std::uint64_t i = 0; i < count; i++)
+        {
+            std::pair<std::string_view, std::uint64_t> entry;
+            for (const auto &format : formats)
+            {
+                FormValue val = read_form(reader, format, unit, sections);
+                if (format.name == LNCT_path)
+                    entry.first = val.str;
+                else if (format.name == LNCT_directory_index)
+                    entry.second = val.value;
+            }
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+}
+
+LineTable::LineTable(const Elf &elf) : sections_(new DwarfSections(elf))
+{
+}
+
+LineTable::~LineTable() = default;
+
+std::size_t LineTable::unit_count()
+{
+    scan_units();
+    return units_.size();
+}
+
+std::size_t LineTable::decoded_units() const
+{
+    return std::count_if(units_.begin(), units_.end(),
+        [](const Unit &unit) { return unit.decoded; });
+}
+
+// Reads the unit DIE of every compile unit, nothing below it
+void LineTable::scan_units()
+{
+    if (scanned_)
+        return;
+    scanned_ = true;
+
+    struct Bounds
+    {
+        std::uint64_t info_offset;
+        virt_addr low;
+        virt_addr high;
+    };
+    std::vector<Bounds> bounds;
+
+    DwarfReader info(sections_->info);
+    while (info.done() == false)
+    {
+        UnitHeader header;
+        try
+        {
+            header = read_unit_header(info);
+        }
+        catch (const Error &)
+        {
+            break;
+        }
+
+        // Only the unit DIE is read, the reader moves on to the next unit
+        DwarfReader die = info;
+        info.seek(header.end);
+        try
+        {
+            if (header.unit_type != dwarf::UT_compile && header.unit_type != dwarf::UT_partial)
+                continue;
+
+            std::uint64_t code = die.uleb();
+            if (code == 0)
+                continue;
+            auto abbrevs = read_abbrevs(*sections_, header.abbrev_offset, code);
+            if (abbrevs.empty() || abbrevs.back().code != code)
+                continue;
+
+            Unit unit;
+            unit.dwarf64 = header.dwarf64;
+            unit.address_size = header.address_size;
+
+            std::optional<std::uint64_t> stmt_list;
+            virt_addr low = 0, high = 0;
+            bool high_is_offset = false;
+            for (const auto &spec : abbrevs.back().attrs)
+            {
+                FormValue val = read_form(die, spec, header, *sections_);
+                if (spec.name == dwarf::AT_stmt_list)
+                    stmt_list = val.value;
+                else if (spec.name == dwarf::AT_comp_dir)
+                    unit.comp_dir = val.str;
+                else if (spec.name == dwarf::AT_low_pc)
+                    low = val.value;
+                else if (spec.name == dwarf::AT_str_offsets_base)
+                    unit.str_offsets_base = val.value;
+                else if (spec.name == dwarf::AT_high_pc)
+                {
+                    high = val.value;
+                    high_is_offset = (spec.form != dwarf::FORM_addr);
+                }
+            }
+
+            if (!stmt_list)
+                continue;
+            unit.line_offset = *stmt_list;
+            if (high_is_offset)
+                high += low;
+
+            bounds.push_back({header.offset, low, high});
+            units_.push_back(std::move(unit));
+        }
+        catch (const Error &)
+        {
+            // A unit we cannot read leaves the rest usable
+        }
+    }
+
+    // .debug_aranges covers units whose code is not contiguous
+    std::map<std::uint64_t, std::size_t> by_offset;
+    for (std::size_t i = 0; i < bounds.size(); i++)
+        by_offset[bounds[i].info_offset] = i;
+
+    std::vector<bool> placed(units_.size(), false);
+    try
+    {
+        DwarfReader aranges(sections_->aranges);
+        while (aranges.done() == false)
+        {
+            std::size_t set_start = aranges.pos();
+            bool dwarf64 = false;
+            std::uint64_t length = aranges.initial_length(dwarf64);
+            std::size_t set_end = aranges.pos() + length;
+            aranges.read<std::uint16_t>();
+            std::uint64_t info_offset = aranges.offset(dwarf64);
+            std::uint8_t address_size = aranges.read<std::uint8_t>();
+            aranges.read<std::uint8_t>();
+
+            // Tuples are aligned to twice the address size
+            std::size_t tuple = 2 * address_size;
+            if (tuple == 0)
+                break;
+            aranges.seek(set_start + (aranges.pos() - set_start + tuple - 1) / tuple * tuple);
+
+            auto unit = by_offset.find(info_offset);
+            while (aranges.pos() + tuple <= set_end)
+            {
+                virt_addr addr = aranges.read_bytes(address_size);
+                std::uint64_t size = aranges.read_bytes(address_size);
+                if (addr == 0 && size == 0)
+                    break;
+                if (unit != by_offset.end() && addr != 0 && size != 0)
+                {
+                    ranges_.push_back({addr, addr + size, unit->second});
+                    placed[unit->second] = true;
+                }
+            }
+            aranges.seek(set_end);
+        }
+    }
+    catch (const Error &)
+    {
+        // Ranges read so far still hold
+    }
+
+    for (std::size_t i = 0; i < bounds.size(); i++)
+    {
+        if (placed[i])
+            continue;
+        if (bounds[i].low != 0 && bounds[i].high > bounds[i].low)
+            ranges_.push_back({bounds[i].low, bounds[i].high, i});
+        else
+            unplaced_.push_back(i);
+    }
+
+    std::sort(ranges_.begin(), ranges_.end(),
+        [](const Range &a, const Range &b) { return a.low < b.low; });
+}
+
+void LineTable::read_header(Unit &unit)
+{
+    if (unit.header_read)
+        return;
+    unit.header_read = true;
+
+    DwarfReader reader(sections_->line);
+    reader.seek(unit.line_offset);
+
+    Program &prog = unit.program;
+    bool dwarf64 = false;
+    std::uint64_t length = reader.initial_length(dwarf64);
+    if (length > reader.size() - reader.pos())
+        Error::send("Line program runs past its section");
+    prog.end = reader.pos() + length;
+
+    prog.version = reader.read<std::uint16_t>();
+    if (prog.version < 2 || prog.version > 5)
+        Error::send("Unsupported line table version " + std::to_string(prog.version));
+
+    UnitHeader header;
+    header.version = prog.version;
+    header.dwarf64 = dwarf64;
+    header.address_size = unit.address_size;
+    header.str_offsets_base = unit.str_offsets_base;
+    if (prog.version == 5)
+    {
+        header.address_size = reader.read<std::uint8_t>();
+        reader.read<std::uint8_t>();
+    }
+
+    std::uint64_t header_length = reader.offset(dwarf64);
+    prog.start = reader.pos() + header_length;
+    prog.min_inst_length = reader.read<std::uint8_t>();
+    if (prog.version >= 4)
+        reader.read<std::uint8_t>();
+    prog.default_is_stmt = (reader.read<std::uint8_t>() != 0);
+    prog.line_base = reader.read<std::int8_t>();
+    prog.line_range = reader.read<std::uint8_t>();
+    prog.opcode_base = reader.read<std::uint8_t>();
+    if (prog.line_range == 0 || prog.opcode_base == 0)
+        Error::send("Malformed line program header");
+
+    prog.opcode_lengths.resize(prog.opcode_base - 1);
+    for (auto &len : prog.opcode_lengths)
+        len = reader.read<std::uint8_t>();
+
+    if (prog.version == 5)
+    {
+        // Directory 0 is the compilation directory and file 0 the primary
+        // source file, both listed explicitly
+        auto dirs = read_entry_table(reader, header, *sections_);
+        auto files = read_entry_table(reader, header, *sections_);
+        std::string_view comp_dir = dirs.empty() ? unit.comp_dir : dirs[0].first;
+        for (const auto &[name, dir] : files)
+        {
+            std::string dir_path = (dir < dirs.size()) ?
+                join_path(comp_dir, dirs[dir].first) : std::string(comp_dir);
+            unit.files.push_back(join_path(dir_path, name));
+        }
+        return;
+    }
+
+    // Before version 5 directory 0 and file 0 are implied, the first
+    // listed entries are number 1
+    std::vector<std::string> dirs{std::string(unit.comp_dir)};
+    for (std::string_view dir = reader.cstr(); dir.empty() == false; dir = reader.cstr())
+        dirs.push_back(join_path(unit.comp_dir, dir));
+
+    unit.files.emplace_back();
+    for (std::string_view name = reader.cstr(); name.empty() == false; name = reader.cstr())
+    {
+        std::uint64_t dir = reader.uleb();
+        reader.uleb();
+        reader.uleb();
+        unit.files.push_back(join_path(dir < dirs.size() ? dirs[dir] : dirs[0], name));
+    }
+}
+
+void LineTable::decode(Unit &unit)
+{
+    if (unit.decoded)
+        return;
+    unit.decoded = true;
+
+    try
+    {
+        read_header(unit);
+    }
+    catch (const Error &)
+    {
+        return;
+    }
+
+    const Program &prog = unit.program;
+    DwarfReader reader(sections_->line);
+
+    virt_addr address = 0;
+    std::uint32_t file = 1, line = 1, column = 0;
+    bool is_stmt = prog.default_is_stmt, prologue_end = false;
+    std::size_t sequence_start = 0;
+
+    auto reset = [&]()
+    {
+        address = 0;
+        file = 1;
+        line = 1;
+        column = 0;
+        is_stmt = prog.default_is_stmt;
+        prologue_end = false;
+    };
+    auto emit = [&](bool end_sequence)
+    {
+        std::uint8_t flags = (is_stmt ? ROW_IS_STMT : 0) |
+            (end_sequence ? ROW_END_SEQUENCE : 0) |
+            (prologue_end ? ROW_PROLOGUE_END : 0);
+        unit.rows.push_back({address, line, file,
+            static_cast<std::uint16_t>(std::min<std::uint32_t>(column, UINT16_MAX)), flags});
+        prologue_end = false;
+    };
+
+    try
+    {
+        reader.seek(prog.start);
+        while (reader.pos() < prog.end)
+        {
+            std::uint8_t op = reader.read<std::uint8_t>();
+            if (op >= prog.opcode_base)
+            {
+                std::uint8_t adjusted = op - prog.opcode_base;
+                address += (adjusted / prog.line_range) * prog.min_inst_length;
+                line += prog.line_base + adjusted % prog.line_range;
+                emit(false);
+                continue;
+            }
+
+            switch (op)
+            {
+                case 0:
+                {
+                    std::uint64_t len = reader.uleb();
+                    if (len == 0)
+                        break;
+                    std::size_t next = reader.pos() + len;
+                    std::uint8_t sub = reader.read<std::uint8_t>();
+                    if (sub == LNE_end_sequence)
+                    {
+                        emit(true);
+
+                        // Functions the linker discarded keep address 0
+                        if (unit.rows[sequence_start].address == 0)
+                            unit.rows.resize(sequence_start);
+                        sequence_start = unit.rows.size();
+                        reset();
+                    }
+                    else if (sub == LNE_set_address)
+                        address = reader.read_bytes(static_cast<unsigned>(len - 1));
+                    reader.seek(next);
+                    break;
+                }
+                case LNS_copy:
+                    emit(false);
+                    break;
+                case LNS_advance_pc:
+                    address += reader.uleb() * prog.min_inst_length;
+                    break;
+                case LNS_advance_line:
+                    line += static_cast<std::int32_t>(reader.sleb());
+                    break;
+                case LNS_set_file:
+                    file = static_cast<std::uint32_t>(reader.uleb());
+                    break;
+                case LNS_set_column:
+                    column = static_cast<std::uint32_t>(reader.uleb());
+                    break;
+                case LNS_negate_stmt:
+                    is_stmt = !is_stmt;
+                    break;
+                case LNS_set_basic_block:
+                case LNS_set_epilogue_begin:
+                    break;
+                case LNS_const_add_pc:
+                    address += ((255 - prog.opcode_base) / prog.line_range) * prog.min_inst_length;
+                    break;
+                case LNS_fixed_advance_pc:
+                    address += reader.read<std::uint16_t>();
+                    break;
+                case LNS_set_prologue_end:
+                    prologue_end = true;
+                    break;
+                default:
+                    // Opcodes newer than us, their operands are all uleb
+                    for (std::uint8_t i = 0; i < prog.opcode_lengths[op - 1]; i++)
+                        reader.uleb();
+                    break;
+            }
+        }
+    }
+    catch (const Error &)
+    {
+        // Rows of complete sequences are kept
+    }
+    unit.rows.resize(sequence_start);
+
+    // A sequence ending where the next one starts sorts first
+    std::stable_sort(unit.rows.begin(), unit.rows.end(), [](const Row &a, const Row &b)
+    {
+        if (a.address != b.address)
+            return a.address < b.address;
+        return (a.flags & ROW_END_SEQUENCE) > (b.flags & ROW_END_SEQUENCE);
+    });
+    unit.rows.shrink_to_fit();
+}
+
+const LineTable::Row *LineTable::find_row(const Unit &unit, virt_addr address) const
+{
+    auto it = std::upper_bound(unit.rows.begin(), unit.rows.end(), address,
+        [](virt_addr addr, const Row &row) { return addr < row.address; });
+    if (it == unit.rows.begin())
+        return nullptr;
+    --it;
+    if (it->flags & ROW_END_SEQUENCE)
+        return nullptr;
+    return &*it;
+}
+
+LineEntry LineTable::make_entry(const Unit &unit, const Row &row) const
+{
+    LineEntry entry;
+    entry.address = row.address;
+    if (row.file < unit.files.size())
+        entry.file = unit.files[row.file];
+    entry.line = row.line;
+    entry.column = row.column;
+    entry.is_stmt = (row.flags & ROW_IS_STMT) != 0;
+    entry.prologue_end = (row.flags & ROW_PROLOGUE_END) != 0;
+    return entry;
+}
+
+const LineTable::Row *LineTable::locate(virt_addr address, const Unit *&found)
+{
+    scan_units();
+
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+        [](virt_addr addr, const Range &range) { return addr < range.low; });
+    while (it != ranges_.begin())
+    {
+        --it;
+        if (address >= it->high)
+            break;
+
+        Unit &unit = units_[it->unit];
+        decode(unit);
+        if (const Row *row = find_row(unit, address))
+        {
+            found = &unit;
+            return row;
+        }
+    }
+
+    for (std::size_t index : unplaced_)
+    {
+        Unit &unit = units_[index];
+        decode(unit);
+        if (const Row *row = find_row(unit, address))
+        {
+            found = &unit;
+            return row;
+        }
+    }
+    return nullptr;
+}
+
+std::optional<LineEntry> LineTable::line_at(virt_addr address)
+{
+    const Unit *unit = nullptr;
+    const Row *row = locate(address, unit);
+    if (row == nullptr)
+        return std::nullopt;
+    return make_entry(*unit, *row);
+}
+
+std::optional<std::pair<virt_addr, virt_addr>> LineTable::line_range(virt_addr address)
+{
+    const Unit *unit = nullptr;
+    const Row *row = locate(address, unit);
+    if (row == nullptr)
+        return std::nullopt;
+
+    auto same_line = [&](const Row &other)
+    {
+        return other.line == row->line && other.file == row->file;
+    };
+
+    const Row *first = unit->rows.data();
+    const Row *last = first + unit->rows.size() - 1;
+    const Row *start = row;
+    while (start != first && same_line(start[-1]) &&
+           (start[-1].flags & ROW_END_SEQUENCE) == 0)
+        --start;
+
+    // Every sequence closes with an end row, which bounds the range
+    const Row *end = row + 1;
+    while (end != last && (end->flags & ROW_END_SEQUENCE) == 0 &&
+           (same_line(*end) || (end->flags & ROW_IS_STMT) == 0))
+        ++end;
+    return std::make_pair(start->address, end->address);
+}
+
+void LineTable::build_reverse(Unit &unit)
+{
+    if (unit.reverse_built)
+        return;
+    unit.reverse_built = true;
+
+    decode(unit);
+    for (const auto &row : unit.rows)
+    {
+        if ((row.flags & ROW_IS_STMT) && (row.flags & ROW_END_SEQUENCE) == 0)
+            unit.by_line.push_back(row);
+    }
+
+    std::sort(unit.by_line.begin(), unit.by_line.end(), [](const Row &a, const Row &b)
+    {
+        if (a.file != b.file)
+            return a.file < b.file;
+        if (a.line != b.line)
+            return a.line < b.line;
+        return a.address < b.address;
+    });
+}
+
+std::vector<LineEntry> LineTable::entries_for(std::string_view file, std::uint32_t line)
+{
+    scan_units();
+
+    std::vector<LineEntry> entries;
+    if (file.empty())
+        return entries;
+
+    for (auto &unit : units_)
+    {
+        // File tables sit in the program header, units naming other
+        // files are never decoded
+        try
+        {
+            read_header(unit);
+        }
+        catch (const Error &)
+        {
+            continue;
+        }
+
+        for (std::uint32_t index = 0; index < unit.files.size(); index++)
+        {
+            if (path_matches(unit.files[index], file) == false)
+                continue;
+
+            build_reverse(unit);
+            auto first = std::lower_bound(unit.by_line.begin(), unit.by_line.end(),
+                std::make_pair(index, line), [](const Row &row, const auto &key)
+                {
+                    return std::make_pair(row.file, row.line) < key;
+                });
+            for (auto it = first; it != unit.by_line.end() &&
+                 it->file == index && it->line == line; ++it)
+                entries.push_back(make_entry(unit, *it));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const LineEntry &a, const LineEntry &b) { return a.address < b.address; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const LineEntry &a, const LineEntry &b) { return a.address == b.address; }),
+        entries.end());
+    return entries;
+}
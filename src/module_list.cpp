@@ -0,0 +1,343 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "module_list.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Offsets within the 64-bit r_debug and link_map of the loader
+    constexpr virt_addr R_MAP = 8;
+    constexpr virt_addr R_BRK = 16;
+    constexpr virt_addr R_STATE = 24;
+    constexpr std::size_t R_DEBUG_SIZE = 32;
+    constexpr std::uint32_t RT_CONSISTENT = 0;
+
+    constexpr std::size_t LINK_MAP_SIZE = 32;
+
+    // Guards against a link map that loops
+    constexpr std::size_t MAX_MODULES = 65536;
+
+    template <typename T>
+    T read_value(const Process &proc, virt_addr address)
+    {
+        auto data = proc.read_memory(address, sizeof(T));
+        T value;
+        std::memcpy(&value, data.data(), sizeof(T));
+        return value;
+    }
+
+    // NUL terminated, read up to page ends so the last page is not overrun
+    std::string read_string(const Process &proc, virt_addr address)
+    {
+        constexpr std::size_t PAGE = 4096;
+        constexpr std::size_t MAX_PATH = 4096;
+        std::string str;
+        while (str.size() < MAX_PATH)
+        {
+            std::size_t chunk = PAGE - (address & (PAGE - 1));
+            auto data = proc.read_memory(address, chunk);
+            auto end = std::find(data.begin(), data.end(), 0);
+            str.append(data.begin(), end);
+            if (end != data.end())
+                break;
+            address += chunk;
+        }
+        return str;
+    }
+
+    // DT_DEBUG of the executable, which the loader points at r_debug once
+    // it ran. AT_PHDR locates the program headers in memory
+    virt_addr dynamic_debug(const Process &proc, const AuxVector &auxv)
+    {
+        if (auxv.phdr() == 0 || auxv.phnum() == 0)
+            return 0;
+
+        auto raw = proc.read_memory(auxv.phdr(), auxv.phnum() * sizeof(Elf64_Phdr));
+        std::vector<Elf64_Phdr> phdrs(auxv.phnum());
+        std::memcpy(phdrs.data(), raw.data(), raw.size());
+
+        const Elf64_Phdr *self = nullptr, *dynamic = nullptr;
+        for (const auto &ph : phdrs)
+        {
+            if (ph.p_type == PT_PHDR)
+                self = &ph;
+            else if (ph.p_type == PT_DYNAMIC)
+                dynamic = &ph;
+        }
+        if (self == nullptr || dynamic == nullptr)
+            return 0;
+
+        virt_addr bias = auxv.phdr() - self->p_vaddr;
+        std::size_t count = dynamic->p_memsz / sizeof(Elf64_Dyn);
+        auto entries = proc.read_memory(bias + dynamic->p_vaddr, count * sizeof(Elf64_Dyn));
+        for (std::size_t i = 0; i < count; i++)
+        {
+            Elf64_Dyn dyn;
+            std::memcpy(&dyn, entries.data() + i * sizeof(dyn), sizeof(dyn));
+            if (dyn.d_tag == DT_NULL)
+                break;
+            if (dyn.d_tag == DT_DEBUG)
+                return dyn.d_un.d_ptr;
+        }
+        return 0;
+    }
+}
+
+ModuleList::~ModuleList() = default;
+
+bool ModuleList::start()
+{
+    if (active())
+        return true;
+
+    if (process_->get_state() != ProcessState::Stopped)
+        Error::send("Modules can only be tracked from a stop");
+
+    const AuxVector &auxv = process_->auxv();
+    virt_addr base = auxv.interpreter_base();
+    if (base == 0)
+        return false;
+
+    // The loader named by PT_INTERP is mapped from its start at AT_BASE
+    const Elf *exe = process_->elf();
+    if (exe == nullptr || exe->interpreter().empty())
+        Error::send("Could not find the dynamic loader of the executable");
+    Elf loader(std::string(exe->interpreter()));
+    virt_addr bias = base - loader.image_base();
+
+    virt_addr rendezvous = dynamic_debug(*process_, auxv);
+    if (rendezvous == 0)
+    {
+        auto syms = loader.symbols_by_name("_r_debug");
+        if (syms.empty())
+            Error::send("Dynamic loader has no _r_debug symbol");
+        rendezvous = syms.front()->address + bias;
+    }
+
+    // r_brk is filled in by the loader as it starts, before that the
+    // function it will hold is looked up
+    virt_addr brk = read_value<std::uint64_t>(*process_, rendezvous + R_BRK);
+    if (brk == 0)
+    {
+        auto syms = loader.symbols_by_name("_dl_debug_state");
+        if (syms.empty())
+            Error::send("Dynamic loader has no _dl_debug_state symbol");
+        brk = syms.front()->address + bias;
+    }
+
+    process_->create_breakpoint_site(brk, false, true).enable();
+    rendezvous_ = rendezvous;
+    breakpoint_ = brk;
+    update();
+    return true;
+}
+
+void ModuleList::update()
+{
+    if (active() == false)
+        return;
+
+    // Modules are only taken in while the loader has them all in place
+    auto r_debug = process_->read_memory(rendezvous_, R_DEBUG_SIZE);
+    std::uint32_t state;
+    virt_addr entry;
+    std::memcpy(&state, r_debug.data() + R_STATE, sizeof(state));
+    std::memcpy(&entry, r_debug.data() + R_MAP, sizeof(entry));
+    if (state != RT_CONSISTENT)
+        return;
+
+    std::vector<LoadedModule> current;
+    for (std::size_t i = 0; entry != 0 && i < MAX_MODULES; i++)
+    {
+        auto link = process_->read_memory(entry, LINK_MAP_SIZE);
+        virt_addr words[4];
+        std::memcpy(words, link.data(), sizeof(words));
+
+        // l_addr, l_name, l_ld and l_next, the executable has no name
+        LoadedModule module;
+        module.base = words[0];
+        module.dynamic = words[2];
+        module.link_map = entry;
+        if (words[1] != 0)
+            module.path = read_string(*process_, words[1]);
+        if (module.path.empty() == false)
+            current.push_back(std::move(module));
+        entry = words[3];
+    }
+
+    auto same = [](const LoadedModule &a, const LoadedModule &b)
+    {
+        return a.link_map == b.link_map && a.base == b.base && a.path == b.path;
+    };
+
+    for (std::size_t i = modules_.size(); i-- > 0;)
+    {
+        if (std::none_of(current.begin(), current.end(),
+                [&](const LoadedModule &mod) { return same(mod, modules_[i]); }))
+            remove_module(i);
+    }
+
+    for (auto &module : current)
+    {
+        if (std::none_of(modules_.begin(), modules_.end(),
+                [&](const LoadedModule &mod) { return same(mod, module); }))
+            add_module(std::move(module));
+    }
+}
+
+void ModuleList::add_module(LoadedModule module)
+{
+    modules_.push_back(std::move(module));
+    images_.emplace_back();
+
+    bool waiting = std::any_of(breakpoints_.begin(), breakpoints_.end(),
+        [](const PendingBreakpoint &bp) { return bp.address == 0; });
+    if (waiting == false)
+        return;
+
+    // All pending breakpoints against the one symbol index of the module
+    const LoadedModule &added = modules_.back();
+    const Elf *image = elf(added);
+    if (image == nullptr)
+        return;
+    for (auto &bp : breakpoints_)
+    {
+        if (bp.address == 0)
+            resolve(bp, added, *image);
+    }
+}
+
+void ModuleList::remove_module(std::size_t index)
+{
+    // Its code is unmapped already, the breakpoints wait for a reload
+    for (auto &bp : breakpoints_)
+    {
+        if (bp.address != 0 && bp.link_map == modules_[index].link_map)
+        {
+            process_->discard_breakpoint_site(bp.address);
+            bp.address = 0;
+            bp.link_map = 0;
+        }
+    }
+
+    modules_.erase(modules_.begin() + index);
+    images_.erase(images_.begin() + index);
+}
+
+bool ModuleList::resolve(PendingBreakpoint &bp, const LoadedModule &module, const Elf &image)
+{
+    auto syms = image.symbols_by_name(bp.symbol);
+    if (syms.empty())
+        return false;
+
+    virt_addr address = syms.front()->address + module.base;
+    if (process_->breakpoint_sites().contains_address(address) == false)
+        process_->create_breakpoint_site(address, bp.hardware).enable();
+    bp.address = address;
+    bp.link_map = module.link_map;
+    return true;
+}
+
+const Elf *ModuleList::elf(const LoadedModule &module)
+{
+    std::size_t index = &module - modules_.data();
+    if (index >= modules_.size())
+        return nullptr;
+
+    Image &image = images_[index];
+    if (image.opened == false)
+    {
+        image.opened = true;
+        try
+        {
+            image.elf = std::make_shared<Elf>(module.path);
+            image.elf->set_load_bias(module.base);
+        }
+        catch (const Error &)
+        {
+            // The vDSO and deleted files have nothing to open
+        }
+    }
+    return image.elf.get();
+}
+
+std::optional<virt_addr> ModuleList::symbol_address(std::string_view name)
+{
+    for (const auto &module : modules_)
+    {
+        const Elf *image = elf(module);
+        if (image == nullptr)
+            continue;
+
+        auto syms = image->symbols_by_name(name);
+        if (syms.empty() == false)
+            return syms.front()->address + module.base;
+    }
+    return std::nullopt;
+}
+
+const PendingBreakpoint &ModuleList::add_breakpoint(std::string symbol, bool hardware)
+{
+    breakpoints_.push_back({std::move(symbol), hardware, 0, 0});
+    PendingBreakpoint &bp = breakpoints_.back();
+    for (const auto &module : modules_)
+    {
+        const Elf *image = elf(module);
+        if (image != nullptr && resolve(bp, module, *image))
+            break;
+    }
+    return bp;
+}
+
+void ModuleList::forget()
+{
+    for (auto &bp : breakpoints_)
+    {
+        if (bp.address != 0)
+            process_->discard_breakpoint_site(bp.address);
+        bp.address = 0;
+        bp.link_map = 0;
+    }
+
+    if (breakpoint_ != 0)
+        process_->discard_breakpoint_site(breakpoint_);
+    rendezvous_ = 0;
+    breakpoint_ = 0;
+    modules_.clear();
+    images_.clear();
+}
+
+void ModuleList::inherit(const ModuleList &parent)
+{
+    rendezvous_ = parent.rendezvous_;
+    breakpoint_ = parent.breakpoint_;
+    modules_ = parent.modules_;
+    images_ = parent.images_;
+    breakpoints_ = parent.breakpoints_;
+}
@@ -0,0 +1,263 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "perf_sampler.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace
+{
+    // Ring buffer pages per thread, must be a power of two
+    constexpr std::size_t RING_PAGES = 64;
+
+    int perf_event_open(perf_event_attr *attr, pid_t tid)
+    {
+        return static_cast<int>(syscall(SYS_perf_event_open, attr, tid, -1, -1,
+            PERF_FLAG_FD_CLOEXEC));
+    }
+
+    // Callchains carry markers for the context switches between frames
+    bool is_context_marker(std::uint64_t ip)
+    {
+        return ip >= static_cast<std::uint64_t>(PERF_CONTEXT_MAX);
+    }
+}
+
+PerfSampler::PerfSampler(const Process &proc, std::uint64_t frequency)
+{
+    if (frequency == 0)
+        Error::send("Sampling frequency must be positive");
+
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0)
+        Error::send_errno("Failed to retrieve page size");
+    page_size_ = static_cast<std::size_t>(page);
+    data_size_ = RING_PAGES * page_size_;
+
+    try
+    {
+        for (const auto &[tid, thread] : proc.threads())
+            open_thread(tid, frequency);
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+
+    if (buffers_.empty())
+        Error::send("No thread of the process could be sampled");
+}
+
+PerfSampler::~PerfSampler()
+{
+    release();
+}
+
+void PerfSampler::release()
+{
+    for (Buffer &buf : buffers_)
+    {
+        if (buf.base)
+            munmap(buf.base, page_size_ + data_size_);
+        if (buf.fd >= 0)
+            close(buf.fd);
+    }
+    buffers_.clear();
+}
+
+void PerfSampler::open_thread(pid_t tid, std::uint64_t frequency)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = frequency;
+    attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+
+    // Woken up once half the ring is filled
+    attr.watermark = 1;
+    attr.wakeup_watermark = static_cast<std::uint32_t>(data_size_ / 2);
+
+    Buffer buf;
+    buf.tid = tid;
+    buf.fd = perf_event_open(&attr, tid);
+    if (buf.fd < 0)
+    {
+        // The thread is already gone
+        if (errno == ESRCH)
+            return;
+        Error::send_errno("perf_event_open failed for thread " + std::to_string(tid));
+    }
+
+    void *base = mmap(nullptr, page_size_ + data_size_, PROT_READ | PROT_WRITE,
+        MAP_SHARED, buf.fd, 0);
+    if (base == MAP_FAILED)
+    {
+        int err = errno;
+        close(buf.fd);
+        errno = err;
+        Error::send_errno("Failed to map perf ring buffer");
+    }
+
+    buf.base = static_cast<std::uint8_t *>(base);
+    buffers_.push_back(buf);
+}
+
+void PerfSampler::set_enabled(bool enable)
+{
+    unsigned long request = enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE;
+    for (Buffer &buf : buffers_)
+        ioctl(buf.fd, request, 0);
+}
+
+void PerfSampler::run_for(std::chrono::milliseconds duration)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<pollfd> fds;
+    for (Buffer &buf : buffers_)
+        fds.push_back({buf.fd, POLLIN, 0});
+
+    auto deadline = clock::now() + duration;
+    set_enabled(true);
+    while (true)
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - clock::now());
+        if (left.count() <= 0)
+            break;
+
+        int ret = poll(fds.data(), fds.size(), static_cast<int>(left.count()));
+        if (ret < 0 && errno != EINTR)
+        {
+            set_enabled(false);
+            Error::send_errno("Failed to poll perf events");
+        }
+
+        for (Buffer &buf : buffers_)
+            drain(buf);
+    }
+    set_enabled(false);
+
+    for (Buffer &buf : buffers_)
+        drain(buf);
+}
+
+void PerfSampler::copy_out(const Buffer &buf, std::uint64_t offset,
+    void *dest, std::size_t size) const
+{
+    const std::uint8_t *data = buf.base + page_size_;
+    std::size_t start = static_cast<std::size_t>(offset & (data_size_ - 1));
+    std::size_t first = std::min(size, data_size_ - start);
+
+    // A record may wrap around the end of the ring
+    auto *out = static_cast<std::uint8_t *>(dest);
+    std::memcpy(out, data + start, first);
+    std::memcpy(out + first, data, size - first);
+}
+
+void PerfSampler::drain(Buffer &buf)
+{
+    auto *meta = reinterpret_cast<perf_event_mmap_page *>(buf.base);
+    std::uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    std::uint64_t tail = meta->data_tail;
+
+    std::vector<std::uint8_t> record;
+    while (tail < head)
+    {
+        perf_event_header header;
+        copy_out(buf, tail, &header, sizeof(header));
+        if (header.size < sizeof(header))
+            break;
+
+        record.resize(header.size);
+        copy_out(buf, tail, record.data(), header.size);
+        tail += header.size;
+
+        const std::uint8_t *body = record.data() + sizeof(header);
+        std::size_t body_size = header.size - sizeof(header);
+        if (header.type == PERF_RECORD_SAMPLE)
+        {
+            record_sample(body, body_size);
+        }
+        else if (header.type == PERF_RECORD_LOST && body_size >= 16)
+        {
+            std::uint64_t lost = 0;
+            std::memcpy(&lost, body + 8, sizeof(lost));
+            lost_ += lost;
+        }
+    }
+
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+// Laid out as ip, pid and tid, then the callchain length and frames
+void PerfSampler::record_sample(const std::uint8_t *data, std::size_t size)
+{
+    constexpr std::size_t fixed = sizeof(std::uint64_t) * 3;
+    if (size < fixed)
+        return;
+
+    std::uint64_t ip = 0;
+    std::uint64_t nr = 0;
+    std::memcpy(&ip, data, sizeof(ip));
+    std::memcpy(&nr, data + 16, sizeof(nr));
+    nr = std::min<std::uint64_t>(nr, (size - fixed) / sizeof(std::uint64_t));
+
+    std::vector<virt_addr> chain;
+    chain.reserve(nr);
+    for (std::uint64_t i = 0; i < nr; i++)
+    {
+        std::uint64_t frame = 0;
+        std::memcpy(&frame, data + fixed + i * sizeof(frame), sizeof(frame));
+        if (is_context_marker(frame) == false)
+            chain.push_back(frame);
+    }
+    if (chain.empty())
+        chain.push_back(ip);
+
+    samples_++;
+    stacks_[chain]++;
+    if (ip != 0)
+    {
+        bool inserted = false;
+        histogram_.find_or_insert(ip, inserted).count++;
+    }
+}
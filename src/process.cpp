@@ -27,16 +27,55 @@
 #include "error.hpp"
 
 #include <csignal>
+#include <climits>
 #include <string>
 #include <charconv>
+#include <chrono>
 #include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <map>
 #include <unistd.h>
+#include <sys/syscall.h>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
 #include <sys/personality.h>
+#include <sys/prctl.h>
 #include <sys/user.h>
 #include <sys/uio.h>      // Required for iovec
 #include <elf.h>          // Required for NT_PRSTATUS
+#include <linux/seccomp.h>
+
+namespace
+{
+    RegisterID register_offset_id(RegisterID base, std::size_t index)
+    {
+        return static_cast<RegisterID>(static_cast<std::size_t>(base) + index);
+    }
+
+    RegisterID gpr_id(std::size_t index)
+    {
+        return register_offset_id(RegisterID::REG64_X0, index);
+    }
+
+    // Wait statuses reaped before their thread was known or asked for,
+    // tracees belong to the thread that attached them hence thread_local
+    thread_local std::map<pid_t, int> stray_statuses;
+
+    // New threads, forked children and exec of a tracee all report to us,
+    // so do calls a seccomp filter traces
+    constexpr long trace_options = PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK |
+        PTRACE_O_TRACEVFORK | PTRACE_O_TRACEVFORKDONE | PTRACE_O_TRACEEXEC |
+        PTRACE_O_TRACESECCOMP | PTRACE_O_TRACESYSGOOD;
+
+    std::string read_exe_path(pid_t pid)
+    {
+        std::error_code ec;
+        auto path = std::filesystem::read_symlink(
+            "/proc/" + std::to_string(pid) + "/exe", ec);
+        return ec ? std::string() : path.string();
+    }
+}
 
 void exit_with_perror(Pipe &pipe, std::string_view prefix)
 {
@@ -67,14 +106,37 @@ Process::~Process()
         state_ == ProcessState::Terminated)
         return;
 
-    if (state_ == ProcessState::Running)
+    if (running_threads().empty() == false)
     {
-        kill(pid_, SIGSTOP);
-        waitpid(pid_, &status, 0);
-        state_ = ProcessState::Stopped;
+        try
+        {
+            stop_other_threads(0);
+        }
+        catch (...)
+        {
+            // Detach whatever could be halted
+        }
     }
+    state_ = ProcessState::Stopped;
 
-    ptrace(PTRACE_DETACH, pid_, nullptr, nullptr);
+    // Give scratch pages back to a tracee that outlives us
+    if (kill_on_end_ == false && scratch_->empty() == false)
+    {
+        try
+        {
+            get_registers();
+            scratch_->release();
+        }
+        catch (...)
+        {
+            // Nothing sensible left to do while tearing down
+        }
+    }
+
+    for (auto &[tid, thread] : threads_)
+    {
+        ptrace(PTRACE_DETACH, tid, nullptr, nullptr);
+    }
     kill(pid_, SIGCONT);
     state_ = ProcessState::Running;
 
@@ -86,37 +148,849 @@ Process::~Process()
     }
 }
 
-std::uint8_t Process::wait()
+ThreadState &Process::add_thread(pid_t tid)
+{
+    ThreadState thread;
+    thread.tid = tid;
+    thread.regs.reset(new Registers(*this));
+    return threads_.insert_or_assign(tid, std::move(thread)).first->second;
+}
+
+void Process::set_trace_options(pid_t tid)
+{
+    if (ptrace(PTRACE_SETOPTIONS, tid, nullptr, trace_options) < 0)
+    {
+        Error::send_errno("Failed to set trace options");
+    }
+}
+
+void Process::attach_threads()
+{
+    // Seized threads got their options with PTRACE_SEIZE
+    if (seized_ == false)
+        set_trace_options(pid_);
+
+    // Threads spawned while we attach are picked up by the next scan
+    std::string task_dir = "/proc/" + std::to_string(pid_) + "/task";
+    bool found = true;
+    while (found)
+    {
+        found = false;
+        for (const auto &entry : std::filesystem::directory_iterator(task_dir))
+        {
+            pid_t tid = std::stoi(entry.path().filename().string());
+            if (threads_.count(tid) != 0)
+                continue;
+
+            if (seized_)
+            {
+                // EPERM means a seized thread cloned it, its event adds it
+                if (ptrace(PTRACE_SEIZE, tid, nullptr, trace_options) < 0)
+                {
+                    if (errno == ESRCH || errno == EPERM)
+                        continue;
+                    Error::send_errno("Failed to seize thread " + std::to_string(tid));
+                }
+
+                add_thread(tid).state = ProcessState::Running;
+                found = true;
+                continue;
+            }
+
+            if (ptrace(PTRACE_ATTACH, tid, nullptr, nullptr) < 0)
+            {
+                if (errno == ESRCH)
+                    continue;
+                Error::send_errno("Failed to attach thread " + std::to_string(tid));
+            }
+
+            int status = 0;
+            wait_thread(tid, status);
+            if (WIFSTOPPED(status) == false)
+                continue;
+
+            ThreadState &thread = add_thread(tid);
+            if (WSTOPSIG(status) != SIGSTOP)
+            {
+                // Attach stop is still queued behind a real signal
+                thread.expect_stop = true;
+                thread.pending_status = status;
+            }
+            set_trace_options(tid);
+            found = true;
+        }
+    }
+}
+
+void Process::wait_thread(pid_t tid, int &status)
+{
+    auto stray = stray_statuses.find(tid);
+    if (stray != stray_statuses.end())
+    {
+        status = stray->second;
+        stray_statuses.erase(stray);
+        return;
+    }
+
+    while (waitpid(tid, &status, __WALL) < 0)
+    {
+        if (errno != EINTR)
+            Error::send_errno("waitpid() failed");
+    }
+}
+
+pid_t Process::adopt_clone(pid_t parent)
+{
+    unsigned long msg = 0;
+    if (ptrace(PTRACE_GETEVENTMSG, parent, nullptr, &msg) < 0)
+    {
+        Error::send_errno("Failed to read clone event");
+    }
+
+    // New threads start with a SIGSTOP, which may have been reaped already
+    pid_t tid = static_cast<pid_t>(msg);
+    int status = 0;
+    wait_thread(tid, status);
+    if (WIFSTOPPED(status) == false)
+        return 0;
+
+    add_thread(tid);
+
+    // Debug registers are not inherited across clone
+    auto &bp = debug_state_->in_use_hwbp_;
+    auto &wp = debug_state_->in_use_hwwp_;
+    if (std::find(std::begin(bp), std::end(bp), true) != std::end(bp))
+        write_debug_state(tid, NT_ARM_HW_BREAK);
+    if (std::find(std::begin(wp), std::end(wp), true) != std::end(wp))
+        write_debug_state(tid, NT_ARM_HW_WATCH);
+
+    return tid;
+}
+
+void Process::adopt_fork(pid_t parent, bool vfork)
 {
+    unsigned long msg = 0;
+    if (ptrace(PTRACE_GETEVENTMSG, parent, nullptr, &msg) < 0)
+    {
+        Error::send_errno("Failed to read fork event");
+    }
+
+    // Forked children start stopped and traced with our options
+    pid_t pid = static_cast<pid_t>(msg);
     int status = 0;
-    std::uint8_t info = 0;
-    if (waitpid(pid_, &status, 0) < 0)
+    wait_thread(pid, status);
+    if (WIFSTOPPED(status) == false)
+        return;
+
+    std::unique_ptr<Process> child(new Process(pid, kill_on_end_));
+    child->seized_ = seized_;
+    child->non_stop_ = non_stop_;
+    child->state_ = ProcessState::Stopped;
+    child->exe_path_ = exe_path_;
+    child->signal_policies_ = signal_policies_;
+    child->get_registers();
+
+    // Software breakpoints came along with the copied memory, ids are
+    // kept so a breakpoint means the same thing in every process
+    std::vector<BreakpointSite *> hardware;
+    breakpoint_sites_.for_each([&](BreakpointSite &site)
     {
-        Error::send_errno("waitpid() failed");
+        BreakpointSite &copy = child->create_breakpoint_site(
+            site.address(), site.is_hardware(), site.is_internal());
+        copy.id_ = site.id_;
+        copy.saved_data_ = site.saved_data_;
+        copy.is_enabled_ = site.is_enabled() && site.is_hardware() == false;
+        if (site.is_enabled() && site.is_hardware())
+            hardware.push_back(&copy);
+    });
+
+    if (fork_handler_)
+    {
+        child->modules_->inherit(*modules_);
+        child->syscalls_->inherit(*syscalls_);
+
+        // Debug registers are not inherited across fork
+        for (BreakpointSite *copy : hardware)
+            copy->enable();
+        fork_handler_(std::move(child));
+        return;
+    }
+
+    if (vfork)
+    {
+        // The child borrows our memory until it execs or exits, it must
+        // not trip over breakpoints nobody is going to handle
+        child->breakpoint_sites_.for_each([](BreakpointSite &copy)
+        {
+            copy.is_enabled_ = false;
+        });
+        lift_software_sites(parent);
+    }
+    else
+    {
+        child->breakpoint_sites_.for_each([](BreakpointSite &copy)
+        {
+            copy.disable();
+        });
+    }
+
+    // Destructor detaches from the child and lets it run
+    child->kill_on_end_ = false;
+}
+
+bool Process::handle_ptrace_event(ThreadState &thread, int status, bool resume_new)
+{
+    // Only asked for to see a traced system call return
+    if ((status >> 16) == 0 && WSTOPSIG(status) == (SIGTRAP | 0x80))
+    {
+        syscalls_->leave(thread);
+        return true;
     }
 
+    switch (status >> 16)
+    {
+        case PTRACE_EVENT_SECCOMP:
+            syscalls_->enter(thread);
+            return true;
+        case PTRACE_EVENT_CLONE:
+        {
+            pid_t child = adopt_clone(thread.tid);
+            if (child != 0 && resume_new)
+                resume_thread(threads_.at(child));
+            return true;
+        }
+        case PTRACE_EVENT_FORK:
+        case PTRACE_EVENT_VFORK:
+            adopt_fork(thread.tid, (status >> 16) == PTRACE_EVENT_VFORK);
+            return true;
+        case PTRACE_EVENT_VFORK_DONE:
+        {
+            std::vector<BreakpointSite *> sites;
+            for (virt_addr addr : lifted_sites_)
+            {
+                if (breakpoint_sites_.enabled_stoppoint_at_address(addr))
+                    sites.push_back(&breakpoint_sites_.get_by_address(addr));
+            }
+            lifted_sites_.clear();
+            rearm_software_sites(thread.tid, sites);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void Process::lift_software_sites(pid_t tid)
+{
+    breakpoint_sites_.for_each([&](BreakpointSite &site)
+    {
+        if (site.is_enabled() == false || site.is_hardware())
+            return;
+
+        if (ptrace(PTRACE_POKEDATA, tid, site.address(), site.saved_data_) < 0)
+        {
+            Error::send_errno("Failed to lift breakpoint site");
+        }
+        lifted_sites_.push_back(site.address());
+    });
+}
+
+// Arms software breakpoints reading all original words with one vectored
+// read, a site whose instruction changed underneath is left disabled
+void Process::rearm_software_sites(pid_t tid, std::vector<BreakpointSite *> sites)
+{
+    if (sites.empty())
+        return;
+
+    // Ascending order lets each word write fix up the previous one
+    std::sort(sites.begin(), sites.end(),
+        [](const BreakpointSite *a, const BreakpointSite *b)
+        { return a->address() < b->address(); });
+
+    std::vector<std::uint64_t> words(sites.size());
+    std::vector<bool> readable(sites.size(), true);
+    std::size_t done = 0;
+    while (done < sites.size())
+    {
+        std::size_t count = std::min<std::size_t>(sites.size() - done, IOV_MAX);
+        std::vector<iovec> remote(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            remote[i].iov_base = reinterpret_cast<void *>(sites[done + i]->address());
+            remote[i].iov_len = sizeof(std::uint64_t);
+        }
+
+        iovec local;
+        local.iov_base = &words[done];
+        local.iov_len = count * sizeof(std::uint64_t);
+        ssize_t got = process_vm_readv(pid_, &local, 1, remote.data(), count, 0);
+        std::size_t whole = (got < 0) ? 0 : got / sizeof(std::uint64_t);
+        done += whole;
+        if (whole == count)
+            continue;
+
+        // The read stops at the first failing site, ptrace may still see it
+        errno = 0;
+        words[done] = ptrace(PTRACE_PEEKDATA, tid, sites[done]->address(), nullptr);
+        readable[done] = (errno == 0);
+        done++;
+    }
+
+    for (std::size_t i = 0; i < sites.size(); i++)
+    {
+        BreakpointSite &site = *sites[i];
+        site.is_enabled_ = false;
+        if (readable[i] == false ||
+            (words[i] & 0xFFFFFFFF) != (site.saved_data_ & 0xFFFFFFFF))
+            continue;
+
+        site.saved_data_ = words[i];
+        std::uint64_t data = (words[i] & 0xFFFFFFFF00000000LL) | 0xD4200000LL;
+        if (ptrace(PTRACE_POKEDATA, tid, site.address(), data) < 0)
+        {
+            Error::send_errno("Failed to enable breakpoint site");
+        }
+        site.is_enabled_ = true;
+    }
+}
+
+// Runs at the exec stop, only the leader survives an exec and the new
+// image starts without our breakpoints, scratch pages or debug registers
+void Process::handle_exec()
+{
+    for (auto it = threads_.begin(); it != threads_.end();)
+    {
+        if (it->first != pid_)
+            it = threads_.erase(it);
+        else
+            ++it;
+    }
+    current_tid_ = pid_;
+    reg_state_ = threads_.at(pid_).regs.get();
+
+    // Module sites go before any site is re-armed, the loader moves
+    bool tracking = modules_->active();
+    modules_->forget();
+    scratch_->forget();
+    unwinder_->forget();
+    index_.reset();
+    lines_.reset();
+    elf_.reset();
+    auxv_.reset();
+    elf_loaded_ = false;
+    lifted_sites_.clear();
+
+    std::string previous = exe_path_;
+    exe_path_ = read_exe_path(pid_);
+    bool same_image = (exe_path_ == previous);
+
+    std::vector<BreakpointSite *> sites;
+    breakpoint_sites_.for_each([&](BreakpointSite &site)
+    {
+        if (site.is_enabled() && site.is_hardware() == false && same_image)
+            sites.push_back(&site);
+
+        if (site.is_hardware() == false || same_image == false)
+        {
+            site.is_enabled_ = false;
+            site.hw_register_ind_ = -1;
+        }
+    });
+
+    if (debug_state_valid_)
+    {
+        if (same_image)
+        {
+            write_debug_state(pid_, NT_ARM_HW_BREAK);
+            write_debug_state(pid_, NT_ARM_HW_WATCH);
+        }
+        else
+        {
+            // Slots are read back from the now clean thread when needed
+            std::fill(std::begin(debug_state_->in_use_hwbp_),
+                std::end(debug_state_->in_use_hwbp_), false);
+            std::fill(std::begin(debug_state_->in_use_hwwp_),
+                std::end(debug_state_->in_use_hwwp_), false);
+            debug_state_valid_ = false;
+        }
+    }
+
+    // Sites at addresses the new image changed stay disabled
+    rearm_software_sites(pid_, sites);
+
+    if (tracking)
+    {
+        try
+        {
+            modules_->start();
+        }
+        catch (const Error &)
+        {
+            // The new image is debugged without its modules
+        }
+    }
+}
+
+void Process::resume_thread(ThreadState &thread)
+{
+    // A held back signal goes in unless its policy changed meanwhile
+    int signo = thread.pending_signal;
+    thread.pending_signal = 0;
+    if (signo != 0 && signal_policies_[signo].pass == false)
+        signo = 0;
+
+    auto request = thread.syscall_exit ? PTRACE_SYSCALL : PTRACE_CONT;
+    if (ptrace(request, thread.tid, nullptr, signo) < 0)
+    {
+        // A thread killed under us is reaped by the next wait
+        if (errno != ESRCH)
+            Error::send_errno("ptrace(PTRACE_CONT) failed");
+    }
+    thread.state = ProcessState::Running;
+}
+
+int Process::single_step_thread(ThreadState &thread)
+{
+    int status = 0;
+    while (true)
+    {
+        if (ptrace(PTRACE_SINGLESTEP, thread.tid, nullptr, nullptr) < 0)
+        {
+            Error::send_errno("Could not single step");
+        }
+
+        thread.state = ProcessState::Running;
+        wait_thread(thread.tid, status);
+        if (WIFSTOPPED(status) == false)
+            return status;
+
+        thread.state = ProcessState::Stopped;
+        thread.regs_valid = false;
+
+        // Stepping over clone leaves the new thread halted with the rest
+        if (handle_ptrace_event(thread, status, false))
+            continue;
+
+        if (is_requested_stop(thread, status))
+        {
+            thread.expect_stop = false;
+            continue;
+        }
+
+        // The step is taken again, the signal waits for the next resume
+        if (absorb_signal(thread, status))
+            continue;
+
+        return status;
+    }
+}
+
+bool Process::is_requested_stop(const ThreadState &thread, int status) const
+{
+    if (thread.expect_stop == false)
+        return false;
+
+    if (seized_)
+        return (status >> 16) == PTRACE_EVENT_STOP;
+
+    return WSTOPSIG(status) == SIGSTOP;
+}
+
+bool Process::absorb_signal(ThreadState &thread, int status)
+{
+    // Traps and events are ours, only a signal on its way is looked up
+    int signo = WSTOPSIG(status);
+    if ((status >> 16) != 0 || signo == SIGTRAP || signo == (SIGTRAP | 0x80))
+        return false;
+
+    const SignalPolicy &policy = signal_policies_[signo];
+    if (policy.stop)
+        return false;
+
+    if (policy.pass)
+        thread.pending_signal = signo;
+    if (policy.print && signal_observer_)
+        signal_observer_(thread.tid, signo);
+    return true;
+}
+
+std::array<SignalPolicy, NSIG> Process::default_signal_policies()
+{
+    std::array<SignalPolicy, NSIG> policies;
+    policies[SIGTRAP] = {true, true, false};
+    policies[SIGSTOP] = {true, true, false};
+    policies[SIGINT] = {true, true, false};
+
+    // Routine traffic of most programs, stopping on it gets nowhere
+    for (int signo : {SIGALRM, SIGURG, SIGCHLD, SIGWINCH, SIGIO, SIGVTALRM, SIGPROF})
+        policies[signo] = {false, false, true};
+    return policies;
+}
+
+void Process::set_signal_policy(int signo, SignalPolicy policy)
+{
+    if (signo <= 0 || signo >= NSIG)
+        Error::send("Invalid signal " + std::to_string(signo));
+
+    if ((signo == SIGTRAP || signo == SIGSTOP) && (policy.stop == false || policy.pass))
+        Error::send(std::string(signo == SIGTRAP ? "SIGTRAP" : "SIGSTOP") + " is used by the debugger");
+
+    signal_policies_[signo] = policy;
+}
+
+const SignalPolicy &Process::signal_policy(int signo) const
+{
+    if (signo <= 0 || signo >= NSIG)
+        Error::send("Invalid signal " + std::to_string(signo));
+
+    return signal_policies_[signo];
+}
+
+std::vector<pid_t> Process::running_threads() const
+{
+    std::vector<pid_t> running;
+    for (const auto &[tid, thread] : threads_)
+    {
+        if (thread.state == ProcessState::Running)
+            running.push_back(tid);
+    }
+    return running;
+}
+
+void Process::resume_halted(const std::vector<pid_t> &tids)
+{
+    for (pid_t tid : tids)
+    {
+        auto it = threads_.find(tid);
+        if (it == threads_.end())
+            continue;
+
+        ThreadState &thread = it->second;
+        if (thread.state == ProcessState::Stopped && !thread.pending_status)
+            resume_thread(thread);
+    }
+}
+
+void Process::stop_other_threads(pid_t except)
+{
+    std::vector<pid_t> signalled;
+    for (auto &[tid, thread] : threads_)
+    {
+        if (tid == except || thread.state != ProcessState::Running)
+            continue;
+
+        long ret = seized_ ?
+            ptrace(PTRACE_INTERRUPT, tid, nullptr, nullptr) :
+            syscall(SYS_tgkill, pid_, tid, SIGSTOP);
+        if (ret == 0)
+        {
+            thread.expect_stop = true;
+            signalled.push_back(tid);
+        }
+    }
+
+    for (pid_t tid : signalled)
+    {
+        int status = 0;
+        wait_thread(tid, status);
+
+        ThreadState &thread = threads_.at(tid);
+        if (WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            if (tid != pid_)
+                threads_.erase(tid);
+            else
+                stray_statuses[tid] = status;
+            continue;
+        }
+
+        thread.state = ProcessState::Stopped;
+        thread.regs_valid = false;
+
+        // Our stop request stays due behind these and is swallowed later
+        if (handle_ptrace_event(thread, status, false))
+            continue;
+
+        if (is_requested_stop(thread, status))
+        {
+            thread.expect_stop = false;
+        }
+        else if (absorb_signal(thread, status) == false)
+        {
+            thread.pending_status = status;
+        }
+    }
+}
+
+std::vector<pid_t> Process::halt_threads()
+{
+    std::vector<pid_t> stopped;
+    for (const auto &[tid, thread] : threads_)
+    {
+        if (thread.state == ProcessState::Stopped)
+            stopped.push_back(tid);
+    }
+
+    stop_other_threads(0);
+
+    // Threads cloned meanwhile are adopted halted and released as well
+    std::vector<pid_t> halted;
+    for (const auto &[tid, thread] : threads_)
+    {
+        if (thread.state == ProcessState::Stopped &&
+            std::find(stopped.begin(), stopped.end(), tid) == stopped.end())
+            halted.push_back(tid);
+    }
+    return halted;
+}
+
+void Process::release_threads(const std::vector<pid_t> &tids)
+{
+    resume_halted(tids);
+}
+
+FrameRegisters Process::frame_registers(pid_t tid)
+{
+    auto it = threads_.find(tid);
+    if (it == threads_.end())
+        Error::send("No such thread " + std::to_string(tid));
+
+    ThreadState &thread = it->second;
+    if (thread.state != ProcessState::Stopped)
+        Error::send("Thread " + std::to_string(tid) + " is not stopped");
+
+    if (thread.regs_valid == false)
+        get_gprs(thread);
+
+    Registers &regs = *thread.regs;
+    FrameRegisters frame;
+    frame.pc = regs.read<std::uint64_t>(RegisterID::REG64_PC);
+    frame.sp = regs.read<std::uint64_t>(RegisterID::REG64_SP);
+    frame.fp = regs.read<std::uint64_t>(RegisterID::REG64_X29);
+    frame.lr = regs.read<std::uint64_t>(RegisterID::REG64_X30);
+    return frame;
+}
+
+void Process::select_thread(pid_t tid)
+{
+    auto it = threads_.find(tid);
+    if (it == threads_.end())
+    {
+        Error::send("No such thread " + std::to_string(tid));
+    }
+
+    // Only non-stop mode has running threads next to stopped ones
+    ThreadState &thread = it->second;
+    if (thread.state != ProcessState::Stopped && non_stop_ == false)
+    {
+        Error::send("Thread " + std::to_string(tid) + " is not stopped");
+    }
+
+    current_tid_ = tid;
+    reg_state_ = thread.regs.get();
+    if (thread.state != ProcessState::Stopped)
+    {
+        state_ = thread.state;
+        return;
+    }
+
+    state_ = ProcessState::Stopped;
+    if (thread.regs_valid == false)
+    {
+        get_registers(thread);
+    }
+}
+
+std::uint8_t Process::report_stop(pid_t tid, int status)
+{
+    // Other threads are gone after an exec, so it is dealt with first
+    bool exec = ((status >> 16) == PTRACE_EVENT_EXEC);
+    if (exec)
+        handle_exec();
+
+    if (non_stop_ == false)
+        stop_other_threads(tid);
+
+    // Interrupt stops of seized threads read like the SIGSTOP ones
+    ThreadState &thread = threads_.at(tid);
+    thread.state = ProcessState::Stopped;
+    thread.stop_info = WSTOPSIG(status);
+    if ((status >> 16) == PTRACE_EVENT_STOP && thread.stop_info == SIGTRAP)
+        thread.stop_info = SIGSTOP;
+    thread.reason = exec ? StopReason::Exec : StopReason::Signal;
+    if ((status >> 16) == 0 && thread.stop_info < NSIG &&
+        signal_policies_[thread.stop_info].pass)
+        thread.pending_signal = thread.stop_info;
+    state_ = ProcessState::Stopped;
+    select_thread(tid);
+
+    return thread.stop_info;
+}
+
+std::uint8_t Process::report_exit(int status)
+{
+    std::uint8_t info = 0;
     if (WIFEXITED(status))
     {
         state_ = ProcessState::Exited;
         info = WEXITSTATUS(status);
     }
-    else if (WIFSIGNALED(status))
+    else
     {
         state_ = ProcessState::Terminated;
         info = WTERMSIG(status);
     }
-    else if (WIFSTOPPED(status))
+
+    for (auto &[tid, thread] : threads_)
     {
-        state_ = ProcessState::Stopped;
-        info = WSTOPSIG(status);
+        thread.state = state_;
     }
 
-    if (state_ == ProcessState::Stopped)
+    return info;
+}
+
+std::optional<std::uint8_t> Process::wait_for_event(bool block)
+{
+    // Stops collected while halting threads are reported before running
+    for (auto &[tid, thread] : threads_)
     {
-        get_registers();
+        if (thread.pending_status && (state_ == ProcessState::Running || non_stop_))
+        {
+            int status = *thread.pending_status;
+            thread.pending_status.reset();
+            return report_stop(tid, status);
+        }
     }
 
-    return info;
+    int options = __WALL | __WNOTHREAD | (block ? 0 : WNOHANG);
+    while (true)
+    {
+        int status = 0;
+        pid_t tid = 0;
+
+        auto stray = std::find_if(stray_statuses.begin(), stray_statuses.end(),
+            [&](const auto &entry) { return threads_.count(entry.first) != 0; });
+        if (stray != stray_statuses.end())
+        {
+            tid = stray->first;
+            status = stray->second;
+            stray_statuses.erase(stray);
+        }
+        else
+        {
+            tid = waitpid(-1, &status, options);
+            if (tid < 0 && errno == EINTR)
+                continue;
+            if (tid < 0)
+                Error::send_errno("waitpid() failed");
+            if (tid == 0)
+                return std::nullopt;
+        }
+
+        auto it = threads_.find(tid);
+        if (it == threads_.end())
+        {
+            // New threads may report before the clone event of their parent
+            stray_statuses[tid] = status;
+            continue;
+        }
+
+        ThreadState &thread = it->second;
+        if (WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            if (tid == pid_)
+                return report_exit(status);
+
+            if (current_tid_ == tid)
+            {
+                current_tid_ = pid_;
+                reg_state_ = threads_.at(pid_).regs.get();
+                state_ = threads_.at(pid_).state;
+            }
+            threads_.erase(it);
+            continue;
+        }
+
+        thread.state = ProcessState::Stopped;
+        thread.regs_valid = false;
+
+        if (handle_ptrace_event(thread, status, true))
+        {
+            resume_thread(thread);
+            continue;
+        }
+
+        if (is_requested_stop(thread, status))
+        {
+            thread.expect_stop = false;
+            resume_thread(thread);
+            continue;
+        }
+
+        if (absorb_signal(thread, status))
+        {
+            resume_thread(thread);
+            continue;
+        }
+
+        if (is_rendezvous_stop(thread, status))
+        {
+            if (pass_rendezvous(thread))
+                continue;
+
+            // Another stop came up while stepping off r_brk
+            status = *thread.pending_status;
+            thread.pending_status.reset();
+        }
+
+        return report_stop(tid, status);
+    }
+}
+
+std::uint8_t Process::wait()
+{
+    return *wait_for_event(true);
+}
+
+std::optional<std::uint8_t> Process::try_wait()
+{
+    return wait_for_event(false);
+}
+
+void Process::interrupt()
+{
+    if (state_ != ProcessState::Running)
+        Error::send("Process is not running");
+
+    // Reported as a SIGSTOP stop, which resume() then suppresses
+    long ret = seized_ ?
+        ptrace(PTRACE_INTERRUPT, current_tid_, nullptr, nullptr) :
+        syscall(SYS_tgkill, pid_, current_tid_, SIGSTOP);
+    if (ret < 0)
+    {
+        Error::send_errno("Failed to interrupt process");
+    }
+}
+
+void Process::set_non_stop(bool enable)
+{
+    // Leaving non-stop mode brings back all-stop right away
+    if (enable == false && non_stop_ && state_ == ProcessState::Stopped)
+        stop_other_threads(current_tid_);
+
+    non_stop_ = enable;
+}
+
+// Nothing else may run past a breakpoint while it is lifted, threads
+// still running are halted first and returned for resume_halted()
+std::vector<pid_t> Process::lift_breakpoint(BreakpointSite &bp)
+{
+    std::vector<pid_t> running = running_threads();
+    if (running.empty() == false)
+        stop_other_threads(0);
+
+    bp.disable();
+    return running;
 }
 
 std::uint8_t Process::step_instruction()
@@ -124,59 +998,246 @@ std::uint8_t Process::step_instruction()
     if (state_ != ProcessState::Stopped)
         Error::send("Can only perform single step when process is stopped");
 
+    ThreadState &thread = threads_.at(current_tid_);
+    if (reg_state_->dirty_)
+        set_registers(thread);
+
     virt_addr pc = get_pc();
     BreakpointSite *bp_ptr = nullptr;
+    std::vector<pid_t> running;
     if (breakpoint_sites_.enabled_stoppoint_at_address(pc))
     {
         BreakpointSite &bp = breakpoint_sites_.get_by_address(pc);
-        bp.disable();
+        running = lift_breakpoint(bp);
         bp_ptr = &bp;
     }
 
-    if (ptrace(PTRACE_SINGLESTEP, pid_, nullptr, nullptr) < 0) {
-        Error::send_errno("Could not single step");
+    // Only the current thread moves, the others stay halted
+    int status = single_step_thread(thread);
+    bool exited = (WIFSTOPPED(status) == false);
+    bool exec = (exited == false && (status >> 16) == PTRACE_EVENT_EXEC);
+    if (bp_ptr && exec)
+    {
+        // The lifted site is re-armed in the new image if it still fits
+        bp_ptr->is_enabled_ = true;
     }
-
-    std::uint8_t ret = this->wait();
-    if (bp_ptr)
+    else if (bp_ptr && (exited == false || current_tid_ != pid_))
     {
         bp_ptr->enable();
     }
 
-    return ret;
+    resume_halted(running);
+    return complete_step(thread, status);
 }
 
-void Process::resume()
+// Settles the current thread once its step returned, exec and exit included
+std::uint8_t Process::complete_step(ThreadState &thread, int status)
+{
+    if (WIFSTOPPED(status) == false)
+    {
+        if (current_tid_ == pid_)
+            return report_exit(status);
+
+        threads_.erase(current_tid_);
+        select_thread(pid_);
+        return 0;
+    }
+
+    bool exec = ((status >> 16) == PTRACE_EVENT_EXEC);
+    if (exec)
+        handle_exec();
+
+    thread.stop_info = WSTOPSIG(status);
+    thread.reason = exec ? StopReason::Exec : StopReason::Signal;
+    get_registers(thread);
+    return thread.stop_info;
+}
+
+StepResult Process::step_instructions(const StepLimits &limits,
+    const StepObserver &observer)
 {
     if (state_ != ProcessState::Stopped)
-        Error::send("Process not in stopped state, cannot continue");
+        Error::send("Can only perform single step when process is stopped");
 
-    set_registers();
+    if (limits.count == 0 && !limits.until && !limits.range)
+        Error::send("Batched step needs a count, an address or a range");
 
-    virt_addr pc = get_pc();
+    StepResult result;
+    auto start = std::chrono::steady_clock::now();
 
-    if (breakpoint_sites_.enabled_stoppoint_at_address(pc))
+    // The first step lifts a breakpoint under pc like a plain step does
+    if (observer)
+        observer(get_pc());
+    result.info = step_instruction();
+    result.steps = 1;
+    pid_t tid = current_tid_;
+
+    while (true)
+    {
+        if (state_ != ProcessState::Stopped || current_tid_ != tid)
+        {
+            result.end = StepEnd::Exited;
+            break;
+        }
+
+        ThreadState &thread = threads_.at(tid);
+        if (thread.reason == StopReason::Exec || result.info != SIGTRAP)
+        {
+            result.end = StepEnd::Signal;
+            break;
+        }
+
+        virt_addr pc = thread.regs->read<std::uint64_t>(RegisterID::REG64_PC);
+        if (limits.until && pc == *limits.until)
+        {
+            result.end = StepEnd::Until;
+            break;
+        }
+        if (limits.range && (pc < limits.range->first || pc >= limits.range->second))
+        {
+            result.end = StepEnd::Range;
+            break;
+        }
+        if (limits.count != 0 && result.steps >= limits.count)
+        {
+            result.end = StepEnd::Count;
+            break;
+        }
+        if (breakpoint_sites_.enabled_stoppoint_at_address(pc))
+        {
+            result.end = StepEnd::Breakpoint;
+            break;
+        }
+
+        if (observer)
+            observer(pc);
+
+        // A plain step trap only needs the new pc, anything else takes
+        // the full path of a single step
+        int status = single_step_thread(thread);
+        result.steps++;
+        if (WIFSTOPPED(status) && (status >> 16) == 0 && WSTOPSIG(status) == SIGTRAP)
+        {
+            get_gprs(thread);
+            continue;
+        }
+        result.info = complete_step(thread, status);
+    }
+
+    // Vector registers were left behind while stepping
+    if (state_ == ProcessState::Stopped)
+    {
+        ThreadState &thread = threads_.at(current_tid_);
+        if (thread.regs_valid == false)
+            get_registers(thread);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+bool Process::step_over_breakpoint(ThreadState &thread)
+{
+    virt_addr pc = thread.regs->read<std::uint64_t>(RegisterID::REG64_PC);
+    if (breakpoint_sites_.enabled_stoppoint_at_address(pc) == false)
+        return true;
+
+    BreakpointSite &bp = breakpoint_sites_.get_by_address(pc);
+    std::vector<pid_t> running = lift_breakpoint(bp);
+    int status = single_step_thread(thread);
+    bp.enable();
+    resume_halted(running);
+
+    // Anything but the step trap is left for wait() to report
+    if (WIFSTOPPED(status) == false)
+    {
+        stray_statuses[thread.tid] = status;
+        thread.state = ProcessState::Running;
+    }
+    else if (WSTOPSIG(status) != SIGTRAP)
+    {
+        thread.pending_status = status;
+        return false;
+    }
+
+    return true;
+}
+
+bool Process::is_rendezvous_stop(ThreadState &thread, int status)
+{
+    if (modules_->active() == false || (status >> 16) != 0 || WSTOPSIG(status) != SIGTRAP)
+        return false;
+
+    get_gprs(thread);
+    return thread.regs->read<std::uint64_t>(RegisterID::REG64_PC) == modules_->breakpoint_address();
+}
+
+// The loader stopped on r_brk, the module list catches up and the thread
+// carries on without a stop being reported
+bool Process::pass_rendezvous(ThreadState &thread)
+{
+    // New sites are written through this thread while the rest are halted
+    std::vector<pid_t> running = running_threads();
+    if (running.empty() == false)
+        stop_other_threads(thread.tid);
+
+    pid_t current = current_tid_;
+    current_tid_ = thread.tid;
+    try
+    {
+        modules_->update();
+    }
+    catch (const Error &)
+    {
+        // A link map we cannot read leaves the list as it was
+    }
+    bool stepped = step_over_breakpoint(thread);
+    current_tid_ = current;
+
+    resume_halted(running);
+    if (stepped)
+        resume_thread(thread);
+    return stepped;
+}
+
+void Process::resume()
+{
+    if (state_ != ProcessState::Stopped)
+        Error::send("Process not in stopped state, cannot continue");
+
+    // Only threads whose cache was modified are written back
+    for (auto &[tid, thread] : threads_)
     {
-        BreakpointSite &bp = breakpoint_sites_.get_by_address(pc);
-        bp.disable();
+        if (thread.state == ProcessState::Stopped && thread.regs->dirty_)
+            set_registers(thread);
+    }
 
-        if (ptrace(PTRACE_SINGLESTEP, pid_, nullptr, nullptr) < 0)
-        {
-            Error::send_errno("Failed to single step");
-        }
-    
-        int wait_status;
-        if (waitpid(pid_, &wait_status, 0) < 0)
+    // A stop collected while halting threads is reported without running
+    for (auto &[tid, thread] : threads_)
+    {
+        if (thread.pending_status && (non_stop_ == false || tid == current_tid_))
         {
-            Error::send_errno("waitpid failed");
+            state_ = ProcessState::Running;
+            return;
         }
+    }
 
-        bp.enable();
+    if (step_over_breakpoint(threads_.at(current_tid_)) == false)
+    {
+        state_ = ProcessState::Running;
+        return;
     }
 
-    if (ptrace(PTRACE_CONT, pid_, nullptr, nullptr) < 0)
+    for (auto &[tid, thread] : threads_)
     {
-        Error::send_errno("ptrace(PTRACE_CONT) failed");
+        if (thread.state != ProcessState::Stopped || thread.pending_status)
+            continue;
+
+        if (non_stop_ && tid != current_tid_)
+            continue;
+
+        resume_thread(thread);
     }
 
     state_ = ProcessState::Running;
@@ -186,11 +1247,26 @@ std::unique_ptr<Process>
 Process::launch(std::vector<std::string_view> &exec_args,
     std::optional<int*> comm)
 {
+    LaunchOptions options;
+    options.comm = comm;
+    return launch(exec_args, options);
+}
+
+std::unique_ptr<Process>
+Process::launch(std::vector<std::string_view> &exec_args,
+    const LaunchOptions &options)
+{
+    const auto &comm = options.comm;
     if (exec_args.empty())
     {
         Error::send("No executable provided");
     }
 
+    // Built up front, the child only installs it
+    std::vector<sock_filter> seccomp_filter;
+    if (options.trace_syscalls.empty() == false)
+        seccomp_filter = SyscallTracer::filter(options.trace_syscalls);
+
     Pipe channel(true);
     SocketPair channel1;
     pid_t debug_pid = ::fork();
@@ -206,6 +1282,11 @@ Process::launch(std::vector<std::string_view> &exec_args,
 
         personality(ADDR_NO_RANDOMIZE);
 
+        // Debuggers block SIGCHLD for their event loop, do not pass it on
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+
         if (comm)
         {
             channel1.close_parent();
@@ -218,6 +1299,21 @@ Process::launch(std::vector<std::string_view> &exec_args,
             exit_with_perror(channel, "Tracing Failed");
         }
 
+        if (options.preload.empty() == false)
+        {
+            std::string preload = options.preload;
+            if (const char *existing = getenv("LD_PRELOAD"))
+            {
+                preload += ":";
+                preload += existing;
+            }
+
+            if (setenv("LD_PRELOAD", preload.c_str(), 1) < 0)
+            {
+                exit_with_perror(channel, "setenv() failed for LD_PRELOAD");
+            }
+        }
+
         std::vector<std::string> args_copy;
         args_copy.reserve(exec_args.size());
         for (const auto &arg : exec_args)
@@ -240,6 +1336,19 @@ Process::launch(std::vector<std::string_view> &exec_args,
             }
         }
 
+        // Last before exec, anything the filter traces fails until then
+        if (seccomp_filter.empty() == false)
+        {
+            sock_fprog prog{};
+            prog.len = static_cast<unsigned short>(seccomp_filter.size());
+            prog.filter = seccomp_filter.data();
+            if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) < 0 ||
+                prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) < 0)
+            {
+                exit_with_perror(channel, "Could not install the seccomp filter");
+            }
+        }
+
         execvp(path.c_str(), argv.data());
         exit_with_perror(channel, "execvp() failed for " + path);
     }
@@ -258,85 +1367,213 @@ Process::launch(std::vector<std::string_view> &exec_args,
 
     std::unique_ptr<Process> proc(new Process(debug_pid, true));
     proc->wait();
+    proc->set_trace_options(debug_pid);
+    proc->exe_path_ = read_exe_path(debug_pid);
+    proc->syscalls_->filtered_ = SyscallTracer::traceable(options.trace_syscalls);
 
     if (comm.has_value())
         **comm = channel1.release_parent();
 
     // Launched process should ideally stop execution
     // Due to a SIGTRAP recived just after execvp
+    proc->run_to(options.stop_at);
 
     return proc;
 }
 
+std::optional<std::uint8_t> Process::run_to(StopAt where)
+{
+    if (where == StopAt::Exec)
+        return std::nullopt;
+
+    if (where == StopAt::None)
+    {
+        resume();
+        return std::nullopt;
+    }
+
+    virt_addr target = 0;
+    if (where == StopAt::Entry)
+        target = auxv().entry();
+    else if (auto address = symbol_address("main"))
+        target = *address;
+    if (target == 0)
+        Error::send(where == StopAt::Entry ? "No entry point in the auxiliary vector" :
+            "No symbol named main");
+
+    // A site the user placed there already does the job and stays
+    bool placed = breakpoint_sites_.contains_address(target) == false;
+    if (placed)
+        create_breakpoint_site(target, false, true).enable();
+
+    resume();
+    std::uint8_t info = wait();
+
+    if (placed && state_ == ProcessState::Stopped)
+        breakpoint_sites_.remove_by_address(target);
+    else if (placed)
+        discard_breakpoint_site(target);
+    return info;
+}
+
 std::unique_ptr<Process>
-Process::attach(pid_t pid)
+Process::attach(pid_t pid, bool seize)
 {
     if (pid <= 0)
     {
         Error::send("Invalid PID");
     }
 
-    if (ptrace(PTRACE_ATTACH, pid, nullptr, nullptr) < 0)
+    long ret = seize ?
+        ptrace(PTRACE_SEIZE, pid, nullptr, trace_options) :
+        ptrace(PTRACE_ATTACH, pid, nullptr, nullptr);
+    if (ret < 0)
     {
         Error::send_errno("Attach failed");
     }
 
     std::unique_ptr<Process> proc(new Process(pid, false));
-    proc->wait();
+    proc->exe_path_ = read_exe_path(pid);
+    if (seize)
+    {
+        // Nothing is stopped, the tracee never notices the attach
+        proc->seized_ = true;
+        proc->state_ = ProcessState::Running;
+        proc->threads_.at(pid).state = ProcessState::Running;
+    }
+    else
+    {
+        proc->wait();
+    }
 
     // Attached process should ideally stop execution
     // Due to a SIGSTOP received as part of PTRACE_ATTACH
+    // Remaining threads are attached one by one afterwards
+    proc->attach_threads();
 
     return proc;
 }
 
 void Process::get_registers()
 {
+    get_registers(threads_.at(current_tid_));
+}
+
+void Process::set_registers()
+{
+    set_registers(threads_.at(current_tid_));
+}
+
+void Process::get_gprs(ThreadState &thread)
+{
+    Registers &regs = *thread.regs;
     struct iovec iov;
-    iov.iov_base = reg_state_->gpr_ptr();
-    iov.iov_len = reg_state_->gpr_size();
-    if (ptrace(PTRACE_GETREGSET, pid_, NT_PRSTATUS, &iov) < 0)
+    iov.iov_base = regs.gpr_ptr();
+    iov.iov_len = regs.gpr_size();
+    if (ptrace(PTRACE_GETREGSET, thread.tid, NT_PRSTATUS, &iov) < 0)
     {
         Error::send_errno("Failed to read general purpose registers");
     }
+}
+
+void Process::get_registers(ThreadState &thread)
+{
+    get_gprs(thread);
 
-    iov.iov_base = reg_state_->fpr_ptr();
-    iov.iov_len = reg_state_->fpr_size();
-    if (ptrace(PTRACE_GETREGSET, pid_, NT_FPREGSET, &iov) < 0)
+    Registers &regs = *thread.regs;
+    struct iovec iov;
+    iov.iov_base = regs.fpr_ptr();
+    iov.iov_len = regs.fpr_size();
+    if (ptrace(PTRACE_GETREGSET, thread.tid, NT_FPREGSET, &iov) < 0)
     {
         Error::send_errno("Failed to read vector registers");
     }
 
-    iov.iov_base = reg_state_->hwbp_ptr();
-    iov.iov_len = reg_state_->hwbp_size();
-    if (ptrace(PTRACE_GETREGSET, pid_, NT_ARM_HW_BREAK, &iov) < 0)
+    regs.dirty_ = false;
+    thread.regs_valid = true;
+}
+
+void Process::set_registers(ThreadState &thread)
+{
+    Registers &regs = *thread.regs;
+    struct iovec iov;
+    iov.iov_base = regs.gpr_ptr();
+    iov.iov_len = regs.gpr_size();
+    if (ptrace(PTRACE_SETREGSET, thread.tid, NT_PRSTATUS, &iov) < 0)
+    {
+        Error::send_errno("Failed to write general purpose registers");
+    }
+
+    iov.iov_base = regs.fpr_ptr();
+    iov.iov_len = regs.fpr_size();
+    if (ptrace(PTRACE_SETREGSET, thread.tid, NT_FPREGSET, &iov) < 0)
+    {
+        Error::send_errno("Failed to write vector registers");
+    }
+
+    regs.dirty_ = false;
+}
+
+// Debug registers are per thread in hardware but shared by all threads
+// here, so they are read once from a stopped thread and then only written
+void Process::ensure_debug_state()
+{
+    if (debug_state_valid_)
+        return;
+
+    struct iovec iov;
+    iov.iov_base = debug_state_->hwbp_ptr();
+    iov.iov_len = debug_state_->hwbp_size();
+    if (ptrace(PTRACE_GETREGSET, current_tid_, NT_ARM_HW_BREAK, &iov) < 0)
     {
         Error::send_errno("Failed to read hardware breakpoints");
     }
 
-    iov.iov_base = reg_state_->hwwp_ptr();
-    iov.iov_len = reg_state_->hwwp_size();
-    if (ptrace(PTRACE_GETREGSET, pid_, NT_ARM_HW_WATCH, &iov) < 0)
+    iov.iov_base = debug_state_->hwwp_ptr();
+    iov.iov_len = debug_state_->hwwp_size();
+    if (ptrace(PTRACE_GETREGSET, current_tid_, NT_ARM_HW_WATCH, &iov) < 0)
     {
         Error::send_errno("Failed to read hardware watchpoints");
     }
+
+    debug_state_valid_ = true;
 }
 
-void Process::set_registers()
+void Process::write_debug_state_all(int note)
+{
+    // Running threads of a non-stop process are halted for the update
+    std::vector<pid_t> running = running_threads();
+    if (running.empty() == false)
+        stop_other_threads(0);
+
+    for (auto &[tid, thread] : threads_)
+    {
+        if (thread.state == ProcessState::Stopped)
+            write_debug_state(tid, note);
+    }
+
+    resume_halted(running);
+}
+
+void Process::write_debug_state(pid_t tid, int note)
 {
     struct iovec iov;
-    iov.iov_base = reg_state_->gpr_ptr();
-    iov.iov_len = reg_state_->gpr_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_PRSTATUS, &iov) < 0)
+    if (note == NT_ARM_HW_BREAK)
     {
-        Error::send_errno("Failed to write general purpose registers");
+        iov.iov_base = debug_state_->hwbp_ptr();
+        iov.iov_len = debug_state_->hwbp_size();
+    }
+    else
+    {
+        iov.iov_base = debug_state_->hwwp_ptr();
+        iov.iov_len = debug_state_->hwwp_size();
     }
 
-    iov.iov_base = reg_state_->fpr_ptr();
-    iov.iov_len = reg_state_->fpr_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_FPREGSET, &iov) < 0)
+    if (ptrace(PTRACE_SETREGSET, tid, note, &iov) < 0)
     {
-        Error::send_errno("Failed to write vector registers");
+        Error::send_errno(note == NT_ARM_HW_BREAK ?
+            "Failed to write hardware breakpoints" :
+            "Failed to write hardware watchpoints");
     }
 }
 
@@ -369,13 +1606,27 @@ Process::create_breakpoint_site(virt_addr addr, bool hw , bool intnl)
         std::unique_ptr<BreakpointSite>(new BreakpointSite(*this, addr, hw, intnl)));
 }
 
+void Process::discard_breakpoint_site(virt_addr address)
+{
+    if (breakpoint_sites_.contains_address(address) == false)
+        return;
+
+    // Debug registers are ours to clear, the code is not there to restore
+    BreakpointSite &site = breakpoint_sites_.get_by_address(address);
+    if (site.is_hardware())
+        site.disable();
+    site.is_enabled_ = false;
+    breakpoint_sites_.remove_by_address(address);
+}
+
 int Process::set_hw_breakpoint(virt_addr addr)
 {
-    unsigned int count = reg_state_->hwbp_.dbg_info & 0xff;
+    ensure_debug_state();
+    unsigned int count = debug_state_->hwbp_.dbg_info & 0xff;
     unsigned int i = 0;
     for (; i < count; i++)
     {
-        if (reg_state_->in_use_hwbp_[i] == false)
+        if (debug_state_->in_use_hwbp_[i] == false)
             break; 
     }
 
@@ -386,24 +1637,19 @@ int Process::set_hw_breakpoint(virt_addr addr)
                     (0b10 << 1) | // Privelege 10=user, 01=kernel
                     (1 << 0);     // E: enable
 
-    reg_state_->hwbp_.dbg_regs[i].addr = addr;
-    reg_state_->hwbp_.dbg_regs[i].ctrl = ctrl;
+    debug_state_->hwbp_.dbg_regs[i].addr = addr;
+    debug_state_->hwbp_.dbg_regs[i].ctrl = ctrl;
 
-    reg_state_->in_use_hwbp_[i] = true;
+    debug_state_->in_use_hwbp_[i] = true;
 
-    struct iovec iov;
-    iov.iov_base = reg_state_->hwbp_ptr();
-    iov.iov_len = reg_state_->hwbp_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_ARM_HW_BREAK, &iov) < 0)
-    {
-        Error::send_errno("Failed to write hardware breakpoints");
-    }
+    write_debug_state_all(NT_ARM_HW_BREAK);
     return i;
 }
 
 void Process::clear_hw_breakpoint(int index)
 {
-    unsigned int count = reg_state_->hwbp_.dbg_info & 0xff;
+    ensure_debug_state();
+    unsigned int count = debug_state_->hwbp_.dbg_info & 0xff;
 
     if (index < 0 || static_cast<unsigned int>(index) > count)
     {
@@ -411,27 +1657,22 @@ void Process::clear_hw_breakpoint(int index)
         return;
     }
     
-    reg_state_->hwbp_.dbg_regs[index].addr = 0;
-    reg_state_->hwbp_.dbg_regs[index].ctrl = 0;
+    debug_state_->hwbp_.dbg_regs[index].addr = 0;
+    debug_state_->hwbp_.dbg_regs[index].ctrl = 0;
 
-    reg_state_->in_use_hwbp_[index] = false;
+    debug_state_->in_use_hwbp_[index] = false;
 
-    struct iovec iov;
-    iov.iov_base = reg_state_->hwbp_ptr();
-    iov.iov_len = reg_state_->hwbp_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_ARM_HW_BREAK, &iov) < 0)
-    {
-        Error::send_errno("Failed to write hardware breakpoints");
-    }
+    write_debug_state_all(NT_ARM_HW_BREAK);
 }
 
 int Process::set_hw_watchpoint(virt_addr addr)
 {
-    unsigned int count = reg_state_->hwwp_.dbg_info & 0xff;
+    ensure_debug_state();
+    unsigned int count = debug_state_->hwwp_.dbg_info & 0xff;
     unsigned int i = 0;
     for (; i < count; i++)
     {
-        if (reg_state_->in_use_hwwp_[i] == false)
+        if (debug_state_->in_use_hwwp_[i] == false)
             break; 
     }
 
@@ -459,41 +1700,170 @@ int Process::set_hw_watchpoint(virt_addr addr)
                           (1 << 0);     // E: enable
     
 
-    reg_state_->hwwp_.dbg_regs[i].addr = addr;
-    reg_state_->hwwp_.dbg_regs[i].ctrl = rw_ctrl;
+    debug_state_->hwwp_.dbg_regs[i].addr = addr;
+    debug_state_->hwwp_.dbg_regs[i].ctrl = rw_ctrl;
 
-    reg_state_->in_use_hwwp_[i] = true;
+    debug_state_->in_use_hwwp_[i] = true;
 
-    iovec iov;
-    iov.iov_base = reg_state_->hwwp_ptr();
-    iov.iov_len = reg_state_->hwwp_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_ARM_HW_WATCH, &iov) < 0)
-    {
-        Error::send_errno("Failed to write hardware watchpoints");
-    }
+    write_debug_state_all(NT_ARM_HW_WATCH);
 
     return i;
 }
 
 void Process::clear_hw_watchpoint(int index)
 {
-    unsigned int count = reg_state_->hwwp_.dbg_info & 0xff;
+    ensure_debug_state();
+    unsigned int count = debug_state_->hwwp_.dbg_info & 0xff;
 
     if (index < 0 || static_cast<unsigned int>(index) > count)
         return;
 
-    reg_state_->hwwp_.dbg_regs[index].addr = 0;
-    reg_state_->hwwp_.dbg_regs[index].ctrl = 0;
+    debug_state_->hwwp_.dbg_regs[index].addr = 0;
+    debug_state_->hwwp_.dbg_regs[index].ctrl = 0;
+
+    debug_state_->in_use_hwwp_[index] = false;
+
+    write_debug_state_all(NT_ARM_HW_WATCH);
+}
+
+
+const AuxVector &Process::auxv()
+{
+    if (!auxv_)
+        auxv_ = std::make_unique<AuxVector>(pid_);
+    return *auxv_;
+}
+
+// The kernel maps the executable before the first instruction runs,
+// AT_ENTRY is where its entry point landed
+const Elf *Process::elf()
+{
+    if (elf_loaded_ || exe_path_.empty())
+        return elf_.get();
+    elf_loaded_ = true;
+
+    try
+    {
+        elf_ = std::make_unique<Elf>(exe_path_);
+        virt_addr entry = auxv().entry();
+        if (entry != 0)
+            elf_->set_load_bias(entry - elf_->header().e_entry);
+    }
+    catch (const Error &)
+    {
+        // Without auxv the image is taken to run where it was linked
+        if (!elf_)
+            return nullptr;
+    }
+    return elf_.get();
+}
 
-    reg_state_->in_use_hwwp_[index] = false;
+std::optional<virt_addr> Process::load_bias(std::string_view module)
+{
+    auto matches = [module](std::string_view path)
+    {
+        if (path.empty() || module.empty())
+            return false;
+        if (path == module)
+            return true;
+        std::size_t slash = path.rfind('/');
+        return slash != std::string_view::npos && path.substr(slash + 1) == module;
+    };
+
+    const Elf *image = elf();
+    if (image != nullptr && matches(exe_path_))
+        return image->load_bias();
+
+    for (const auto &loaded : modules_->modules())
+    {
+        if (matches(loaded.path))
+            return loaded.base;
+    }
 
-    iovec iov;
-    iov.iov_base = reg_state_->hwwp_ptr();
-    iov.iov_len = reg_state_->hwwp_size();
-    if (ptrace(PTRACE_SETREGSET, pid_, NT_ARM_HW_WATCH, &iov) < 0)
+    // Before the loader has a link map of its own, AT_BASE places it. It
+    // is linked at 0 so its base is its bias
+    if (image != nullptr && matches(image->interpreter()))
     {
-        Error::send_errno("Failed to write hardware watchpoints");
+        virt_addr base = auxv().interpreter_base();
+        if (base != 0)
+            return base;
     }
+    return std::nullopt;
+}
+
+std::optional<std::pair<const ElfSymbol *, virt_addr>>
+Process::symbolize(virt_addr address)
+{
+    const Elf *image = elf();
+    if (image == nullptr || address < image->load_bias())
+        return std::nullopt;
+
+    virt_addr file_addr = address - image->load_bias();
+    const ElfSymbol *sym = image->symbol_containing(file_addr);
+    if (sym == nullptr)
+        return std::nullopt;
+    return std::make_pair(sym, file_addr - sym->address);
+}
+
+std::optional<virt_addr> Process::symbol_address(std::string_view name)
+{
+    const Elf *image = elf();
+    if (image == nullptr)
+        return std::nullopt;
+
+    auto syms = image->symbols_by_name(name);
+    if (syms.empty() == false)
+        return syms.front()->address + image->load_bias();
+
+    if (auto address = modules_->symbol_address(name))
+        return address;
+
+    // Qualified C++ names only exist in the debug info. A lookup neither
+    // starts indexing nor waits for it, a miss before then is a miss
+    if (!index_ || index_->ready() == false)
+        return std::nullopt;
+    auto functions = index_->functions_named(name);
+    if (functions.empty())
+        return std::nullopt;
+    return functions.front().low + image->load_bias();
+}
+
+LineTable *Process::line_table()
+{
+    if (!lines_ && elf() != nullptr)
+        lines_ = std::make_unique<LineTable>(*elf_);
+    return lines_.get();
+}
+
+const DwarfIndex *Process::dwarf_index()
+{
+    if (!index_ && elf() != nullptr)
+        index_ = std::make_unique<DwarfIndex>(*elf_, 0, DwarfIndex::default_cache_dir());
+    return index_.get();
+}
+
+std::optional<LineEntry> Process::source_line(virt_addr address)
+{
+    LineTable *lines = line_table();
+    if (lines == nullptr || address < elf_->load_bias())
+        return std::nullopt;
+
+    auto entry = lines->line_at(address - elf_->load_bias());
+    if (entry)
+        entry->address += elf_->load_bias();
+    return entry;
+}
+
+std::vector<virt_addr> Process::line_addresses(std::string_view file, std::uint32_t line)
+{
+    std::vector<virt_addr> addresses;
+    LineTable *lines = line_table();
+    if (lines == nullptr)
+        return addresses;
+
+    for (const auto &entry : lines->entries_for(file, line))
+        addresses.push_back(entry.address + elf_->load_bias());
+    return addresses;
 }
 
 
@@ -525,7 +1895,7 @@ Process::read_memory(virt_addr address, std::size_t size) const
         address += chunk_size;
     }
 
-    if (process_vm_readv(pid_, &local_desc, 1, remote_descs.data(),
+    if (process_vm_readv(current_tid_, &local_desc, 1, remote_descs.data(),
         remote_descs.size(), 0) < 0)
     {
         Error::send_errno("Could not read process memory");
@@ -551,7 +1921,7 @@ void Process::write_memory(virt_addr address, Span<const std::uint8_t> data)
             std::memcpy(word_data, data.begin() + written, remain);
             std::memcpy(word_data + remain, read.data() + remain, 8 - remain);
         }
-        if (ptrace(PTRACE_POKEDATA, pid_, address + written, qword) < 0)
+        if (ptrace(PTRACE_POKEDATA, current_tid_, address + written, qword) < 0)
         {
             Error::send_errno("Failed to write memory");
         }
@@ -559,6 +1929,288 @@ void Process::write_memory(virt_addr address, Span<const std::uint8_t> data)
     }
 }
 
+std::uint64_t
+Process::inject_syscall_args(std::uint64_t nr, Span<const std::uint64_t> args)
+{
+    if (state_ != ProcessState::Stopped)
+        Error::send("Can only inject syscalls into a stopped process");
+
+    if (args.size() > 6)
+        Error::send("AArch64 syscalls take at most six arguments");
+
+    virt_addr stub = scratch_->stub_address();
+    if (stub != 0)
+        return run_syscall_stub(nr, args, stub);
+
+    // Until a scratch page exists the stub temporarily overwrites the
+    // instructions at pc, which is always mapped executable. Threads still
+    // running in non-stop mode are halted so none of them runs into it
+    std::vector<pid_t> halted = halt_threads();
+    try
+    {
+        std::uint64_t ret = run_syscall_stub(nr, args, get_pc());
+        release_threads(halted);
+        return ret;
+    }
+    catch (const Error &)
+    {
+        release_threads(halted);
+        throw;
+    }
+}
+
+std::uint64_t
+Process::run_syscall_stub(std::uint64_t nr, Span<const std::uint64_t> args,
+    virt_addr stub)
+{
+    // svc #0 ; brk #0
+    static const std::uint8_t syscall_stub[] =
+    {
+        0x01, 0x00, 0x00, 0xd4,
+        0x00, 0x00, 0x20, 0xd4,
+    };
+
+    auto saved_gpr = reg_state_->gpr_;
+    auto saved_fpr = reg_state_->fpr_;
+
+    auto saved_code = read_memory(stub, sizeof(syscall_stub));
+    write_memory(stub, {syscall_stub, sizeof(syscall_stub)});
+
+    auto restore = [&]()
+    {
+        write_memory(stub, {saved_code.data(), saved_code.size()});
+        reg_state_->gpr_ = saved_gpr;
+        reg_state_->fpr_ = saved_fpr;
+        set_registers();
+    };
+
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        std::uint64_t val = (i < args.size()) ? args[i] : 0;
+        reg_state_->write(gpr_id(i), RegisterValue{val});
+    }
+    reg_state_->write(RegisterID::REG64_X8, RegisterValue{nr});
+    reg_state_->write(RegisterID::REG64_PC, RegisterValue{stub});
+    set_registers();
+
+    // Only the current thread is continued to run the stub
+    pid_t tid = current_tid_;
+    int status = 0;
+    try
+    {
+        if (ptrace(PTRACE_CONT, tid, nullptr, nullptr) < 0)
+        {
+            Error::send_errno("ptrace(PTRACE_CONT) failed");
+        }
+
+        while (true)
+        {
+            wait_thread(tid, status);
+            if (WIFEXITED(status) || WIFSIGNALED(status))
+                break;
+
+            ThreadState &thread = threads_.at(tid);
+            bool event = handle_ptrace_event(thread, status, false);
+            if (event == false && is_requested_stop(thread, status))
+            {
+                thread.expect_stop = false;
+            }
+            else if (event == false && (status >> 16) == 0)
+            {
+                if (WSTOPSIG(status) == SIGTRAP)
+                    break;
+
+                // Held for the next resume, the stub itself runs without it
+                thread.pending_signal = WSTOPSIG(status);
+            }
+
+            if (ptrace(PTRACE_CONT, tid, nullptr, nullptr) < 0)
+            {
+                Error::send_errno("ptrace(PTRACE_CONT) failed");
+            }
+        }
+    }
+    catch (const Error &)
+    {
+        restore();
+        throw;
+    }
+
+    if (WIFEXITED(status) || WIFSIGNALED(status))
+    {
+        if (tid == pid_)
+        {
+            report_exit(status);
+            Error::send("Process ended during syscall injection");
+        }
+
+        // The other threads share the code, the stub is taken out through
+        // the main thread, the registers are gone with their thread
+        threads_.erase(tid);
+        current_tid_ = pid_;
+        reg_state_ = threads_.at(pid_).regs.get();
+        write_memory(stub, {saved_code.data(), saved_code.size()});
+        Error::send("Thread ended during syscall injection");
+    }
+
+    get_registers();
+    if (get_pc() != stub + 4)
+    {
+        restore();
+        Error::send("Injected syscall stopped outside of its stub");
+    }
+
+    std::uint64_t ret = reg_state_->read<std::uint64_t>(RegisterID::REG64_X0);
+    restore();
+    return ret;
+}
+
+CallResult
+Process::call_function(virt_addr fn, const std::vector<RegisterValue> &args)
+{
+    if (state_ != ProcessState::Stopped)
+        Error::send("Can only call functions in a stopped process");
+
+    // May inject an mmap, so do it before the register snapshot
+    virt_addr trap = scratch_->trap_address();
+    pid_t caller = current_tid_;
+
+    auto saved_gpr = reg_state_->gpr_;
+    auto saved_fpr = reg_state_->fpr_;
+
+    std::size_t ngrn = 0;   // Next general purpose register number
+    std::size_t nsrn = 0;   // Next SIMD and floating point register number
+    std::vector<std::uint8_t> stack_args;
+
+    // Stack arguments take 8 byte slots, 16 byte ones are 16 aligned
+    auto push_stack = [&](const void *data, std::size_t size, std::size_t align)
+    {
+        std::size_t offset = (stack_args.size() + align - 1) & ~(align - 1);
+        stack_args.resize(offset + ((size + 7) & ~std::size_t(7)), 0);
+        std::memcpy(stack_args.data() + offset, data, size);
+    };
+
+    auto place = [&](auto val)
+    {
+        using T = decltype(val);
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (nsrn >= 8)
+            {
+                push_stack(&val, sizeof(val), 8);
+                return;
+            }
+
+            RegisterID base = std::is_same_v<T, float> ?
+                RegisterID::REG32_S0 : RegisterID::REG64_D0;
+            reg_state_->write(register_offset_id(RegisterID::REG128_V0, nsrn),
+                RegisterValue{__uint128_t{0}});
+            reg_state_->write(register_offset_id(base, nsrn), RegisterValue{val});
+            nsrn++;
+        }
+        else if constexpr (std::is_same_v<T, __uint128_t>)
+        {
+            // Quad word integers use an even numbered register pair
+            ngrn = (ngrn + 1) & ~std::size_t(1);
+            if (ngrn + 2 > 8)
+            {
+                ngrn = 8;
+                push_stack(&val, sizeof(val), 16);
+                return;
+            }
+
+            reg_state_->write(gpr_id(ngrn++), RegisterValue{static_cast<std::uint64_t>(val)});
+            reg_state_->write(gpr_id(ngrn++), RegisterValue{static_cast<std::uint64_t>(val >> 64)});
+        }
+        else
+        {
+            std::uint64_t wide = val;
+            if (ngrn >= 8)
+            {
+                push_stack(&wide, sizeof(wide), 8);
+                return;
+            }
+
+            reg_state_->write(gpr_id(ngrn++), RegisterValue{wide});
+        }
+    };
+
+    for (const auto &arg : args)
+    {
+        std::visit(place, arg);
+    }
+
+    virt_addr sp = reg_state_->read<std::uint64_t>(RegisterID::REG64_SP);
+    sp = (sp - stack_args.size()) & ~virt_addr(0xF);
+    if (stack_args.empty() == false)
+    {
+        write_memory(sp, {stack_args.data(), stack_args.size()});
+    }
+
+    reg_state_->write(RegisterID::REG64_SP, RegisterValue{sp});
+    reg_state_->write(RegisterID::REG64_X30, RegisterValue{trap});
+    reg_state_->write(RegisterID::REG64_PC, RegisterValue{fn});
+
+    if (breakpoint_sites_.contains_address(trap) == false)
+    {
+        create_breakpoint_site(trap, false, true);
+    }
+    breakpoint_sites_.get_by_address(trap).enable();
+
+    // A signal held for the caller belongs to the next real resume
+    int held = std::exchange(threads_.at(caller).pending_signal, 0);
+    auto restore_signal = [&]()
+    {
+        auto it = threads_.find(caller);
+        if (held != 0 && it != threads_.end())
+            it->second.pending_signal = held;
+    };
+
+    std::uint8_t info = 0;
+    try
+    {
+        resume();
+        info = wait();
+    }
+    catch (const Error &)
+    {
+        restore_signal();
+        throw;
+    }
+
+    if (state_ != ProcessState::Stopped)
+    {
+        restore_signal();
+        Error::send("Process ended during function call");
+    }
+
+    CallResult res{};
+    bool returned = (current_tid_ == caller && get_pc() == trap);
+    if (returned)
+    {
+        res.x0 = reg_state_->read<std::uint64_t>(RegisterID::REG64_X0);
+        res.x1 = reg_state_->read<std::uint64_t>(RegisterID::REG64_X1);
+        res.d0 = reg_state_->read<double>(RegisterID::REG64_D0);
+        res.s0 = reg_state_->read<float>(RegisterID::REG32_S0);
+    }
+
+    breakpoint_sites_.remove_by_address(trap);
+
+    // Another thread may have stopped first, the call is abandoned
+    select_thread(caller);
+    reg_state_->gpr_ = saved_gpr;
+    reg_state_->fpr_ = saved_fpr;
+    set_registers();
+    restore_signal();
+
+    if (returned == false)
+    {
+        Error::send("Function call interrupted by signal " + std::to_string(info));
+    }
+
+    return res;
+}
+
 std::vector<std::uint8_t>
 Process::read_memory_without_traps(virt_addr address, std::size_t size) const
 {
@@ -586,7 +2238,7 @@ Process::get_instructions(virt_addr addr, std::size_t count)
     for (i = 0; i < count; i+=2)
     {
         errno = 0;
-        std::uint64_t data = ptrace(PTRACE_PEEKDATA, pid_, addr, nullptr);
+        std::uint64_t data = ptrace(PTRACE_PEEKDATA, current_tid_, addr, nullptr);
         addr += 8;
         if (errno != 0)
         {
@@ -427,6 +427,7 @@ RegisterValue Registers::read(const RegisterInfo* info)
 void Registers::write(const RegisterInfo* info, RegisterValue val)
 {
     std::uint8_t *dest_addr = register_offset(info);
+    dirty_ = true;
     auto func = [&](auto &&arg) -> void
     {
         if (sizeof(arg) > info->size)
@@ -447,6 +448,7 @@ void Registers::write(const RegisterInfo* info, RegisterValue val)
 void Registers::write(const RegisterInfo* info, std::string_view val)
 {
     std::uint8_t *dest_addr = register_offset(info);
+    dirty_ = true;
     RegisterValue parsed_val = parse_register_token(info, val);
     auto func = [&](auto &&arg) -> void
     {
@@ -0,0 +1,132 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "scratch_allocator.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace
+{
+    // Raw syscall returns in [-4095, -1] are negated errno values
+    bool syscall_failed(std::uint64_t ret)
+    {
+        return ret > static_cast<std::uint64_t>(-4096);
+    }
+
+    std::size_t align_up(std::size_t val, std::size_t align)
+    {
+        return (val + align - 1) & ~(align - 1);
+    }
+}
+
+virt_addr ScratchAllocator::allocate(std::size_t size, std::size_t align)
+{
+    if (size == 0)
+        Error::send("Cannot allocate zero bytes of scratch memory");
+
+    if (align == 0 || (align & (align - 1)) != 0)
+        Error::send("Scratch alignment must be a power of two");
+
+    for (auto &region : regions_)
+    {
+        std::size_t offset = align_up(region.used, align);
+        if (offset + size <= region.size)
+        {
+            region.used = offset + size;
+            return region.base + offset;
+        }
+    }
+
+    return map_region(size, align);
+}
+
+virt_addr ScratchAllocator::trap_address()
+{
+    if (stub_addr_ == 0)
+        map_region(0, 1);
+
+    return stub_addr_ + TRAP_OFFSET;
+}
+
+virt_addr ScratchAllocator::map_region(std::size_t size, std::size_t align)
+{
+    const static long PAGE_SIZE = sysconf(_SC_PAGESIZE);
+    if (PAGE_SIZE <= 0)
+    {
+        Error::send_errno("Failed to retrieve page size");
+    }
+
+    // The very first page also hosts the syscall stub used by
+    // later injections, so that text pages are left untouched
+    std::size_t reserve = regions_.empty() ? STUB_SLOT_SIZE : 0;
+    std::size_t offset = align_up(reserve, align);
+    std::size_t length = align_up(std::max<std::size_t>(offset + size, 1), PAGE_SIZE);
+
+    std::uint64_t ret = process_->inject_syscall(SYS_mmap, 0, length,
+        PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (syscall_failed(ret))
+    {
+        errno = static_cast<int>(-ret);
+        Error::send_errno("Injected mmap failed");
+    }
+
+    regions_.push_back({ret, length, offset + size});
+    if (reserve)
+        stub_addr_ = ret;
+
+    return ret + offset;
+}
+
+void ScratchAllocator::release()
+{
+    // Clear the stub first, munmap of the stub page itself must
+    // not be executed from inside the page being unmapped
+    stub_addr_ = 0;
+
+    for (auto &region : regions_)
+    {
+        std::uint64_t ret = process_->inject_syscall(SYS_munmap,
+            region.base, region.size);
+        if (syscall_failed(ret))
+        {
+            errno = static_cast<int>(-ret);
+            Error::send_errno("Injected munmap failed");
+        }
+    }
+
+    regions_.clear();
+}
+
+std::size_t ScratchAllocator::mapped_size() const
+{
+    std::size_t total = 0;
+    for (auto &region : regions_)
+        total += region.size;
+    return total;
+}
@@ -0,0 +1,177 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "session.hpp"
+#include "error.hpp"
+
+#include <vector>
+#include <sys/wait.h>
+
+bool Session::ended(const Process &proc)
+{
+    return proc.get_state() == ProcessState::Exited ||
+           proc.get_state() == ProcessState::Terminated;
+}
+
+void Session::install_fork_handler(Process &proc)
+{
+    // Children inherit the seccomp filter of a launch, detached every
+    // call it traces would fail with ENOSYS, so they are always followed
+    if (policy_ == ForkPolicy::Follow || proc.syscalls().filtered().empty() == false)
+        proc.set_fork_handler([this](ProcessPtr child) { follow(std::move(child)); });
+    else
+        proc.set_fork_handler(nullptr);
+}
+
+Process &Session::add(ProcessPtr proc)
+{
+    pid_t pid = proc->get_pid();
+    install_fork_handler(*proc);
+
+    Process *raw = proc.get();
+    proc->set_signal_observer([this, raw](pid_t tid, int signo)
+    {
+        if (on_signal_)
+            on_signal_(*raw, tid, signo);
+    });
+
+    // A recycled pid replaces the process that ended with it
+    ProcessPtr &slot = processes_[pid];
+    slot = std::move(proc);
+    if (processes_.size() == 1)
+        current_ = pid;
+
+    return *slot;
+}
+
+void Session::set_fork_policy(ForkPolicy policy)
+{
+    policy_ = policy;
+    for (auto &[pid, proc] : processes_)
+    {
+        install_fork_handler(*proc);
+    }
+}
+
+void Session::follow(ProcessPtr child)
+{
+    Process &proc = add(std::move(child));
+    if (on_follow_)
+        on_follow_(proc);
+
+    proc.resume();
+}
+
+void Session::select(pid_t pid)
+{
+    if (processes_.count(pid) == 0)
+    {
+        Error::send("No such process " + std::to_string(pid));
+    }
+    current_ = pid;
+}
+
+std::optional<std::uint8_t> Session::try_wait()
+{
+    // Start after the current process so a busy one cannot starve the rest,
+    // followed children added meanwhile are polled by the next call
+    std::vector<pid_t> order;
+    auto start = processes_.upper_bound(current_);
+    for (auto it = start; it != processes_.end(); ++it)
+        order.push_back(it->first);
+    for (auto it = processes_.begin(); it != start; ++it)
+        order.push_back(it->first);
+
+    // A process may reap the events of another one, which are kept aside
+    // for their owner, a second quiet pass leaves none of them behind
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (pid_t pid : order)
+        {
+            auto it = processes_.find(pid);
+            if (it == processes_.end() || ended(*it->second))
+                continue;
+
+            if (auto ret = it->second->try_wait())
+            {
+                current_ = pid;
+                return ret;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::uint8_t Session::wait()
+{
+    while (true)
+    {
+        if (auto ret = try_wait())
+            return *ret;
+
+        // Sleeps until any tracee has news, leaving it queued for try_wait
+        siginfo_t info;
+        if (waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOWAIT | __WALL | __WNOTHREAD) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            Error::send_errno("waitid() failed");
+        }
+    }
+}
+
+bool Session::alive() const
+{
+    for (const auto &[pid, proc] : processes_)
+    {
+        if (ended(*proc) == false)
+            return true;
+    }
+    return false;
+}
+
+bool Session::prune()
+{
+    if (alive() == false)
+        return false;
+
+    bool current_ended = false;
+    for (auto it = processes_.begin(); it != processes_.end();)
+    {
+        if (ended(*it->second) == false)
+        {
+            ++it;
+            continue;
+        }
+
+        current_ended |= (it->first == current_);
+        it = processes_.erase(it);
+    }
+
+    if (current_ended)
+        current_ = processes_.begin()->first;
+
+    return current_ended;
+}
@@ -0,0 +1,194 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "session_manager.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <unistd.h>
+
+std::vector<std::string>
+SessionManager::attach(const std::vector<pid_t> &pids, bool seize)
+{
+    // Every tracer attaches from its own thread, all at the same time
+    std::vector<std::unique_ptr<Tracer>> fresh;
+    std::vector<std::future<void>> results;
+    for (pid_t pid : pids)
+    {
+        fresh.push_back(std::make_unique<Tracer>(events_));
+        results.push_back(fresh.back()->post([pid, seize](Session &session)
+        {
+            session.add(Process::attach(pid, seize));
+        }));
+    }
+
+    std::vector<std::string> errors;
+    for (std::size_t i = 0; i < fresh.size(); i++)
+    {
+        try
+        {
+            results[i].get();
+            tracers_.push_back(std::move(fresh[i]));
+        }
+        catch (const Error &err)
+        {
+            errors.push_back("Process " + std::to_string(pids[i]) + ": " + err.what());
+        }
+    }
+
+    return errors;
+}
+
+Tracer &SessionManager::launch(std::vector<std::string_view> &exec_args,
+    const LaunchOptions &options)
+{
+    // The tracer thread forks the tracee, which makes it the tracer
+    auto tracer = std::make_unique<Tracer>(events_);
+    tracer->run([&](Session &session)
+    {
+        session.add(Process::launch(exec_args, options));
+    });
+
+    tracers_.push_back(std::move(tracer));
+    return *tracers_.back();
+}
+
+std::vector<pid_t> SessionManager::find_pids(std::string_view pattern)
+{
+    std::regex regex;
+    try
+    {
+        regex.assign(pattern.begin(), pattern.end());
+    }
+    catch (const std::regex_error &)
+    {
+        Error::send("Invalid process pattern " + std::string(pattern));
+    }
+
+    std::vector<pid_t> pids;
+    pid_t self = getpid();
+    for (const auto &entry : std::filesystem::directory_iterator("/proc"))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.find_first_not_of("0123456789") != std::string::npos)
+            continue;
+
+        pid_t pid = std::stoi(name);
+        if (pid == self)
+            continue;
+
+        // Arguments are NUL separated, processes gone meanwhile read empty
+        std::ifstream file(entry.path() / "cmdline", std::ios::binary);
+        std::string cmdline{std::istreambuf_iterator<char>(file), {}};
+        std::replace(cmdline.begin(), cmdline.end(), '\0', ' ');
+        while (cmdline.empty() == false && cmdline.back() == ' ')
+            cmdline.pop_back();
+
+        // Kernel threads have no command line, their name stands in
+        if (cmdline.empty())
+        {
+            std::ifstream comm(entry.path() / "comm");
+            std::getline(comm, cmdline);
+        }
+
+        if (std::regex_search(cmdline, regex))
+            pids.push_back(pid);
+    }
+
+    std::sort(pids.begin(), pids.end());
+    return pids;
+}
+
+void SessionManager::select(const Tracer &tracer)
+{
+    for (std::size_t i = 0; i < tracers_.size(); i++)
+    {
+        if (tracers_[i].get() == &tracer)
+        {
+            current_ = i;
+            return;
+        }
+    }
+
+    Error::send("Tracer does not belong to this session");
+}
+
+Tracer *SessionManager::find(pid_t pid)
+{
+    for (auto &tracer : tracers_)
+    {
+        bool found = tracer->run([pid](Session &session)
+        {
+            return session.processes().count(pid) != 0;
+        });
+
+        if (found)
+            return tracer.get();
+    }
+
+    return nullptr;
+}
+
+void SessionManager::poll()
+{
+    for (auto &tracer : tracers_)
+    {
+        tracer->poll();
+    }
+}
+
+bool SessionManager::prune()
+{
+    auto results = broadcast([](Session &session) { return session.alive(); });
+
+    std::vector<bool> alive;
+    for (auto &result : results)
+        alive.push_back(result.get());
+
+    if (std::find(alive.begin(), alive.end(), true) == alive.end())
+        return false;
+
+    Tracer *current = tracers_.at(current_).get();
+    bool current_dropped = false;
+    std::vector<std::unique_ptr<Tracer>> kept;
+    for (std::size_t i = 0; i < tracers_.size(); i++)
+    {
+        if (alive[i])
+            kept.push_back(std::move(tracers_[i]));
+        else
+            current_dropped |= (tracers_[i].get() == current);
+    }
+
+    // Dropped tracers join their threads on the way out
+    tracers_ = std::move(kept);
+    current_ = 0;
+    if (current_dropped == false)
+        select(*current);
+
+    return current_dropped;
+}
@@ -0,0 +1,317 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "source_stepper.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+
+namespace
+{
+    // Longest stretch of a line searched for its next branch at once
+    constexpr std::size_t SCAN_SIZE = 4096;
+
+    std::int64_t sign_extend(std::uint64_t val, unsigned bits)
+    {
+        std::uint64_t sign = std::uint64_t{1} << (bits - 1);
+        return static_cast<std::int64_t>((val ^ sign) - sign);
+    }
+}
+
+BranchKind classify_branch(std::uint32_t insn, virt_addr pc, virt_addr &target)
+{
+    // B and BL, imm26
+    if ((insn & 0x7C000000) == 0x14000000)
+    {
+        target = pc + sign_extend(insn & 0x03FFFFFF, 26) * 4;
+        return (insn & 0x80000000) ? BranchKind::Call : BranchKind::Direct;
+    }
+
+    // B.cond and BC.cond, CBZ and CBNZ, imm19
+    if ((insn & 0xFF000000) == 0x54000000 || (insn & 0x7E000000) == 0x34000000)
+    {
+        target = pc + sign_extend((insn >> 5) & 0x7FFFF, 19) * 4;
+        return BranchKind::Conditional;
+    }
+
+    // TBZ and TBNZ, imm14
+    if ((insn & 0x7E000000) == 0x36000000)
+    {
+        target = pc + sign_extend((insn >> 5) & 0x3FFF, 14) * 4;
+        return BranchKind::Conditional;
+    }
+
+    // Register branches including the pointer authentication forms
+    if ((insn & 0xFE000000) == 0xD6000000)
+    {
+        switch ((insn >> 21) & 0x7)
+        {
+            case 1:  return BranchKind::CallIndirect;
+            case 2:  return BranchKind::Return;
+            default: return BranchKind::Indirect;
+        }
+    }
+    return BranchKind::None;
+}
+
+std::uint8_t SourceStepper::step_in()
+{
+    return step_line(true);
+}
+
+std::uint8_t SourceStepper::step_over()
+{
+    return step_line(false);
+}
+
+std::uint8_t SourceStepper::step_out()
+{
+    tid_ = process_->current_thread();
+    stops_ = 0;
+
+    auto frames = process_->unwinder().unwind();
+    if (frames.size() < 2)
+        Error::send("No caller frame to return to");
+
+    // The frame is popped once the return address is reached, a deeper
+    // recursive call returning there still has a lower sp
+    std::uint8_t info = SIGTRAP;
+    continue_to({frames[1].pc}, current_sp(), info);
+    return info;
+}
+
+std::uint8_t SourceStepper::step_line(bool into)
+{
+    tid_ = process_->current_thread();
+    stops_ = 0;
+
+    auto entry = process_->source_line(process_->get_pc());
+    if (!entry)
+        Error::send("No line information at pc, use stepi or finish");
+
+    std::string file(entry->file);
+    std::uint32_t line = entry->line;
+    std::uint8_t info = SIGTRAP;
+
+    while (true)
+    {
+        virt_addr pc = process_->get_pc();
+        auto range = line_range(pc);
+        if (!range)
+            return info;
+
+        RangeEnd end = step_range(range->first, range->second, into, info);
+        if (end == RangeEnd::Stopped)
+            return info;
+        if (end == RangeEnd::EnteredCall)
+        {
+            enter_function(info);
+            return info;
+        }
+
+        pc = process_->get_pc();
+        auto now = process_->source_line(pc);
+        if (!now)
+            return info;
+
+        bool new_line = (now->line != line || now->file != file);
+        if (new_line && now->is_stmt && now->address == pc)
+            return info;
+
+        // Returned into the middle of a caller's line, which is finished
+        // before stopping
+        if (new_line)
+        {
+            file = std::string(now->file);
+            line = now->line;
+        }
+    }
+}
+
+SourceStepper::RangeEnd SourceStepper::step_range(virt_addr low, virt_addr high,
+    bool into, std::uint8_t &info)
+{
+    while (true)
+    {
+        virt_addr pc = process_->get_pc();
+        if (pc < low || pc >= high)
+            return RangeEnd::Left;
+
+        // Straight line code runs to the next branch in one go
+        std::size_t size = std::min<virt_addr>(high - pc, SCAN_SIZE);
+        auto code = process_->read_memory_without_traps(pc, size);
+        virt_addr stop_at = pc + size;
+        BranchKind kind = BranchKind::None;
+        for (std::size_t off = 0; off + 4 <= code.size(); off += 4)
+        {
+            std::uint32_t insn;
+            std::memcpy(&insn, &code[off], sizeof(insn));
+            virt_addr target = 0;
+            kind = classify_branch(insn, pc + off, target);
+            if (kind != BranchKind::None)
+            {
+                stop_at = pc + off;
+                break;
+            }
+        }
+
+        if (stop_at != pc)
+        {
+            if (continue_to({stop_at}, 0, info) == false)
+                return RangeEnd::Stopped;
+            continue;
+        }
+
+        if (kind == BranchKind::Call || kind == BranchKind::CallIndirect)
+        {
+            virt_addr sp = current_sp();
+            if (into)
+            {
+                if (single_step(info) == false)
+                    return RangeEnd::Stopped;
+                if (process_->source_line(process_->get_pc()))
+                    return RangeEnd::EnteredCall;
+            }
+
+            // The callee runs freely, recursion back into this line stops
+            // at the return address with a lower sp and is let through
+            if (continue_to({pc + 4}, sp, info) == false)
+                return RangeEnd::Stopped;
+            continue;
+        }
+
+        if (single_step(info) == false)
+            return RangeEnd::Stopped;
+    }
+}
+
+// Stops past the prologue of a function just entered, where arguments
+// and locals are in place, when its first line ends within the function
+bool SourceStepper::enter_function(std::uint8_t &info)
+{
+    virt_addr pc = process_->get_pc();
+    auto sym = process_->symbolize(pc);
+    if (!sym || sym->second != 0)
+        return true;
+
+    auto range = line_range(pc);
+    virt_addr end = pc + sym->first->size;
+    if (!range || range->second <= pc || range->second >= end)
+        return true;
+    return continue_to({range->second}, 0, info);
+}
+
+bool SourceStepper::continue_to(const std::vector<virt_addr> &targets, virt_addr min_sp,
+    std::uint8_t &info)
+{
+    auto &sites = process_->breakpoint_sites();
+    std::vector<virt_addr> created;
+    std::vector<virt_addr> enabled;
+    for (virt_addr addr : targets)
+    {
+        if (sites.contains_address(addr) == false)
+        {
+            process_->create_breakpoint_site(addr, false, true).enable();
+            created.push_back(addr);
+        }
+        else if (sites.get_by_address(addr).is_enabled() == false)
+        {
+            sites.get_by_address(addr).enable();
+            enabled.push_back(addr);
+        }
+    }
+
+    // Sites of a process that ended went away with its memory
+    auto cleanup = [&]()
+    {
+        ProcessState state = process_->get_state();
+        if (state == ProcessState::Exited || state == ProcessState::Terminated)
+            return;
+        for (virt_addr addr : created)
+            sites.remove_by_address(addr);
+        for (virt_addr addr : enabled)
+            sites.get_by_address(addr).disable();
+    };
+
+    try
+    {
+        while (true)
+        {
+            process_->resume();
+            info = process_->wait();
+            stops_++;
+            if (process_->get_state() != ProcessState::Stopped ||
+                process_->stop_reason() != StopReason::Signal || info != SIGTRAP)
+                break;
+
+            virt_addr pc = process_->get_pc();
+            if (std::find(targets.begin(), targets.end(), pc) == targets.end())
+                break;
+
+            // Another thread ran into the breakpoint, or a deeper frame
+            if (process_->current_thread() != tid_ || current_sp() < min_sp)
+                continue;
+
+            cleanup();
+            return true;
+        }
+    }
+    catch (const Error &)
+    {
+        cleanup();
+        throw;
+    }
+
+    cleanup();
+    return false;
+}
+
+bool SourceStepper::single_step(std::uint8_t &info)
+{
+    info = process_->step_instruction();
+    stops_++;
+    return process_->get_state() == ProcessState::Stopped &&
+        process_->stop_reason() == StopReason::Signal && info == SIGTRAP;
+}
+
+virt_addr SourceStepper::current_sp() const
+{
+    return process_->frame_registers(process_->current_thread()).sp;
+}
+
+std::optional<std::pair<virt_addr, virt_addr>> SourceStepper::line_range(virt_addr pc) const
+{
+    LineTable *lines = process_->line_table();
+    const Elf *elf = process_->elf();
+    if (lines == nullptr || elf == nullptr || pc < elf->load_bias())
+        return std::nullopt;
+
+    auto range = lines->line_range(pc - elf->load_bias());
+    if (!range)
+        return std::nullopt;
+    return std::make_pair(range->first + elf->load_bias(), range->second + elf->load_bias());
+}
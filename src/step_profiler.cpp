@@ -0,0 +1,181 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "step_profiler.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Fibonacci hashing spreads the 4 byte aligned pcs over the table
+    std::size_t hash_pc(virt_addr pc)
+    {
+        return static_cast<std::size_t>((pc >> 2) * 0x9E3779B97F4A7C15ull);
+    }
+
+    bool is_literal_load(std::uint32_t insn)
+    {
+        return (insn & 0x3B000000) == 0x18000000;
+    }
+}
+
+// Top level decode on op0, bits [28:25] of the instruction
+InsnClass classify_instruction(std::uint32_t insn)
+{
+    std::uint32_t op0 = (insn >> 25) & 0xF;
+
+    if ((op0 & 0x5) == 0x4)
+    {
+        // Bit 22 is the load flag of nearly every load/store encoding
+        if (is_literal_load(insn) || (insn & (1u << 22)))
+            return InsnClass::Load;
+        return InsnClass::Store;
+    }
+
+    if ((op0 & 0xE) == 0xA)
+    {
+        // Exception generation, hints, barriers and system registers
+        if ((insn >> 24) == 0xD4 || (insn & 0xFFC00000) == 0xD5000000)
+            return InsnClass::System;
+        return InsnClass::Branch;
+    }
+
+    if ((op0 & 0x7) == 0x7)
+        return InsnClass::Simd;
+
+    return InsnClass::Other;
+}
+
+std::string_view insn_class_name(InsnClass cls)
+{
+    switch (cls)
+    {
+        case InsnClass::Load:   return "load";
+        case InsnClass::Store:  return "store";
+        case InsnClass::Branch: return "branch";
+        case InsnClass::Simd:   return "simd/fp";
+        case InsnClass::System: return "system";
+        default:                return "other";
+    }
+}
+
+PcHistogram::PcHistogram(std::size_t capacity)
+{
+    std::size_t size = 16;
+    while (size < capacity)
+        size <<= 1;
+    slots_.resize(size);
+}
+
+std::size_t PcHistogram::slot_of(virt_addr pc) const
+{
+    std::size_t mask = slots_.size() - 1;
+    std::size_t idx = hash_pc(pc) & mask;
+    while (slots_[idx].pc != 0 && slots_[idx].pc != pc)
+        idx = (idx + 1) & mask;
+    return idx;
+}
+
+PcHistogram::Entry &PcHistogram::find_or_insert(virt_addr pc, bool &inserted)
+{
+    if (pc == 0)
+        Error::send("Cannot record an instruction at address 0");
+
+    // Kept at most half full so probe sequences stay short
+    if ((size_ + 1) * 2 > slots_.size())
+        grow();
+
+    Entry &entry = slots_[slot_of(pc)];
+    inserted = (entry.pc == 0);
+    if (inserted)
+    {
+        entry.pc = pc;
+        size_++;
+    }
+    return entry;
+}
+
+const PcHistogram::Entry *PcHistogram::find(virt_addr pc) const
+{
+    if (pc == 0)
+        return nullptr;
+
+    const Entry &entry = slots_[slot_of(pc)];
+    return (entry.pc == pc) ? &entry : nullptr;
+}
+
+void PcHistogram::grow()
+{
+    std::vector<Entry> old(slots_.size() * 2);
+    old.swap(slots_);
+    for (const Entry &entry : old)
+    {
+        if (entry.pc != 0)
+            slots_[slot_of(entry.pc)] = entry;
+    }
+}
+
+std::vector<PcHistogram::Entry> PcHistogram::sorted() const
+{
+    std::vector<Entry> entries;
+    entries.reserve(size_);
+    for (const Entry &entry : slots_)
+    {
+        if (entry.pc != 0)
+            entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry &a, const Entry &b)
+        {
+            if (a.count != b.count)
+                return a.count > b.count;
+            return a.pc < b.pc;
+        });
+    return entries;
+}
+
+StepResult StepProfiler::run(const StepLimits &limits)
+{
+    auto observer = [this](virt_addr pc)
+    {
+        bool inserted = false;
+        PcHistogram::Entry &entry = histogram_.find_or_insert(pc, inserted);
+        if (inserted)
+        {
+            auto code = process_->read_memory_without_traps(pc, 4);
+            std::uint32_t insn = 0;
+            std::memcpy(&insn, code.data(), std::min(code.size(), sizeof(insn)));
+            entry.cls = classify_instruction(insn);
+        }
+
+        entry.count++;
+        mix_[static_cast<std::size_t>(entry.cls)]++;
+        total_++;
+    };
+
+    return process_->step_instructions(limits, observer);
+}
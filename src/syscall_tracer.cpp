@@ -0,0 +1,432 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "syscall_tracer.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <sys/ptrace.h>
+#include <linux/audit.h>
+#include <linux/seccomp.h>
+
+namespace
+{
+    struct SyscallName
+    {
+        std::string_view name;
+        int args;
+    };
+
+    // include/uapi/asm-generic/unistd.h, 244-259 are left to architectures
+    constexpr SyscallName generic_table[] = {
+        {"io_setup", 2}, {"io_destroy", 1}, {"io_submit", 3}, {"io_cancel", 3},
+        {"io_getevents", 5}, {"setxattr", 5}, {"lsetxattr", 5}, {"fsetxattr", 5},
+        {"getxattr", 4}, {"lgetxattr", 4}, {"fgetxattr", 4}, {"listxattr", 3},
+        {"llistxattr", 3}, {"flistxattr", 3}, {"removexattr", 2}, {"lremovexattr", 2},
+        {"fremovexattr", 2}, {"getcwd", 2}, {"lookup_dcookie", 3}, {"eventfd2", 2},
+        {"epoll_create1", 1}, {"epoll_ctl", 4}, {"epoll_pwait", 6}, {"dup", 1},
+        {"dup3", 3}, {"fcntl", 3}, {"inotify_init1", 1}, {"inotify_add_watch", 3},
+        {"inotify_rm_watch", 2}, {"ioctl", 3}, {"ioprio_set", 3}, {"ioprio_get", 2},
+        {"flock", 2}, {"mknodat", 4}, {"mkdirat", 3}, {"unlinkat", 3},
+        {"symlinkat", 3}, {"linkat", 5}, {"renameat", 4}, {"umount2", 2},
+        {"mount", 5}, {"pivot_root", 2}, {"nfsservctl", 3}, {"statfs", 2},
+        {"fstatfs", 2}, {"truncate", 2}, {"ftruncate", 2}, {"fallocate", 4},
+        {"faccessat", 3}, {"chdir", 1}, {"fchdir", 1}, {"chroot", 1},
+        {"fchmod", 2}, {"fchmodat", 3}, {"fchownat", 5}, {"fchown", 3},
+        {"openat", 4}, {"close", 1}, {"vhangup", 0}, {"pipe2", 2},
+        {"quotactl", 4}, {"getdents64", 3}, {"lseek", 3}, {"read", 3},
+        {"write", 3}, {"readv", 3}, {"writev", 3}, {"pread64", 4},
+        {"pwrite64", 4}, {"preadv", 5}, {"pwritev", 5}, {"sendfile", 4},
+        {"pselect6", 6}, {"ppoll", 5}, {"signalfd4", 4}, {"vmsplice", 4},
+        {"splice", 6}, {"tee", 4}, {"readlinkat", 4}, {"newfstatat", 4},
+        {"fstat", 2}, {"sync", 0}, {"fsync", 1}, {"fdatasync", 1},
+        {"sync_file_range", 4}, {"timerfd_create", 2}, {"timerfd_settime", 4}, {"timerfd_gettime", 2},
+        {"utimensat", 4}, {"acct", 1}, {"capget", 2}, {"capset", 2},
+        {"personality", 1}, {"exit", 1}, {"exit_group", 1}, {"waitid", 5},
+        {"set_tid_address", 1}, {"unshare", 1}, {"futex", 6}, {"set_robust_list", 2},
+        {"get_robust_list", 3}, {"nanosleep", 2}, {"getitimer", 2}, {"setitimer", 3},
+        {"kexec_load", 4}, {"init_module", 3}, {"delete_module", 2}, {"timer_create", 3},
+        {"timer_gettime", 2}, {"timer_getoverrun", 1}, {"timer_settime", 4}, {"timer_delete", 1},
+        {"clock_settime", 2}, {"clock_gettime", 2}, {"clock_getres", 2}, {"clock_nanosleep", 4},
+        {"syslog", 3}, {"ptrace", 4}, {"sched_setparam", 2}, {"sched_setscheduler", 3},
+        {"sched_getscheduler", 1}, {"sched_getparam", 2}, {"sched_setaffinity", 3}, {"sched_getaffinity", 3},
+        {"sched_yield", 0}, {"sched_get_priority_max", 1}, {"sched_get_priority_min", 1}, {"sched_rr_get_interval", 2},
+        {"restart_syscall", 0}, {"kill", 2}, {"tkill", 2}, {"tgkill", 3},
+        {"sigaltstack", 2}, {"rt_sigsuspend", 2}, {"rt_sigaction", 4}, {"rt_sigprocmask", 4},
+        {"rt_sigpending", 2}, {"rt_sigtimedwait", 4}, {"rt_sigqueueinfo", 3}, {"rt_sigreturn", 0},
+        {"setpriority", 3}, {"getpriority", 2}, {"reboot", 4}, {"setregid", 2},
+        {"setgid", 1}, {"setreuid", 2}, {"setuid", 1}, {"setresuid", 3},
+        {"getresuid", 3}, {"setresgid", 3}, {"getresgid", 3}, {"setfsuid", 1},
+        {"setfsgid", 1}, {"times", 1}, {"setpgid", 2}, {"getpgid", 1},
+        {"getsid", 1}, {"setsid", 0}, {"getgroups", 2}, {"setgroups", 2},
+        {"uname", 1}, {"sethostname", 2}, {"setdomainname", 2}, {"getrlimit", 2},
+        {"setrlimit", 2}, {"getrusage", 2}, {"umask", 1}, {"prctl", 5},
+        {"getcpu", 3}, {"gettimeofday", 2}, {"settimeofday", 2}, {"adjtimex", 1},
+        {"getpid", 0}, {"getppid", 0}, {"getuid", 0}, {"geteuid", 0},
+        {"getgid", 0}, {"getegid", 0}, {"gettid", 0}, {"sysinfo", 1},
+        {"mq_open", 4}, {"mq_unlink", 1}, {"mq_timedsend", 5}, {"mq_timedreceive", 5},
+        {"mq_notify", 2}, {"mq_getsetattr", 3}, {"msgget", 2}, {"msgctl", 3},
+        {"msgrcv", 5}, {"msgsnd", 4}, {"semget", 3}, {"semctl", 4},
+        {"semtimedop", 4}, {"semop", 3}, {"shmget", 3}, {"shmctl", 3},
+        {"shmat", 3}, {"shmdt", 1}, {"socket", 3}, {"socketpair", 4},
+        {"bind", 3}, {"listen", 2}, {"accept", 3}, {"connect", 3},
+        {"getsockname", 3}, {"getpeername", 3}, {"sendto", 6}, {"recvfrom", 6},
+        {"setsockopt", 5}, {"getsockopt", 5}, {"shutdown", 2}, {"sendmsg", 3},
+        {"recvmsg", 3}, {"readahead", 3}, {"brk", 1}, {"munmap", 2},
+        {"mremap", 5}, {"add_key", 5}, {"request_key", 4}, {"keyctl", 5},
+        {"clone", 5}, {"execve", 3}, {"mmap", 6}, {"fadvise64", 4},
+        {"swapon", 2}, {"swapoff", 1}, {"mprotect", 3}, {"msync", 3},
+        {"mlock", 2}, {"munlock", 2}, {"mlockall", 1}, {"munlockall", 0},
+        {"mincore", 3}, {"madvise", 3}, {"remap_file_pages", 5}, {"mbind", 6},
+        {"get_mempolicy", 5}, {"set_mempolicy", 3}, {"migrate_pages", 4}, {"move_pages", 6},
+        {"rt_tgsigqueueinfo", 4}, {"perf_event_open", 5}, {"accept4", 4}, {"recvmmsg", 5},
+        {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {},
+        {"wait4", 4}, {"prlimit64", 4}, {"fanotify_init", 2}, {"fanotify_mark", 5},
+        {"name_to_handle_at", 5}, {"open_by_handle_at", 3}, {"clock_adjtime", 2}, {"syncfs", 1},
+        {"setns", 2}, {"sendmmsg", 4}, {"process_vm_readv", 6}, {"process_vm_writev", 6},
+        {"kcmp", 5}, {"finit_module", 3}, {"sched_setattr", 3}, {"sched_getattr", 4},
+        {"renameat2", 5}, {"seccomp", 3}, {"getrandom", 3}, {"memfd_create", 2},
+        {"bpf", 3}, {"execveat", 5}, {"userfaultfd", 1}, {"membarrier", 3},
+        {"mlock2", 3}, {"copy_file_range", 6}, {"preadv2", 6}, {"pwritev2", 6},
+        {"pkey_mprotect", 4}, {"pkey_alloc", 2}, {"pkey_free", 1}, {"statx", 5},
+        {"io_pgetevents", 6}, {"rseq", 4}, {"kexec_file_load", 5},
+    };
+
+    // The range past the 32-bit time64 calls
+    constexpr int NEWER_BASE = 424;
+    constexpr SyscallName newer_table[] = {
+        {"pidfd_send_signal", 4}, {"io_uring_setup", 2}, {"io_uring_enter", 6}, {"io_uring_register", 4},
+        {"open_tree", 3}, {"move_mount", 5}, {"fsopen", 2}, {"fsconfig", 5},
+        {"fsmount", 3}, {"fspick", 3}, {"pidfd_open", 2}, {"clone3", 2},
+        {"close_range", 3}, {"openat2", 4}, {"pidfd_getfd", 3}, {"faccessat2", 4},
+        {"process_madvise", 5}, {"epoll_pwait2", 6}, {"mount_setattr", 5}, {"quotactl_fd", 4},
+        {"landlock_create_ruleset", 3}, {"landlock_add_rule", 4}, {"landlock_restrict_self", 2}, {"memfd_secret", 1},
+        {"process_mrelease", 2}, {"futex_waitv", 5}, {"set_mempolicy_home_node", 4}, {"cachestat", 4},
+    };
+
+    constexpr int GENERIC_COUNT = sizeof(generic_table) / sizeof(generic_table[0]);
+    constexpr int NEWER_COUNT = sizeof(newer_table) / sizeof(newer_table[0]);
+
+    const SyscallName *lookup(int number)
+    {
+        if (number >= 0 && number < GENERIC_COUNT)
+            return &generic_table[number];
+        if (number >= NEWER_BASE && number < NEWER_BASE + NEWER_COUNT)
+            return &newer_table[number - NEWER_BASE];
+        return nullptr;
+    }
+
+    // struct ptrace_syscall_info of the kernel, not every libc carries it
+    struct SyscallInfo
+    {
+        struct Entry
+        {
+            std::uint64_t nr;
+            std::uint64_t args[6];
+        };
+        struct Exit
+        {
+            std::int64_t rval;
+            std::uint8_t is_error;
+        };
+        struct Seccomp
+        {
+            std::uint64_t nr;
+            std::uint64_t args[6];
+            std::uint32_t ret_data;
+        };
+
+        std::uint8_t op;
+        std::uint8_t pad[3];
+        std::uint32_t arch;
+        std::uint64_t instruction_pointer;
+        std::uint64_t stack_pointer;
+        union
+        {
+            Entry entry;
+            Exit exit;
+            Seccomp seccomp;
+        };
+    };
+
+    constexpr std::uint8_t INFO_EXIT = 2;
+    constexpr std::uint8_t INFO_SECCOMP = 3;
+
+    std::optional<SyscallInfo> syscall_info(pid_t tid)
+    {
+        SyscallInfo info{};
+        if (ptrace(static_cast<__ptrace_request>(PTRACE_GET_SYSCALL_INFO), tid,
+                sizeof(info), &info) <= 0)
+            return std::nullopt;
+        return info;
+    }
+}
+
+void LatencyHistogram::add(std::uint64_t ns)
+{
+    std::size_t bucket = 0;
+    for (std::uint64_t rest = ns >> 1; rest != 0 && bucket + 1 < BUCKETS; rest >>= 1)
+        bucket++;
+
+    buckets[bucket]++;
+    count++;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (count == 0)
+        return 0;
+
+    auto wanted = static_cast<std::uint64_t>(fraction * static_cast<double>(count));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen > wanted || seen == count)
+            return std::min(std::uint64_t(2) << i, max_ns);
+    }
+    return max_ns;
+}
+
+bool SyscallProfile::moves_data(int number)
+{
+    static const std::string_view names[] = {
+        "read", "write", "readv", "writev", "pread64", "pwrite64",
+        "preadv", "pwritev", "preadv2", "pwritev2",
+        "sendto", "recvfrom", "sendmsg", "recvmsg", "sendmmsg", "recvmmsg",
+    };
+    std::string_view name = SyscallTracer::name(number);
+    return name.empty() == false && std::find(std::begin(names), std::end(names), name) != std::end(names);
+}
+
+void SyscallProfile::add(const SyscallRecord &record)
+{
+    if (!record.ret)
+        return;
+
+    auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(record.left - record.entered);
+    auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(took.count(), 0));
+    by_number_[record.number].add(ns);
+
+    if (moves_data(record.number) == false)
+        return;
+
+    // The mmsg calls return messages, not bytes
+    FdStats &fd = by_fd_[{static_cast<int>(record.args[0]), record.number}];
+    fd.latency.add(ns);
+    std::int64_t ret = *record.ret;
+    if (ret < 0 && ret >= -4095)
+        fd.errors++;
+    else if (SyscallTracer::name(record.number).find("mmsg") == std::string_view::npos)
+        fd.bytes += static_cast<std::uint64_t>(ret);
+}
+
+void SyscallProfile::clear()
+{
+    by_number_.clear();
+    by_fd_.clear();
+}
+
+std::optional<int> SyscallTracer::number(std::string_view name)
+{
+    for (int i = 0; i < GENERIC_COUNT; i++)
+    {
+        if (generic_table[i].name.empty() == false && generic_table[i].name == name)
+            return i;
+    }
+    for (int i = 0; i < NEWER_COUNT; i++)
+    {
+        if (newer_table[i].name == name)
+            return NEWER_BASE + i;
+    }
+    return std::nullopt;
+}
+
+std::string_view SyscallTracer::name(int number)
+{
+    const SyscallName *entry = lookup(number);
+    return entry != nullptr ? entry->name : std::string_view{};
+}
+
+int SyscallTracer::arg_count(int number)
+{
+    const SyscallName *entry = lookup(number);
+    return (entry != nullptr && entry->name.empty() == false) ? entry->args : 6;
+}
+
+std::vector<int> SyscallTracer::parse(std::string_view names)
+{
+    std::vector<int> numbers;
+    while (names.empty() == false)
+    {
+        std::size_t comma = names.find(',');
+        std::string_view token = names.substr(0, comma);
+        auto nr = number(token);
+        if (!nr)
+            Error::send("Unknown system call " + std::string(token));
+        if (std::find(numbers.begin(), numbers.end(), *nr) == numbers.end())
+            numbers.push_back(*nr);
+
+        if (comma == std::string_view::npos)
+            break;
+        names = names.substr(comma + 1);
+    }
+    return numbers;
+}
+
+std::vector<int> SyscallTracer::traceable(const std::vector<int> &numbers)
+{
+    std::vector<int> traced;
+    for (int nr : numbers)
+    {
+        if (name(nr) != "execve" && name(nr) != "execveat")
+            traced.push_back(nr);
+    }
+    return traced;
+}
+
+std::vector<sock_filter> SyscallTracer::filter(const std::vector<int> &numbers)
+{
+    std::vector<int> traced = traceable(numbers);
+
+    // Jump offsets are 8 bits wide
+    if (traced.size() > 255)
+        Error::send("Too many system calls to trace");
+
+    std::vector<sock_filter> prog;
+    prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)));
+    prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, AUDIT_ARCH_AARCH64, 1, 0));
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    prog.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)));
+
+    // Each match jumps past the remaining tests and the allow to the trace
+    auto count = static_cast<std::uint8_t>(traced.size());
+    for (std::uint8_t i = 0; i < count; i++)
+    {
+        prog.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+            static_cast<std::uint32_t>(traced[i]), static_cast<std::uint8_t>(count - i), 0));
+    }
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    prog.push_back(BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRACE));
+    return prog;
+}
+
+void SyscallTracer::enable(std::vector<int> select)
+{
+    if (filtered_.empty())
+        Error::send("Process was launched without a system call filter");
+
+    for (int nr : select)
+    {
+        if (std::find(filtered_.begin(), filtered_.end(), nr) == filtered_.end())
+            Error::send("System call " + std::string(name(nr)) + " is not in the filter");
+    }
+    selected_ = std::move(select);
+    enabled_ = true;
+}
+
+void SyscallTracer::inherit(const SyscallTracer &parent)
+{
+    filtered_ = parent.filtered_;
+    selected_ = parent.selected_;
+    enabled_ = parent.enabled_;
+}
+
+bool SyscallTracer::selected(int number) const
+{
+    return selected_.empty() ||
+        std::find(selected_.begin(), selected_.end(), number) != selected_.end();
+}
+
+std::vector<SyscallRecord> SyscallTracer::take()
+{
+    std::vector<SyscallRecord> taken(std::make_move_iterator(records_.begin()),
+        std::make_move_iterator(records_.end()));
+    records_.clear();
+    return taken;
+}
+
+void SyscallTracer::push(SyscallRecord record)
+{
+    if (records_.size() == CAPACITY)
+    {
+        records_.pop_front();
+        dropped_++;
+    }
+    records_.push_back(std::move(record));
+}
+
+void SyscallTracer::enter(ThreadState &thread)
+{
+    // A call whose return was missed, stepped over say, is kept as is
+    auto open = open_.find(thread.tid);
+    if (open != open_.end())
+    {
+        push(std::move(open->second));
+        open_.erase(open);
+    }
+
+    if (enabled_ == false)
+        return;
+
+    auto info = syscall_info(thread.tid);
+    if (!info || info->op != INFO_SECCOMP)
+        return;
+
+    int nr = static_cast<int>(info->seccomp.nr);
+    if (selected(nr) == false)
+        return;
+
+    SyscallRecord record;
+    record.tid = thread.tid;
+    record.number = nr;
+    std::copy(std::begin(info->seccomp.args), std::end(info->seccomp.args), record.args.begin());
+    record.entered = std::chrono::steady_clock::now();
+    open_.emplace(thread.tid, std::move(record));
+
+    thread.syscall_exit = true;
+}
+
+void SyscallTracer::leave(ThreadState &thread)
+{
+    thread.syscall_exit = false;
+
+    auto open = open_.find(thread.tid);
+    if (open == open_.end())
+        return;
+
+    // Entry stops only show up when the exit was missed
+    auto info = syscall_info(thread.tid);
+    if (!info || info->op != INFO_EXIT)
+        return;
+
+    open->second.ret = info->exit.rval;
+    open->second.left = std::chrono::steady_clock::now();
+    profile_.add(open->second);
+    push(std::move(open->second));
+    open_.erase(open);
+}
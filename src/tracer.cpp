@@ -0,0 +1,160 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "tracer.hpp"
+#include "error.hpp"
+
+#include <csignal>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventQueue::EventQueue()
+{
+    fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd_ < 0)
+    {
+        Error::send_errno("eventfd() failed");
+    }
+}
+
+EventQueue::~EventQueue()
+{
+    close(fd_);
+}
+
+void EventQueue::push(TraceEvent event)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(std::move(event));
+    }
+
+    std::uint64_t one = 1;
+    ssize_t ret = write(fd_, &one, sizeof(one));
+    (void) ret;
+}
+
+std::optional<TraceEvent> EventQueue::pop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (events_.empty())
+        return std::nullopt;
+
+    TraceEvent event = std::move(events_.front());
+    events_.pop_front();
+    return event;
+}
+
+void EventQueue::clear_fd()
+{
+    std::uint64_t count = 0;
+    ssize_t ret = read(fd_, &count, sizeof(count));
+    (void) ret;
+}
+
+Tracer::Tracer(EventQueue &queue) :
+    queue_(queue), session_(new Session)
+{
+    session_->on_follow([this](Process &child)
+    {
+        queue_.push({TraceEventKind::Follow, this, child.get_pid(), 0, {}});
+    });
+
+    session_->on_signal([this](Process &proc, pid_t tid, int signo)
+    {
+        queue_.push({TraceEventKind::Signal, this, proc.get_pid(),
+            static_cast<std::uint8_t>(signo), {}, tid});
+    });
+
+    // SIGCHLD of our tracees is aimed at this thread, blocking it here
+    // leaves it pending for whichever thread waits for it with signalfd
+    sigset_t mask, saved;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &mask, &saved);
+    thread_ = std::thread([this]() { loop(); });
+    pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+}
+
+Tracer::~Tracer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    ready_.notify_one();
+    thread_.join();
+}
+
+void Tracer::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void Tracer::poll()
+{
+    // One queued poll collects everything, more would only find nothing
+    if (poll_queued_.exchange(true))
+        return;
+
+    enqueue([this]()
+    {
+        poll_queued_ = false;
+        try
+        {
+            while (auto info = session_->try_wait())
+                queue_.push({TraceEventKind::Stop, this, session_->current()->get_pid(), *info, {}});
+        }
+        catch (const Error &err)
+        {
+            queue_.push({TraceEventKind::Error, this, 0, 0, err.what()});
+        }
+    });
+}
+
+void Tracer::loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this]() { return quit_ || tasks_.empty() == false; });
+            if (tasks_.empty())
+                break;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+
+    // Processes are detached or killed by the thread tracing them
+    session_.reset();
+}
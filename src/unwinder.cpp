@@ -0,0 +1,299 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "unwinder.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    // A frame record holds the caller's frame pointer then the return address
+    constexpr std::size_t RECORD_SIZE = 2 * sizeof(std::uint64_t);
+
+    // Stack read per memory access, records of nearby frames come along
+    constexpr std::size_t WINDOW_SIZE = 4096;
+
+    // Pointer authentication signs the top bits of saved return addresses
+    constexpr virt_addr ADDRESS_MASK = 0x0000FFFFFFFFFFFFull;
+
+    constexpr unsigned REG_FP = 29;
+    constexpr unsigned REG_LR = 30;
+    constexpr unsigned REG_SP = 31;
+
+    // Registers known at the frame being unwound, CFI rules and frame
+    // records recover only some of them
+    struct UnwindRegs
+    {
+        std::array<virt_addr, 32> gpr{};
+        std::uint32_t valid = 0;
+
+        bool has(unsigned reg) const { return (valid >> reg) & 1; }
+        void set(unsigned reg, virt_addr val)
+        {
+            gpr[reg] = val;
+            valid |= (1u << reg);
+        }
+    };
+
+    struct FrameRecord
+    {
+        virt_addr caller_fp;
+        virt_addr ret;
+    };
+
+    FrameRecord decode_record(const std::uint8_t *data)
+    {
+        FrameRecord record;
+        std::memcpy(&record.caller_fp, data, sizeof(record.caller_fp));
+        std::memcpy(&record.ret, data + 8, sizeof(record.ret));
+        record.ret &= ADDRESS_MASK;
+        return record;
+    }
+}
+
+std::vector<StackFrame> Unwinder::unwind()
+{
+    return unwind(process_->current_thread());
+}
+
+std::vector<StackFrame> Unwinder::unwind(pid_t tid)
+{
+    FrameRegisters regs = process_->frame_registers(tid);
+    ThreadCache &cache = cache_[tid];
+
+    std::vector<StackFrame> frames;
+    cfi_.allow_rescan();
+    last_reused_ = reuse_frames(cache, regs.pc, regs.fp, regs.sp, frames);
+    if (last_reused_)
+    {
+        cache.frames = frames;
+        return frames;
+    }
+
+    // Thread stacks never move, the mapping is looked up again only
+    // once sp leaves it
+    if (regs.sp < cache.stack.low || regs.sp >= cache.stack.high)
+    {
+        if (find_stack(tid, regs.sp, cache.stack) == false)
+            cache.stack = StackRange{};
+    }
+
+    frames.push_back({regs.pc, regs.fp});
+    walk(cache.stack, regs, frames);
+    cache.frames = frames;
+    return frames;
+}
+
+// Only the top frame changed when x29 still points at a frame record of
+// the last unwind, one record read confirms its callers are the same.
+// Before its prologue or in a leaf x29 still holds the record of the
+// caller, so CFI has to show the top function saved x29 right at fp
+bool Unwinder::reuse_frames(ThreadCache &cache, virt_addr pc, virt_addr fp,
+    virt_addr sp, std::vector<StackFrame> &frames)
+{
+    const auto &prev = cache.frames;
+    if (fp == 0 || sp > fp)
+        return false;
+
+    const CfiRow *row = cfi_.find_row(pc);
+    if (row == nullptr || row->regs[REG_FP].kind != RegisterRule::Offset ||
+        (row->cfa_reg != REG_FP && row->cfa_reg != REG_SP))
+        return false;
+
+    virt_addr cfa = (row->cfa_reg == REG_FP ? fp : sp) + row->cfa_offset;
+    if (cfa + row->regs[REG_FP].value != fp)
+        return false;
+
+    std::size_t k = 0;
+    while (k < prev.size() && prev[k].frame != fp)
+        k++;
+    if (k + 1 >= prev.size())
+        return false;
+
+    FrameRecord record;
+    try
+    {
+        auto data = process_->read_memory(fp, RECORD_SIZE);
+        record = decode_record(data.data());
+    }
+    catch (const Error &)
+    {
+        return false;
+    }
+
+    if (record.ret != prev[k + 1].pc || record.caller_fp != prev[k + 1].frame)
+        return false;
+
+    frames.reserve(prev.size() - k);
+    frames.push_back({pc, fp});
+    frames.insert(frames.end(), prev.begin() + k + 1, prev.end());
+    return true;
+}
+
+void Unwinder::walk(const StackRange &stack, const FrameRegisters &top,
+    std::vector<StackFrame> &frames)
+{
+    std::vector<std::uint8_t> window;
+    virt_addr window_low = 0;
+
+    // Makes [addr, addr + size) of the stack readable through window
+    auto load = [&](virt_addr addr, std::size_t size)
+    {
+        if (addr < stack.low || addr + size > stack.high)
+            return false;
+        if (addr >= window_low && addr + size <= window_low + window.size())
+            return true;
+
+        try
+        {
+            window = process_->read_memory(addr,
+                std::min<virt_addr>(WINDOW_SIZE, stack.high - addr));
+        }
+        catch (const Error &)
+        {
+            window.clear();
+            return false;
+        }
+        window_low = addr;
+        return true;
+    };
+
+    UnwindRegs regs;
+    regs.set(REG_FP, top.fp);
+    regs.set(REG_LR, top.lr);
+    regs.set(REG_SP, top.sp);
+    virt_addr pc = top.pc;
+
+    while (frames.size() < max_depth_)
+    {
+        virt_addr sp = regs.gpr[REG_SP];
+
+        // A return address points past the call, the call itself
+        // belongs to the caller's row
+        const CfiRow *row = cfi_.find_row(frames.size() == 1 ? pc : pc - 1);
+        if (row != nullptr && regs.has(row->cfa_reg))
+        {
+            virt_addr cfa = regs.gpr[row->cfa_reg] + row->cfa_offset;
+            if (cfa < sp || (cfa & 0x7) != 0)
+                break;
+
+            UnwindRegs caller;
+            bool ok = true;
+            for (unsigned reg = 0; reg < REG_SP && ok; reg++)
+            {
+                const RegisterRule &rule = row->regs[reg];
+                switch (rule.kind)
+                {
+                    case RegisterRule::Same:
+                        if (regs.has(reg))
+                            caller.set(reg, regs.gpr[reg]);
+                        break;
+                    case RegisterRule::Undefined:
+                        break;
+                    case RegisterRule::Offset:
+                    {
+                        virt_addr addr = cfa + rule.value;
+                        if (load(addr, sizeof(virt_addr)) == false)
+                        {
+                            ok = false;
+                            break;
+                        }
+                        virt_addr val;
+                        std::memcpy(&val, &window[addr - window_low], sizeof(val));
+                        caller.set(reg, val);
+                        break;
+                    }
+                    case RegisterRule::ValOffset:
+                        caller.set(reg, cfa + rule.value);
+                        break;
+                    case RegisterRule::Register:
+                        if (regs.has(rule.value))
+                            caller.set(reg, regs.gpr[rule.value]);
+                        break;
+                }
+            }
+            caller.set(REG_SP, cfa);
+
+            // An undefined return address ends the stack, as in _start
+            if (ok == false || row->ra_reg >= REG_SP || caller.has(row->ra_reg) == false)
+                break;
+            pc = caller.gpr[row->ra_reg] & ADDRESS_MASK;
+            if (pc == 0)
+                break;
+
+            regs = caller;
+            frames.push_back({pc, regs.has(REG_FP) ? regs.gpr[REG_FP] : 0});
+            continue;
+        }
+
+        // No CFI, the record x29 points at holds the caller
+        virt_addr fp = regs.has(REG_FP) ? regs.gpr[REG_FP] : 0;
+        if (fp == 0 || (fp & 0x7) != 0 || fp < sp || load(fp, RECORD_SIZE) == false)
+            break;
+
+        FrameRecord record = decode_record(&window[fp - window_low]);
+        if (record.ret == 0)
+            break;
+
+        // Stacks grow down, an older frame always sits higher
+        bool chained = (record.caller_fp > fp);
+        frames.push_back({record.ret, chained ? record.caller_fp : 0});
+        if (chained == false)
+            break;
+
+        pc = record.ret;
+        regs = UnwindRegs{};
+        regs.set(REG_FP, record.caller_fp);
+        regs.set(REG_SP, fp + RECORD_SIZE);
+    }
+}
+
+bool Unwinder::find_stack(pid_t tid, virt_addr sp, StackRange &range) const
+{
+    std::ifstream maps("/proc/" + std::to_string(process_->get_pid()) +
+        "/task/" + std::to_string(tid) + "/maps");
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        std::size_t dash = line.find('-');
+        std::size_t space = line.find(' ');
+        if (dash == std::string::npos || space == std::string::npos || dash > space)
+            continue;
+
+        virt_addr low = std::stoull(line.substr(0, dash), nullptr, 16);
+        virt_addr high = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+        if (sp >= low && sp < high)
+        {
+            range.low = low;
+            range.high = high;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,192 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "wall_sampler.hpp"
+#include "process.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <sys/uio.h>
+
+namespace
+{
+    // A frame record holds the caller's frame pointer then the return address
+    constexpr std::size_t RECORD_SIZE = 2 * sizeof(std::uint64_t);
+
+    // Pointer authentication signs the top bits of saved return addresses
+    constexpr virt_addr ADDRESS_MASK = 0x0000FFFFFFFFFFFFull;
+
+    // Marks which records could be read, an unreadable one only ends its
+    // own chain so reading carries on right after it
+    std::vector<bool> read_records(pid_t pid, std::vector<iovec> &remote,
+        std::uint8_t *out)
+    {
+        std::vector<bool> ok(remote.size(), false);
+        std::size_t next = 0;
+        while (next < remote.size())
+        {
+            std::size_t count = std::min<std::size_t>(remote.size() - next, IOV_MAX);
+            iovec local{out + next * RECORD_SIZE, count * RECORD_SIZE};
+            ssize_t ret = process_vm_readv(pid, &local, 1, &remote[next], count, 0);
+
+            std::size_t done = (ret > 0) ? static_cast<std::size_t>(ret) / RECORD_SIZE : 0;
+            for (std::size_t i = 0; i < done; i++)
+                ok[next + i] = true;
+
+            next += done;
+            if (done < count)
+                next++;
+        }
+        return ok;
+    }
+}
+
+WallClockSampler::WallClockSampler(Process &proc, std::uint64_t frequency,
+    std::size_t max_depth) : process_(&proc), max_depth_(max_depth)
+{
+    if (frequency == 0 || frequency > 10000)
+        Error::send("Sampling frequency must be between 1 and 10000 Hz");
+
+    interval_ = std::chrono::nanoseconds(1000000000ull / frequency);
+}
+
+std::chrono::nanoseconds WallClockSampler::round_cost() const
+{
+    if (rounds_ == 0)
+        return std::chrono::nanoseconds(0);
+    return halted_ / rounds_;
+}
+
+void WallClockSampler::run_for(std::chrono::milliseconds duration)
+{
+    using clock = std::chrono::steady_clock;
+
+    auto deadline = clock::now() + duration;
+    auto next = clock::now();
+    while (next < deadline && interrupted_ == false)
+    {
+        std::this_thread::sleep_until(next);
+
+        ProcessState state = process_->get_state();
+        if (state == ProcessState::Exited || state == ProcessState::Terminated)
+            break;
+
+        sample_round();
+
+        // Rounds that fell behind are dropped rather than bunched up
+        next += interval_;
+        auto now = clock::now();
+        if (next < now)
+            next = now;
+    }
+}
+
+void WallClockSampler::sample_round()
+{
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<pid_t> halted = process_->halt_threads();
+
+    std::vector<Walk> walks;
+    pid_t reader = 0;
+    for (const auto &[tid, thread] : process_->threads())
+    {
+        if (thread.state != ProcessState::Stopped)
+            continue;
+        if (thread.pending_status)
+            interrupted_ = true;
+
+        FrameRegisters regs = process_->frame_registers(tid);
+        Walk walk;
+        walk.chain.push_back(regs.pc);
+        walk.fp = regs.fp;
+        walks.push_back(std::move(walk));
+        reader = tid;
+    }
+
+    if (walks.empty() == false)
+        walk_frames(reader, walks);
+    process_->release_threads(halted);
+    halted_ += std::chrono::steady_clock::now() - begin;
+    rounds_++;
+
+    for (Walk &walk : walks)
+    {
+        stacks_[walk.chain]++;
+        samples_++;
+    }
+}
+
+void WallClockSampler::walk_frames(pid_t tid, std::vector<Walk> &walks) const
+{
+    std::vector<std::size_t> active;
+    std::vector<iovec> remote;
+    std::vector<std::uint8_t> records;
+
+    for (std::size_t depth = 1; depth < max_depth_; depth++)
+    {
+        active.clear();
+        remote.clear();
+        for (std::size_t i = 0; i < walks.size(); i++)
+        {
+            virt_addr fp = walks[i].fp;
+            if (fp == 0 || (fp & 0x7) != 0)
+                continue;
+
+            active.push_back(i);
+            remote.push_back({reinterpret_cast<void *>(fp), RECORD_SIZE});
+        }
+        if (active.empty())
+            break;
+
+        // One read per level covers the frames of every thread
+        records.resize(remote.size() * RECORD_SIZE);
+        std::vector<bool> ok = read_records(tid, remote, records.data());
+
+        for (std::size_t j = 0; j < active.size(); j++)
+        {
+            Walk &walk = walks[active[j]];
+            virt_addr caller_fp = 0;
+            virt_addr ret = 0;
+            if (ok[j])
+            {
+                std::memcpy(&caller_fp, &records[j * RECORD_SIZE], sizeof(caller_fp));
+                std::memcpy(&ret, &records[j * RECORD_SIZE + 8], sizeof(ret));
+                ret &= ADDRESS_MASK;
+            }
+
+            if (ret == 0)
+            {
+                walk.fp = 0;
+                continue;
+            }
+            walk.chain.push_back(ret);
+
+            // Stacks grow down, an older frame always sits higher
+            walk.fp = (caller_fp > walk.fp) ? caller_fp : 0;
+        }
+    }
+}
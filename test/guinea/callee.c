@@ -0,0 +1,63 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+unsigned long counter = 0;
+
+// Weighted so that argument order and stack spills are observable
+long weighted_sum(long a, long b, long c, long d, long e,
+                  long f, long g, long h, long i, long j)
+{
+    return a + 2 * b + 3 * c + 4 * d + 5 * e +
+           6 * f + 7 * g + 8 * h + 9 * i + 10 * j;
+}
+
+double mixed(double a, float b, long c, double d)
+{
+    return a * b + c - d;
+}
+
+unsigned long bump(unsigned long by)
+{
+    counter += by;
+    return counter;
+}
+
+int main()
+{
+    void *ptrs[] =
+    {
+        (void *) &weighted_sum,
+        (void *) &mixed,
+        (void *) &bump,
+        (void *) &counter,
+    };
+
+    write(STDOUT_FILENO, ptrs, sizeof(ptrs));
+    raise(SIGTRAP);
+
+    return (int) counter;
+}
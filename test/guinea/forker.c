@@ -0,0 +1,59 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CHILDREN 2
+
+// Each forked child passes through here once, so does the re-executed image
+__attribute__((noinline)) int worker(int id)
+{
+    return id + 1;
+}
+
+int main(int argc, char *argv[])
+{
+    // Second run after the exec below
+    if (argc > 1)
+        return worker(6);
+
+    void *ptr = (void *) &worker;
+    write(STDOUT_FILENO, &ptr, sizeof(void *));
+    raise(SIGTRAP);
+
+    for (int i = 0; i < CHILDREN; i++)
+    {
+        if (fork() == 0)
+            _exit(worker(i));
+    }
+
+    int status;
+    while (wait(&status) > 0)
+        ;
+
+    execl("/proc/self/exe", argv[0], "again", (char *) NULL);
+    return 1;
+}
@@ -0,0 +1,56 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+// Defined in call order so each caller sits above its callee in memory
+// The innermost one calls out too, leaf functions get no frame record
+__attribute__((noinline)) int depth3(int x)
+{
+    return x + 3 + (getppid() == 0);
+}
+
+__attribute__((noinline)) int depth2(int x)
+{
+    return depth3(x) * 2;
+}
+
+__attribute__((noinline)) int depth1(int x)
+{
+    return depth2(x) + 1;
+}
+
+int main(void)
+{
+    void *ptrs[] = {(void *) &depth3, (void *) &depth2, (void *) &depth1, (void *) &main};
+    write(STDOUT_FILENO, ptrs, sizeof(ptrs));
+    raise(SIGTRAP);
+
+    int total = 0;
+    for (int i = 0; i < 2; i++)
+        total += depth1(i);
+
+    return total;
+}
@@ -0,0 +1,61 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Names the debug info qualifies, nothing here runs for long
+namespace outer
+{
+    namespace inner
+    {
+        struct Counter
+        {
+            int count = 0;
+            int bump(int by);
+        };
+
+        // Defined out of line, the definition only refers to its declaration
+        __attribute__((noinline)) int Counter::bump(int by)
+        {
+            count += by;
+            return count;
+        }
+    }
+
+    typedef inner::Counter Tally;
+
+    __attribute__((noinline)) int bump(Tally &tally)
+    {
+        return tally.bump(2);
+    }
+}
+
+__attribute__((noinline)) int bump(int value)
+{
+    return value + 1;
+}
+
+int main()
+{
+    outer::Tally tally;
+    return outer::bump(tally) + bump(0) == 3 ? 0 : 1;
+}
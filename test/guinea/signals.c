@@ -0,0 +1,55 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+#define RAISES 3
+
+static volatile sig_atomic_t handled = 0;
+
+static void on_usr1(int signo)
+{
+    (void) signo;
+    handled++;
+}
+
+// Called by the debugger while a signal is held back
+__attribute__((noinline)) int handled_count(void)
+{
+    return handled;
+}
+
+// Exits with the number of signals that reached the handler
+int main(void)
+{
+    void *ptr = (void *) &handled_count;
+    write(STDOUT_FILENO, &ptr, sizeof(void *));
+
+    signal(SIGUSR1, on_usr1);
+    for (int i = 0; i < RAISES; i++)
+        raise(SIGUSR1);
+
+    return handled;
+}
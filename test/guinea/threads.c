@@ -0,0 +1,63 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define WORKERS 4
+
+volatile int hits[WORKERS];
+
+// Every worker passes through here once, breakpoints go on its entry
+__attribute__((noinline)) void marker(long id)
+{
+    hits[id]++;
+}
+
+static void *worker(void *arg)
+{
+    marker((long) arg);
+    return NULL;
+}
+
+int main()
+{
+    void *ptr = (void *) &marker;
+    write(STDOUT_FILENO, &ptr, sizeof(void *));
+    raise(SIGTRAP);
+
+    pthread_t threads[WORKERS];
+    for (long i = 0; i < WORKERS; i++)
+        pthread_create(&threads[i], NULL, worker, (void *) i);
+
+    for (int i = 0; i < WORKERS; i++)
+        pthread_join(threads[i], NULL);
+
+    int total = 0;
+    for (int i = 0; i < WORKERS; i++)
+        total += hits[i];
+
+    return total;
+}
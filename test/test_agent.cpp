@@ -0,0 +1,97 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+
+#include "agent.hpp"
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Agent served reads without ptrace stops")
+{
+    std::vector<std::string_view> exec =
+    {
+        "agent_target"
+    };
+
+    int sockfd = -1;
+    LaunchOptions options;
+    options.comm = &sockfd;
+    options.preload = "./libbkpt_agent.so";
+
+    auto proc = Process::launch(exec, options);
+    REQUIRE(proc != nullptr);
+
+    auto agent = Agent::create(*proc);
+    CHECK_FALSE(agent->ready());
+
+    proc->resume();
+
+    // The agent thread is created under us, its clone event must be
+    // serviced before the tracee gets any further
+    for (int i = 0; i < 5000 && agent->ready() == false; i++)
+    {
+        CHECK_FALSE(proc->try_wait().has_value());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(agent->ready());
+    CHECK(proc->get_state() == ProcessState::Running);
+    CHECK(proc->threads().size() == 2);
+
+    std::string output;
+    for (int i = 0; i < 100 && output.empty(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        output.clear();
+        read_from_socket(sockfd, output);
+    }
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr ptr;
+    std::memcpy(&ptr, output.data(), sizeof(ptr));
+
+    CHECK_NOTHROW(agent->ping());
+
+    auto data = agent->read_memory(ptr, sizeof(std::uint64_t));
+    std::uint64_t val = 0;
+    std::memcpy(&val, data.data(), sizeof(val));
+    CHECK(val == 0xfeedfacecafebeef);
+    CHECK(process_running(proc->get_pid()));
+
+    CHECK_THROWS_AS(agent->read_memory(0x8, 8), Error);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(agent->counter(0) > 0);
+
+    auto records = agent->drain_trace();
+    REQUIRE(records.empty() == false);
+    for (std::size_t i = 1; i < records.size(); i++)
+        CHECK(records[i].id == records[i - 1].id + 1);
+
+    agent.reset();
+    proc.reset();
+    close(sockfd);
+}
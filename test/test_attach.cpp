@@ -130,3 +130,42 @@ TEST_CASE("Process Attachment Logic 2")
         process_destroy(debug_pid);
     }
 }
+
+TEST_CASE("Seizing leaves the process running")
+{
+    char *const exec[] =
+    {
+        (char *)"two_seconds",
+        nullptr
+    };
+
+    pid_t debug_pid = process_create(exec);
+    REQUIRE(process_exists(debug_pid));
+
+    auto proc = Process::attach(debug_pid, true);
+    REQUIRE(proc != nullptr);
+    CHECK(proc->seized());
+    CHECK(proc->get_state() == ProcessState::Running);
+    CHECK(process_running(debug_pid));
+
+    SECTION("Interrupt stops it and resume continues")
+    {
+        proc->interrupt();
+        CHECK(proc->wait() == SIGSTOP);
+        CHECK(proc->get_state() == ProcessState::Stopped);
+        CHECK(process_status(debug_pid) == 't');
+
+        proc->resume();
+        proc->wait();
+        CHECK(proc->get_state() == ProcessState::Exited);
+    }
+
+    SECTION("Detaching a seized process")
+    {
+        proc.reset();
+        CHECK(process_exists(debug_pid));
+        CHECK(process_running(debug_pid));
+
+        process_destroy(debug_pid);
+    }
+}
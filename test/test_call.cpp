@@ -0,0 +1,100 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Inferior function calls")
+{
+    std::vector<std::string_view> exec =
+    {
+        "callee"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    std::uint8_t info = proc->wait();
+    REQUIRE(proc->get_state() == ProcessState::Stopped);
+    CHECK(info == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr ptrs[4];
+    std::memcpy(ptrs, output.data(), sizeof(ptrs));
+
+    virt_addr pc = proc->get_pc();
+    std::uint64_t sp = proc->registers().read<std::uint64_t>(RegisterID::REG64_SP);
+
+    SECTION("Integer arguments spill to the stack")
+    {
+        std::vector<RegisterValue> args;
+        for (std::uint64_t i = 1; i <= 10; i++)
+            args.push_back(i);
+
+        CallResult res = proc->call_function(ptrs[0], args);
+        CHECK(res.x0 == 385);
+    }
+
+    SECTION("Floating point and integer arguments interleave")
+    {
+        std::vector<RegisterValue> args =
+        {
+            1.5, 2.0f, std::uint64_t{10}, 0.25
+        };
+
+        CallResult res = proc->call_function(ptrs[1], args);
+        CHECK(res.d0 == 12.75);
+    }
+
+    SECTION("Side effects persist and state is restored")
+    {
+        CallResult res = proc->call_function(ptrs[2], {std::uint64_t{5}});
+        CHECK(res.x0 == 5);
+        res = proc->call_function(ptrs[2], {std::uint64_t{7}});
+        CHECK(res.x0 == 12);
+
+        auto data = proc->read_memory(ptrs[3], sizeof(std::uint64_t));
+        std::uint64_t counter = 0;
+        std::memcpy(&counter, data.data(), sizeof(counter));
+        CHECK(counter == 12);
+
+        CHECK(proc->get_pc() == pc);
+        CHECK(proc->registers().read<std::uint64_t>(RegisterID::REG64_SP) == sp);
+        CHECK(proc->breakpoint_sites().empty());
+
+        proc->resume();
+        info = proc->wait();
+        CHECK(proc->get_state() == ProcessState::Exited);
+        CHECK(info == 12);
+    }
+
+    close(sockfd);
+}
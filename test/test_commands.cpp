@@ -43,6 +43,14 @@ TEST_CASE("process_line - top-level commands")
         REQUIRE(tokens[0] == "continue");
     }
 
+    SECTION("call keeps the whole expression")
+    {
+        auto [action, tokens] = process_line("call 0x1000(1, 2.5)");
+        REQUIRE(action == Action::Call);
+        REQUIRE(tokens.size() == 3);
+        REQUIRE(tokens[1] == "0x1000(1,");
+    }
+
     SECTION("help")
     {
         auto [action, tokens] = process_line("help");
@@ -141,4 +149,215 @@ TEST_CASE("process_line - tokenization")
         REQUIRE(action == Action::ReadRegAll);
         REQUIRE(tokens.size() == 3);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("process_line - agent subcommands")
+{
+    SECTION("agent load with and without path")
+    {
+        auto [action, tokens] = process_line("agent load");
+        REQUIRE(action == Action::AgentLoad);
+
+        auto [action2, tokens2] = process_line("agent load /tmp/libbkpt_agent.so");
+        REQUIRE(action2 == Action::AgentLoad);
+        REQUIRE(tokens2.size() == 3);
+    }
+
+    SECTION("agent read default and count")
+    {
+        auto [action, tokens] = process_line("agent read 0x1000");
+        REQUIRE(action == Action::AgentReadDef);
+
+        auto [action2, tokens2] = process_line("agent read 0x1000 64");
+        REQUIRE(action2 == Action::AgentReadCnt);
+    }
+
+    SECTION("agent prefixes")
+    {
+        auto [action, tokens] = process_line("agent c");
+        REQUIRE(action == Action::AgentCounters);
+
+        auto [action2, tokens2] = process_line("agent");
+        REQUIRE(action2 == Action::Incomplete);
+    }
+}
+
+TEST_CASE("process_line - thread subcommands")
+{
+    SECTION("thread list and select")
+    {
+        auto [action, tokens] = process_line("thread list");
+        REQUIRE(action == Action::ThreadList);
+
+        auto [action2, tokens2] = process_line("thread select 1234");
+        REQUIRE(action2 == Action::ThreadSelect);
+        REQUIRE(tokens2.size() == 3);
+    }
+
+    SECTION("thread prefixes")
+    {
+        auto [action, tokens] = process_line("t l");
+        REQUIRE(action == Action::ThreadList);
+
+        auto [action2, tokens2] = process_line("thread select");
+        REQUIRE(action2 == Action::Incomplete);
+    }
+}
+
+TEST_CASE("process_line - interrupt")
+{
+    auto [action, tokens] = process_line("interrupt");
+    REQUIRE(action == Action::Interrupt);
+
+    auto [action2, tokens2] = process_line("i");
+    REQUIRE(action2 == Action::Interrupt);
+}
+
+TEST_CASE("process_line - process subcommands")
+{
+    auto [action, tokens] = process_line("process list");
+    REQUIRE(action == Action::ProcessList);
+
+    auto [action2, tokens2] = process_line("proc s 1234");
+    REQUIRE(action2 == Action::ProcessSelect);
+    REQUIRE(tokens2.size() == 3);
+
+    auto [action3, tokens3] = process_line("process follow on");
+    REQUIRE(action3 == Action::ProcessFollow);
+
+    auto [action4, tokens4] = process_line("process follow");
+    REQUIRE(action4 == Action::Incomplete);
+}
+
+TEST_CASE("process_line - commands for all processes")
+{
+    auto [action, tokens] = process_line("all breakpoint set 0x1000");
+    REQUIRE(action == Action::Broadcast);
+    REQUIRE(tokens.size() == 4);
+
+    auto [action2, tokens2] = process_line("al continue");
+    REQUIRE(action2 == Action::Broadcast);
+
+    // Shares its first letter with agent
+    auto [action3, tokens3] = process_line("a");
+    REQUIRE(action3 == Action::Ambiguous);
+}
+
+TEST_CASE("process_line - batched step")
+{
+    auto [action, tokens] = process_line("stepi");
+    REQUIRE(action == Action::StepInst);
+
+    auto [action2, tokens2] = process_line("stepi 100000");
+    REQUIRE(action2 == Action::StepCount);
+    REQUIRE(tokens2.size() == 2);
+
+    auto [action3, tokens3] = process_line("stepi until 0x1000");
+    REQUIRE(action3 == Action::StepUntil);
+
+    auto [action4, tokens4] = process_line("stepi while 0x1000 0x1040");
+    REQUIRE(action4 == Action::StepWhile);
+    REQUIRE(tokens4.size() == 4);
+
+    auto [action5, tokens5] = process_line("stepi while 0x1000");
+    REQUIRE(action5 == Action::Incomplete);
+}
+
+TEST_CASE("process_line - source step")
+{
+    auto [action, tokens] = process_line("step");
+    REQUIRE(action == Action::StepLine);
+
+    auto [action2, tokens2] = process_line("n");
+    REQUIRE(action2 == Action::StepOver);
+
+    auto [action3, tokens3] = process_line("fin");
+    REQUIRE(action3 == Action::StepOut);
+
+    // Both step commands start with it
+    auto [action4, tokens4] = process_line("s");
+    REQUIRE(action4 == Action::Ambiguous);
+}
+
+TEST_CASE("process_line - profile")
+{
+    auto [action, tokens] = process_line("profile step 5000");
+    REQUIRE(action == Action::ProfileStep);
+    REQUIRE(tokens.size() == 3);
+
+    auto [action2, tokens2] = process_line("prof st until 0x1000");
+    REQUIRE(action2 == Action::ProfileStepUntil);
+
+    auto [action4, tokens4] = process_line("profile sample 5");
+    REQUIRE(action4 == Action::ProfileSample);
+
+    auto [action5, tokens5] = process_line("profile sa 5 f");
+    REQUIRE(action5 == Action::ProfileSampleFolded);
+
+    auto [action6, tokens6] = process_line("profile wall 2");
+    REQUIRE(action6 == Action::ProfileWall);
+
+    auto [action7, tokens7] = process_line("profile w 2 500");
+    REQUIRE(action7 == Action::ProfileWallFreq);
+    REQUIRE(tokens7.size() == 4);
+
+    // Shares its first letters with process
+    auto [action3, tokens3] = process_line("pro list");
+    REQUIRE(action3 == Action::Ambiguous);
+}
+
+TEST_CASE("process_line - backtrace")
+{
+    auto [action, tokens] = process_line("backtrace");
+    REQUIRE(action == Action::Backtrace);
+
+    auto [action2, tokens2] = process_line("ba");
+    REQUIRE(action2 == Action::Backtrace);
+
+    // Shares its first letter with breakpoint
+    auto [action3, tokens3] = process_line("b");
+    REQUIRE(action3 == Action::Ambiguous);
+}
+
+TEST_CASE("process_line - syscall")
+{
+    auto [action, tokens] = process_line("syscall trace");
+    REQUIRE(action == Action::SyscallTrace);
+
+    auto [action2, tokens2] = process_line("sy tr openat,read");
+    REQUIRE(action2 == Action::SyscallTraceSel);
+    REQUIRE(tokens2.size() == 3);
+
+    auto [action3, tokens3] = process_line("syscall log");
+    REQUIRE(action3 == Action::SyscallLog);
+
+    auto [action4, tokens4] = process_line("syscall off");
+    REQUIRE(action4 == Action::SyscallOff);
+
+    auto [action5, tokens5] = process_line("sy");
+    REQUIRE(action5 == Action::Incomplete);
+
+    auto [action6, tokens6] = process_line("syscall stats");
+    REQUIRE(action6 == Action::SyscallStats);
+
+    auto [action7, tokens7] = process_line("sy st futex");
+    REQUIRE(action7 == Action::SyscallStatsSel);
+    REQUIRE(tokens7.size() == 3);
+}
+
+TEST_CASE("process_line - signal")
+{
+    auto [action, tokens] = process_line("signal");
+    REQUIRE(action == Action::SignalList);
+
+    auto [action2, tokens2] = process_line("si SIGUSR1");
+    REQUIRE(action2 == Action::SignalShow);
+
+    auto [action3, tokens3] = process_line("signal USR1 nostop noprint pass");
+    REQUIRE(action3 == Action::SignalSet);
+    REQUIRE(tokens3.size() == 5);
+
+    // Still shared with step, stepi and syscall
+    auto [action4, tokens4] = process_line("s");
+    REQUIRE(action4 == Action::Ambiguous);
+}
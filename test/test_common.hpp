@@ -40,6 +40,7 @@
 #include <elf.h>
 
 #include "error.hpp"
+#include "elf.hpp"
 
 #define BUF_SIZE 256
 
@@ -223,48 +224,15 @@ pid_t process_create(char *const argv[],
     return debug_pid;
 }
 
-std::int64_t get_section_load_bias(
-    std::filesystem::path path, Elf64_Addr virt_address)
-{
-    auto command = std::string("readelf -WS ") + path.string();
-    auto pipe = popen(command.c_str(), "r");
-
-    std::regex text_regex(R"(PROGBITS\s+(\w+)\s+(\w+)\s+(\w+))");
-    char *line = nullptr;
-    std::size_t len = 0;
-
-    while (getline(&line, &len, pipe) != -1)
-    {
-        std::cmatch groups;
-        if (std::regex_search(line, groups, text_regex))
-        {
-            auto start_addr = std::stol(groups[1], nullptr, 16);
-            auto offset = std::stol(groups[2], nullptr, 16);
-            auto size = std::stol(groups[3], nullptr, 16);
-            if (start_addr <= virt_address &&
-                virt_address < (start_addr + size))
-            {
-                free(line);
-                pclose(pipe);
-                return start_addr - offset;
-            }
-        }
-        free(line);
-        line = nullptr;
-    }
-    pclose(pipe);
-    throw std::runtime_error("Could not section load bias");
-}
-
+// File offset of the entry point, where it sits in the executable mapping
 std::int64_t get_entry_point_offset(std::filesystem::path path)
 {
-    std::ifstream elf_file(path);
-    Elf64_Ehdr header;
-
-    elf_file.read(reinterpret_cast<char*> (&header), sizeof(header));
-    Elf64_Addr entry_address = header.e_entry;
-    auto bias = get_section_load_bias(path, entry_address);
-    return entry_address - bias;
+    Elf elf(path);
+    Elf64_Addr entry_address = elf.header().e_entry;
+    auto section = elf.section_containing(entry_address);
+    if (section == nullptr)
+        throw std::runtime_error("Entry point lies outside every section");
+    return entry_address - section->sh_addr + section->sh_offset;
 }
 
 virt_addr get_load_address(pid_t pid, virt_addr inst_offset)
@@ -0,0 +1,145 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "elf.hpp"
+#include "dwarf_index.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    // DW_TAG_* of the types checked
+    constexpr std::uint16_t TAG_structure_type = 0x13;
+    constexpr std::uint16_t TAG_typedef = 0x16;
+}
+
+TEST_CASE("Index qualified names")
+{
+    Elf elf("scoped");
+    DwarfIndex index(elf, 2);
+    index.wait();
+    CHECK(index.ready());
+    CHECK(index.unit_count() >= 1);
+
+    auto method = index.functions_named("outer::inner::Counter::bump");
+    REQUIRE(method.size() == 1);
+    CHECK(method[0].base_name() == "bump");
+
+    // The out of line definition sits where the mangled symbol does
+    auto symbol = elf.symbols_by_name("_ZN5outer5inner7Counter4bumpEi");
+    REQUIRE(symbol.size() == 1);
+    CHECK(method[0].low == symbol[0]->address);
+    CHECK(method[0].high - method[0].low == symbol[0]->size);
+
+    CHECK(index.functions_named("Counter::bump").size() == 1);
+    CHECK(index.functions_named("inner::Counter::bump").size() == 1);
+    CHECK(index.functions_named("outer::bump").size() == 1);
+    CHECK(index.functions_named("bump").size() == 3);
+    CHECK(index.functions_named("ounter::bump").empty());
+    CHECK(index.functions_named("nothing").empty());
+
+    auto around = index.function_containing(method[0].low + 4);
+    REQUIRE(around.has_value());
+    CHECK(around->name == method[0].name);
+    CHECK(index.function_containing(0).has_value() == false);
+
+    auto counter = index.types_named("Counter");
+    REQUIRE(counter.size() == 1);
+    CHECK(counter[0].name == "outer::inner::Counter");
+    CHECK(counter[0].tag == TAG_structure_type);
+
+    auto tally = index.types_named("outer::Tally");
+    REQUIRE(tally.size() == 1);
+    CHECK(tally[0].tag == TAG_typedef);
+    CHECK(index.types_named("int").empty() == false);
+}
+
+TEST_CASE("Index the same with any number of workers")
+{
+    Elf elf("nested");
+    DwarfIndex single(elf, 1);
+    DwarfIndex many(elf, 4);
+
+    CHECK(single.unit_count() == many.unit_count());
+    CHECK(single.function_count() == many.function_count());
+    CHECK(single.type_count() == many.type_count());
+
+    for (const char *name : {"depth1", "depth2", "depth3", "main"})
+    {
+        auto function = many.functions_named(name);
+        auto symbol = elf.symbols_by_name(name);
+        REQUIRE(function.size() == 1);
+        REQUIRE(symbol.size() == 1);
+        CHECK(function[0].low == symbol[0]->address);
+    }
+
+    // Dropping an index still being built stops its workers
+    {
+        DwarfIndex early(elf, 4);
+    }
+}
+
+TEST_CASE("Index cache keyed by build id")
+{
+    Elf elf("scoped");
+    REQUIRE(elf.build_id().empty() == false);
+
+    auto dir = std::filesystem::temp_directory_path() /
+        ("bkpt_index_cache_" + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    auto file = dir / (elf.build_id() + ".dwidx");
+
+    std::size_t functions = 0, types = 0;
+    {
+        DwarfIndex fresh(elf, 2, dir);
+        CHECK(fresh.from_cache() == false);
+        functions = fresh.function_count();
+        types = fresh.type_count();
+    }
+    REQUIRE(std::filesystem::exists(file));
+
+    {
+        DwarfIndex cached(elf, 2, dir);
+        CHECK(cached.from_cache());
+        CHECK(cached.function_count() == functions);
+        CHECK(cached.type_count() == types);
+
+        auto method = cached.functions_named("Counter::bump");
+        REQUIRE(method.size() == 1);
+        CHECK(method[0].name == "outer::inner::Counter::bump");
+        CHECK(method[0].low == elf.symbols_by_name("_ZN5outer5inner7Counter4bumpEi").at(0)->address);
+        REQUIRE(cached.types_named("Tally").size() == 1);
+    }
+
+    // A damaged file is indexed over and replaced
+    std::filesystem::resize_file(file, 40);
+    {
+        DwarfIndex rebuilt(elf, 2, dir);
+        CHECK(rebuilt.from_cache() == false);
+        CHECK(rebuilt.function_count() == functions);
+    }
+    CHECK(DwarfIndex(elf, 2, dir).from_cache());
+
+    std::filesystem::remove_all(dir);
+}
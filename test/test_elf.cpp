@@ -0,0 +1,94 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "elf.hpp"
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("ELF symbol index")
+{
+    Elf elf("nested");
+    CHECK(elf.header().e_machine == EM_AARCH64);
+    CHECK(elf.symbol_count() > 4);
+
+    auto found = elf.symbols_by_name("depth2");
+    REQUIRE(found.size() == 1);
+    const ElfSymbol *depth2 = found[0];
+    CHECK(depth2->type == STT_FUNC);
+    CHECK(depth2->size > 4);
+
+    CHECK(elf.symbol_at(depth2->address) == depth2);
+    CHECK(elf.symbol_containing(depth2->address + 4) == depth2);
+    CHECK(elf.symbol_containing(depth2->address + depth2->size) != depth2);
+    CHECK(elf.symbols_by_name("no_such_symbol").empty());
+
+    const Elf64_Shdr *text = elf.section(".text");
+    REQUIRE(text != nullptr);
+    CHECK(elf.section_containing(depth2->address) == text);
+    CHECK(elf.section_name(*text) == ".text");
+    CHECK(elf.section_contents(*text).size() == text->sh_size);
+}
+
+TEST_CASE("ELF rejects non ELF files")
+{
+    CHECK_THROWS_AS(Elf("/proc/self/status"), Error);
+    CHECK_THROWS_AS(Elf("no_such_file"), Error);
+}
+
+TEST_CASE("Symbolize a running process")
+{
+    std::vector<std::string_view> exec =
+    {
+        "nested"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr fn[4];
+    std::memcpy(fn, output.data(), sizeof(fn));
+
+    REQUIRE(proc->elf() != nullptr);
+    CHECK(proc->symbol_address("depth2") == fn[1]);
+    CHECK(proc->symbol_address("main") == fn[3]);
+    CHECK(proc->symbol_address("no_such_symbol").has_value() == false);
+
+    auto sym = proc->symbolize(fn[2] + 8);
+    REQUIRE(sym.has_value());
+    CHECK(sym->first->name == "depth1");
+    CHECK(sym->second == 8);
+
+    proc->resume();
+    CHECK(proc->wait() == 16);
+    close(sockfd);
+}
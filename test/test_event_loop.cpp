@@ -0,0 +1,133 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "event_loop.hpp"
+#include "process.hpp"
+#include "test_common.hpp"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Event loop timers and descriptors")
+{
+    EventLoop loop;
+
+    SECTION("One shot timers fire once")
+    {
+        int fired = 0;
+        loop.add_timer(5ms, [&]() { fired++; }, false);
+
+        CHECK(loop.run_once(1000ms));
+        CHECK_FALSE(loop.run_once(20ms));
+        CHECK(fired == 1);
+    }
+
+    SECTION("Repeating timers fire until cancelled")
+    {
+        int fired = 0;
+        int id = -1;
+        id = loop.add_timer(1ms, [&]()
+        {
+            if (++fired == 3)
+                loop.cancel_timer(id);
+        });
+
+        for (int i = 0; i < 100 && fired < 3; i++)
+            loop.run_once(100ms);
+
+        CHECK(fired == 3);
+        CHECK_FALSE(loop.run_once(20ms));
+    }
+
+    SECTION("Readable descriptors and stop")
+    {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+
+        std::string got;
+        loop.watch_fd(fds[0], [&]()
+        {
+            char buf[16];
+            ssize_t n = read(fds[0], buf, sizeof(buf));
+            got.append(buf, n);
+            loop.stop();
+        });
+
+        REQUIRE(write(fds[1], "ping", 4) == 4);
+        loop.run();
+        CHECK(got == "ping");
+
+        loop.unwatch_fd(fds[0]);
+        REQUIRE(write(fds[1], "pong", 4) == 4);
+        CHECK_FALSE(loop.run_once(20ms));
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
+
+TEST_CASE("Tracee stops are delivered through SIGCHLD")
+{
+    std::vector<std::string_view> exec =
+    {
+        "two_seconds"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    EventLoop loop;
+    std::optional<std::uint8_t> stop;
+    loop.watch_signal(SIGCHLD, [&]()
+    {
+        if (proc->get_state() == ProcessState::Running)
+            stop = proc->try_wait();
+    });
+
+    proc->resume();
+    CHECK(process_running(proc->get_pid()));
+
+    // Nothing happens on its own while the tracee spins
+    CHECK_FALSE(loop.run_once(50ms));
+    CHECK(proc->get_state() == ProcessState::Running);
+
+    proc->interrupt();
+    for (int i = 0; i < 100 && !stop; i++)
+        loop.run_once(100ms);
+
+    REQUIRE(stop.has_value());
+    CHECK(*stop == SIGSTOP);
+    CHECK(proc->get_state() == ProcessState::Stopped);
+
+    // The interrupt stop is not passed on, the program finishes normally
+    stop.reset();
+    proc->resume();
+    for (int i = 0; i < 100 && !stop; i++)
+        loop.run_once(100ms);
+
+    REQUIRE(stop.has_value());
+    CHECK(proc->get_state() == ProcessState::Exited);
+    CHECK_THROWS_AS(proc->interrupt(), Error);
+}
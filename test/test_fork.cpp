@@ -0,0 +1,131 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <set>
+
+#include "process.hpp"
+#include "session.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    virt_addr launch_until_ready(Session &session, int &sockfd)
+    {
+        std::vector<std::string_view> exec =
+        {
+            "forker"
+        };
+
+        Process &proc = session.add(Process::launch(exec, &sockfd));
+        proc.resume();
+        REQUIRE(proc.wait() == SIGTRAP);
+
+        std::string output;
+        read_from_socket(sockfd, output);
+        REQUIRE(output.size() == sizeof(virt_addr));
+
+        virt_addr worker;
+        std::memcpy(&worker, output.data(), sizeof(worker));
+        proc.create_breakpoint_site(worker).enable();
+        return worker;
+    }
+}
+
+TEST_CASE("Detached children run without breakpoints")
+{
+    Session session;
+    int sockfd = -1;
+    virt_addr worker = launch_until_ready(session, sockfd);
+    Process &proc = *session.current();
+
+    // Children would die of SIGTRAP if they kept the breakpoint
+    proc.resume();
+    REQUIRE(session.wait() == SIGTRAP);
+    CHECK(session.size() == 1);
+    CHECK(proc.stop_reason() == StopReason::Exec);
+
+    // Same image again, the breakpoint is armed in it
+    CHECK(proc.breakpoint_sites().get_by_address(worker).is_enabled());
+    proc.resume();
+    REQUIRE(session.wait() == SIGTRAP);
+    CHECK(proc.stop_reason() == StopReason::Signal);
+    CHECK(proc.get_pc() == worker);
+
+    proc.resume();
+    CHECK(session.wait() == 7);
+    CHECK(proc.get_state() == ProcessState::Exited);
+    close(sockfd);
+}
+
+TEST_CASE("Followed children stop at inherited breakpoints")
+{
+    Session session;
+    session.set_fork_policy(ForkPolicy::Follow);
+
+    int sockfd = -1;
+    virt_addr worker = launch_until_ready(session, sockfd);
+    pid_t parent = session.current()->get_pid();
+
+    std::set<pid_t> followed;
+    session.on_follow([&](Process &child) { followed.insert(child.get_pid()); });
+
+    std::set<pid_t> hit_by;
+    std::set<int> exit_codes;
+    session.current()->resume();
+    while (true)
+    {
+        std::uint8_t info = session.wait();
+        Process &proc = *session.current();
+        if (proc.get_state() == ProcessState::Exited)
+        {
+            CHECK(proc.get_pid() != parent);
+            exit_codes.insert(info);
+            continue;
+        }
+
+        REQUIRE(proc.get_state() == ProcessState::Stopped);
+        REQUIRE(info == SIGTRAP);
+        if (proc.get_pid() == parent)
+        {
+            CHECK(proc.stop_reason() == StopReason::Exec);
+            break;
+        }
+
+        CHECK(proc.get_pc() == worker);
+        CHECK(proc.breakpoint_sites().size() == 1);
+        hit_by.insert(proc.get_pid());
+        proc.resume();
+    }
+
+    CHECK(followed.size() == 2);
+    CHECK(hit_by == followed);
+    CHECK(exit_codes == std::set<int>{1, 2});
+
+    // Only the parent is left once the children are gone
+    CHECK(session.prune() == false);
+    CHECK(session.size() == 1);
+    close(sockfd);
+}
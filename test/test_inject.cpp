@@ -0,0 +1,129 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Syscall injection")
+{
+    std::vector<std::string_view> exec =
+    {
+        "outta_here"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    pid_t pid = proc->get_pid();
+    REQUIRE(process_exists(pid));
+    CHECK(proc->get_state() == ProcessState::Stopped);
+
+    virt_addr pc = proc->get_pc();
+    auto code = proc->read_memory(pc, 8);
+
+    SECTION("getpid returns tracee pid")
+    {
+        std::uint64_t ret = proc->inject_syscall(SYS_getpid);
+        CHECK(static_cast<pid_t>(ret) == pid);
+
+        // Registers and clobbered code restored
+        CHECK(proc->get_pc() == pc);
+        CHECK(proc->read_memory(pc, 8) == code);
+    }
+
+    SECTION("Failing syscall returns negative errno")
+    {
+        std::uint64_t ret = proc->inject_syscall(SYS_close, -1);
+        CHECK(static_cast<std::int64_t>(ret) == -EBADF);
+        CHECK(proc->get_pc() == pc);
+    }
+
+    SECTION("Scratch allocation")
+    {
+        ScratchAllocator &scratch = proc->scratch();
+        CHECK(scratch.empty());
+        CHECK(scratch.stub_address() == 0);
+
+        virt_addr first = scratch.allocate(64);
+        CHECK(first != 0);
+        CHECK(first % 16 == 0);
+        CHECK(scratch.stub_address() != 0);
+        CHECK(scratch.mapped_size() >= 64);
+
+        virt_addr second = scratch.allocate(8, 64);
+        CHECK(second % 64 == 0);
+        CHECK(second >= first + 64);
+
+        const std::uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+        proc->write_memory(second, {data, 8});
+        auto read = proc->read_memory(second, 8);
+        CHECK(std::equal(read.begin(), read.end(), data));
+
+        // Later injections run from the scratch stub, not from pc
+        std::uint64_t ret = proc->inject_syscall(SYS_getpid);
+        CHECK(static_cast<pid_t>(ret) == pid);
+        CHECK(proc->read_memory(pc, 8) == code);
+
+        scratch.release();
+        CHECK(scratch.empty());
+        CHECK_THROWS_AS(proc->read_memory(second, 8), Error);
+    }
+
+    proc->resume();
+    std::uint8_t ret = proc->wait();
+    CHECK(proc->get_state() == ProcessState::Exited);
+    CHECK(ret == 0);
+}
+
+TEST_CASE("Signals arriving during injection are kept")
+{
+    std::vector<std::string_view> exec =
+    {
+        "outta_here"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    pid_t pid = proc->get_pid();
+    virt_addr pc = proc->get_pc();
+    auto code = proc->read_memory(pc, 8);
+
+    // Delivered to the tracee on the way back from the svc
+    std::uint64_t ret = proc->inject_syscall(SYS_kill, pid, SIGUSR1);
+    CHECK(ret == 0);
+    CHECK(proc->get_pc() == pc);
+    CHECK(proc->read_memory(pc, 8) == code);
+    CHECK(proc->threads().at(pid).pending_signal == SIGUSR1);
+
+    // Nothing handles it, so its default action ends the process
+    proc->resume();
+    CHECK(proc->wait() == SIGUSR1);
+    CHECK(proc->get_state() == ProcessState::Terminated);
+}
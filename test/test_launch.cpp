@@ -118,4 +118,45 @@ TEST_CASE("Fast Exiting Process")
         proc.reset();
         CHECK_FALSE(process_exists(pid));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Launch hands the process over where asked")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+    LaunchOptions options;
+
+    SECTION("Entry")
+    {
+        options.stop_at = StopAt::Entry;
+        auto proc = Process::launch(exec, options);
+        REQUIRE(proc->get_state() == ProcessState::Stopped);
+        CHECK(proc->get_pc() == proc->auxv().entry());
+        CHECK(proc->get_pc() == get_load_address(proc->get_pid(), get_entry_point_offset("hello")));
+        CHECK(proc->breakpoint_sites().empty());
+    }
+
+    SECTION("Main")
+    {
+        options.stop_at = StopAt::Main;
+        auto proc = Process::launch(exec, options);
+        REQUIRE(proc->get_state() == ProcessState::Stopped);
+        CHECK(proc->get_pc() == proc->symbol_address("main"));
+        CHECK(proc->breakpoint_sites().empty());
+
+        proc->resume();
+        CHECK(proc->wait() == 0);
+        CHECK(proc->get_state() == ProcessState::Exited);
+    }
+
+    SECTION("None")
+    {
+        options.stop_at = StopAt::None;
+        auto proc = Process::launch(exec, options);
+        CHECK(proc->get_state() == ProcessState::Running);
+        CHECK(proc->wait() == 0);
+        CHECK(proc->get_state() == ProcessState::Exited);
+    }
+}
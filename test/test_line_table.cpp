@@ -0,0 +1,79 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "elf.hpp"
+#include "line_table.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    std::string source_text(std::string_view file, std::uint32_t line)
+    {
+        std::ifstream src{std::string(file)};
+        std::string text;
+        for (std::uint32_t i = 0; i < line && std::getline(src, text); i++)
+            ;
+        return text;
+    }
+}
+
+TEST_CASE("Line table lookups")
+{
+    Elf elf("nested");
+    LineTable lines(elf);
+    REQUIRE(lines.unit_count() >= 1);
+    CHECK(lines.decoded_units() == 0);
+
+    auto found = elf.symbols_by_name("depth2");
+    REQUIRE(found.size() == 1);
+    virt_addr depth2 = found[0]->address;
+
+    auto entry = lines.line_at(depth2);
+    REQUIRE(entry.has_value());
+    CHECK(lines.decoded_units() == 1);
+    CHECK(entry->address == depth2);
+    CHECK(entry->is_stmt);
+    REQUIRE(entry->file.size() > 8);
+    CHECK(entry->file.substr(entry->file.size() - 8) == "nested.c");
+
+    // The row points at the signature or the brace after it
+    std::string opening = source_text(entry->file, entry->line - 1) +
+        source_text(entry->file, entry->line);
+    CHECK(opening.find("depth2(") != std::string::npos);
+
+    // Later rows of the function belong to its body
+    auto body = lines.line_at(depth2 + found[0]->size - 4);
+    REQUIRE(body.has_value());
+    CHECK(body->line > entry->line);
+
+    auto back = lines.entries_for("nested.c", entry->line);
+    REQUIRE(back.empty() == false);
+    CHECK(back.front().address == depth2);
+    CHECK(lines.entries_for("guinea/nested.c", entry->line).size() == back.size());
+    CHECK(lines.entries_for("ested.c", entry->line).empty());
+    CHECK(lines.entries_for("nested.c", 100000).empty());
+
+    CHECK(lines.line_at(0).has_value() == false);
+}
@@ -0,0 +1,105 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    bool plugin_loaded(const ModuleList &modules)
+    {
+        for (const auto &module : modules.modules())
+        {
+            if (module.path.find("libplugin.so") != std::string::npos)
+                return true;
+        }
+        return false;
+    }
+}
+
+TEST_CASE("Pending breakpoint follows dlopen and dlclose")
+{
+    std::vector<std::string_view> exec =
+    {
+        "dlopener"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    ModuleList &modules = proc->modules();
+    REQUIRE(modules.start());
+    CHECK(modules.active());
+    CHECK(proc->breakpoint_sites().get_by_address(modules.breakpoint_address()).is_internal());
+
+    const PendingBreakpoint &pending = modules.add_breakpoint("plugin_entry");
+    CHECK(pending.address == 0);
+
+    // Loader stops on r_brk are passed without being reported
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    CHECK(plugin_loaded(modules));
+    REQUIRE(modules.breakpoints().size() == 1);
+    CHECK(modules.breakpoints()[0].address == proc->get_pc());
+    CHECK(modules.symbol_address("plugin_entry") == proc->get_pc());
+    CHECK(proc->symbol_address("plugin_entry") == proc->get_pc());
+
+    // Unloading takes the site along and leaves the breakpoint pending
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    CHECK(plugin_loaded(modules) == false);
+    CHECK(modules.breakpoints()[0].address == 0);
+    CHECK(modules.symbol_address("plugin_entry") == std::nullopt);
+
+    proc->resume();
+    CHECK(proc->wait() == 6);
+    CHECK(proc->get_state() == ProcessState::Exited);
+}
+
+TEST_CASE("Load biases come from the auxiliary vector")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+    REQUIRE(proc->elf() != nullptr);
+
+    // Same place the maps put the entry point
+    pid_t pid = proc->get_pid();
+    virt_addr entry = get_load_address(pid, get_entry_point_offset("hello"));
+    CHECK(proc->auxv().entry() == entry);
+    CHECK(proc->load_bias("hello") == entry - proc->elf()->header().e_entry);
+    CHECK(proc->load_bias(proc->exe_path()) == proc->load_bias("hello"));
+
+    // The loader is there before it has a link map
+    std::string_view interp = proc->elf()->interpreter();
+    REQUIRE(interp.empty() == false);
+    CHECK(proc->auxv().interpreter_base() != 0);
+    CHECK(proc->load_bias(interp) == proc->auxv().interpreter_base());
+    CHECK(proc->load_bias("libnothing.so") == std::nullopt);
+}
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "perf_sampler.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("cpu-clock samples of a busy tracee")
+{
+    std::vector<std::string_view> exec =
+    {
+        "two_seconds"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    PerfSampler sampler(*proc);
+    proc->resume();
+    sampler.run_for(std::chrono::milliseconds(500));
+
+    // Around 500 samples at the default frequency, timing slack aside
+    CHECK(sampler.samples() > 50);
+    CHECK(sampler.histogram().size() > 0);
+
+    std::uint64_t stacked = 0;
+    for (const auto &[chain, count] : sampler.stacks())
+    {
+        CHECK(chain.empty() == false);
+        stacked += count;
+    }
+    CHECK(stacked == sampler.samples());
+
+    // Nothing but the exit is reported, sampling never stopped the tracee
+    proc->wait();
+    CHECK(proc->get_state() == ProcessState::Exited);
+}
+
+TEST_CASE("Sampling frequency must be positive")
+{
+    std::vector<std::string_view> exec =
+    {
+        "outta_here"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+    CHECK_THROWS_AS(PerfSampler(*proc, 0), Error);
+}
@@ -0,0 +1,150 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <set>
+#include <poll.h>
+
+#include "session_manager.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    std::vector<pid_t> spawn_workers(std::size_t count)
+    {
+        char *const exec[] =
+        {
+            (char *)"two_seconds",
+            nullptr
+        };
+
+        std::vector<pid_t> pids;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            pid_t pid = process_create(exec);
+            REQUIRE(process_exists(pid));
+            pids.push_back(pid);
+        }
+        return pids;
+    }
+
+    // Stands in for the SIGCHLD watch of an event loop
+    std::optional<TraceEvent> next_event(SessionManager &sessions)
+    {
+        EventQueue &events = sessions.events();
+        for (int tries = 0; tries < 100; tries++)
+        {
+            if (auto event = events.pop())
+                return event;
+
+            sessions.poll();
+            pollfd pfd{events.fd(), POLLIN, 0};
+            if (::poll(&pfd, 1, 100) > 0)
+                events.clear_fd();
+        }
+        return std::nullopt;
+    }
+}
+
+TEST_CASE("Every process is traced from its own thread")
+{
+    auto pids = spawn_workers(3);
+
+    SessionManager sessions;
+    auto errors = sessions.attach(pids);
+    REQUIRE(errors.empty());
+    REQUIRE(sessions.tracers().size() == 3);
+
+    for (pid_t pid : pids)
+    {
+        Tracer *tracer = sessions.find(pid);
+        REQUIRE(tracer != nullptr);
+        CHECK(process_status(pid) == 't');
+        CHECK(tracer->run([](Session &session)
+        {
+            return session.current()->get_state();
+        }) == ProcessState::Stopped);
+    }
+
+    // Resumed by all tracers at once, each one reports its own exit
+    for (auto &result : sessions.broadcast([](Session &session) { session.current()->resume(); }))
+        result.get();
+
+    std::set<pid_t> exited;
+    while (exited.size() < pids.size())
+    {
+        auto event = next_event(sessions);
+        REQUIRE(event.has_value());
+        REQUIRE(event->kind == TraceEventKind::Stop);
+        CHECK(event->tracer == sessions.find(event->pid));
+
+        auto state = event->tracer->run([](Session &session)
+        {
+            return session.current()->get_state();
+        });
+        CHECK(state == ProcessState::Exited);
+        CHECK(event->info == 0);
+        exited.insert(event->pid);
+    }
+
+    CHECK(exited == std::set<pid_t>(pids.begin(), pids.end()));
+
+    // One tracer is kept around while nothing is alive
+    CHECK(sessions.prune() == false);
+    for (pid_t pid : pids)
+        waitpid(pid, nullptr, 0);
+}
+
+TEST_CASE("Failed attaches leave the others in place")
+{
+    auto pids = spawn_workers(1);
+    pids.push_back(pids.front());
+
+    {
+        SessionManager sessions;
+        auto errors = sessions.attach(pids);
+        CHECK(errors.size() == 1);
+        CHECK(sessions.tracers().size() == 1);
+    }
+
+    // Detached by now, so its exit is ours to collect again
+    process_destroy(pids.front());
+}
+
+TEST_CASE("Processes are found by their command line")
+{
+    auto pids = spawn_workers(2);
+
+    auto found = SessionManager::find_pids("two_seconds");
+    for (pid_t pid : pids)
+        CHECK(std::find(found.begin(), found.end(), pid) != found.end());
+    CHECK(std::find(found.begin(), found.end(), getpid()) == found.end());
+
+    CHECK(SessionManager::find_pids("^no such process$").empty());
+    CHECK_THROWS_AS(SessionManager::find_pids("("), Error);
+
+    for (pid_t pid : pids)
+        process_destroy(pid);
+}
@@ -0,0 +1,180 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    // Raises SIGUSR1 three times and exits with how many were handled,
+    // the address of handled_count() comes out on the socket first
+    std::unique_ptr<Process> launch_signals(int &sockfd)
+    {
+        std::vector<std::string_view> exec =
+        {
+            "signals"
+        };
+
+        auto proc = Process::launch(exec, &sockfd);
+        REQUIRE(proc != nullptr);
+        return proc;
+    }
+}
+
+TEST_CASE("Default signal policies")
+{
+    int sockfd = -1;
+    auto proc = launch_signals(sockfd);
+
+    const SignalPolicy &usr1 = proc->signal_policy(SIGUSR1);
+    CHECK(usr1.stop);
+    CHECK(usr1.print);
+    CHECK(usr1.pass);
+
+    const SignalPolicy &chld = proc->signal_policy(SIGCHLD);
+    CHECK(chld.stop == false);
+    CHECK(chld.print == false);
+    CHECK(chld.pass);
+
+    CHECK(proc->signal_policy(SIGINT).pass == false);
+    CHECK(proc->signal_policy(SIGTRAP).pass == false);
+
+    // Our own stops arrive as these
+    CHECK_THROWS_AS(proc->set_signal_policy(SIGTRAP, {false, false, true}), Error);
+    CHECK_THROWS_AS(proc->set_signal_policy(SIGSTOP, {true, true, true}), Error);
+    CHECK_THROWS_AS(proc->set_signal_policy(0, {}), Error);
+    CHECK_THROWS_AS(proc->signal_policy(NSIG), Error);
+    close(sockfd);
+}
+
+TEST_CASE("Stopping signals are delivered on resume")
+{
+    int sockfd = -1;
+    auto proc = launch_signals(sockfd);
+    for (int i = 0; i < 3; i++)
+    {
+        proc->resume();
+        REQUIRE(proc->wait() == SIGUSR1);
+    }
+
+    proc->resume();
+    CHECK(proc->wait() == 3);
+    CHECK(proc->get_state() == ProcessState::Exited);
+    close(sockfd);
+}
+
+TEST_CASE("Signals without a stop are passed from within wait")
+{
+    int sockfd = -1;
+    auto proc = launch_signals(sockfd);
+    std::vector<int> seen;
+    proc->set_signal_observer([&](pid_t tid, int signo)
+    {
+        CHECK(tid == proc->get_pid());
+        seen.push_back(signo);
+    });
+
+    proc->set_signal_policy(SIGUSR1, {false, true, true});
+    proc->resume();
+    CHECK(proc->wait() == 3);
+    CHECK(proc->get_state() == ProcessState::Exited);
+    CHECK(seen == std::vector<int>(3, SIGUSR1));
+    close(sockfd);
+}
+
+TEST_CASE("Signals that are not passed never reach the tracee")
+{
+    int sockfd = -1;
+
+    SECTION("Stopping")
+    {
+        auto proc = launch_signals(sockfd);
+        proc->set_signal_policy(SIGUSR1, {true, true, false});
+        for (int i = 0; i < 3; i++)
+        {
+            proc->resume();
+            REQUIRE(proc->wait() == SIGUSR1);
+        }
+
+        proc->resume();
+        CHECK(proc->wait() == 0);
+    }
+
+    SECTION("Silent")
+    {
+        auto proc = launch_signals(sockfd);
+        int seen = 0;
+        proc->set_signal_observer([&](pid_t, int) { seen++; });
+        proc->set_signal_policy(SIGUSR1, {false, false, false});
+        proc->resume();
+        CHECK(proc->wait() == 0);
+        CHECK(seen == 0);
+    }
+
+    SECTION("Dropped after the stop")
+    {
+        // The policy at resume time decides
+        auto proc = launch_signals(sockfd);
+        proc->resume();
+        REQUIRE(proc->wait() == SIGUSR1);
+        proc->set_signal_policy(SIGUSR1, {false, false, false});
+        proc->resume();
+        CHECK(proc->wait() == 0);
+    }
+
+    close(sockfd);
+}
+
+TEST_CASE("Held signals stay out of inferior calls")
+{
+    int sockfd = -1;
+    auto proc = launch_signals(sockfd);
+    proc->resume();
+    REQUIRE(proc->wait() == SIGUSR1);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr handled_count;
+    std::memcpy(&handled_count, output.data(), sizeof(handled_count));
+
+    // The handler would run inside the call if SIGUSR1 went in with it
+    CallResult res = proc->call_function(handled_count, {});
+    CHECK(res.x0 == 0);
+    CHECK(proc->threads().at(proc->get_pid()).pending_signal == SIGUSR1);
+
+    // Still delivered by the real continue, all three are handled
+    std::uint8_t info = 0;
+    do
+    {
+        proc->resume();
+        info = proc->wait();
+    } while (proc->get_state() == ProcessState::Stopped);
+
+    CHECK(proc->get_state() == ProcessState::Exited);
+    CHECK(info == 3);
+    close(sockfd);
+}
@@ -0,0 +1,139 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "source_stepper.hpp"
+#include "test_common.hpp"
+
+namespace
+{
+    std::uint32_t find_source_line(std::string_view file, std::string_view text)
+    {
+        std::ifstream src{std::string(file)};
+        std::string line;
+        for (std::uint32_t n = 1; std::getline(src, line); n++)
+        {
+            if (line.find(text) != std::string::npos)
+                return n;
+        }
+        return 0;
+    }
+
+    std::string function_at(Process &proc, virt_addr pc)
+    {
+        auto sym = proc.symbolize(pc);
+        return sym ? std::string(sym->first->name) : std::string();
+    }
+}
+
+TEST_CASE("Branch classification")
+{
+    virt_addr target = 0;
+    CHECK(classify_branch(0x14000002, 0x1000, target) == BranchKind::Direct);
+    CHECK(target == 0x1008);
+    CHECK(classify_branch(0x97FFFFFF, 0x1000, target) == BranchKind::Call);
+    CHECK(target == 0xFFC);
+    CHECK(classify_branch(0x54000041, 0x1000, target) == BranchKind::Conditional);
+    CHECK(target == 0x1008);
+    CHECK(classify_branch(0xB4000060, 0x1000, target) == BranchKind::Conditional);
+    CHECK(target == 0x100C);
+    CHECK(classify_branch(0x36180080, 0x1000, target) == BranchKind::Conditional);
+    CHECK(target == 0x1010);
+
+    CHECK(classify_branch(0xD65F03C0, 0x1000, target) == BranchKind::Return);
+    CHECK(classify_branch(0xD65F0BFF, 0x1000, target) == BranchKind::Return);
+    CHECK(classify_branch(0xD63F0100, 0x1000, target) == BranchKind::CallIndirect);
+    CHECK(classify_branch(0xD61F0200, 0x1000, target) == BranchKind::Indirect);
+    // BLRAA x8, x9, BLRAAZ x8 and BRAA x16, x17
+    CHECK(classify_branch(0xD73F0909, 0x1000, target) == BranchKind::CallIndirect);
+    CHECK(classify_branch(0xD63F091F, 0x1000, target) == BranchKind::CallIndirect);
+    CHECK(classify_branch(0xD71F0A11, 0x1000, target) == BranchKind::Indirect);
+    CHECK(classify_branch(0xD503201F, 0x1000, target) == BranchKind::None);
+    CHECK(classify_branch(0x91000400, 0x1000, target) == BranchKind::None);
+}
+
+TEST_CASE("Source step, next and finish")
+{
+    std::vector<std::string_view> exec =
+    {
+        "nested"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr fn[4];
+    std::memcpy(fn, output.data(), sizeof(fn));
+
+    auto entry = proc->source_line(fn[3]);
+    REQUIRE(entry.has_value());
+    std::string file(entry->file);
+    std::uint32_t call_line = find_source_line(file, "total += depth1(i);");
+    REQUIRE(call_line != 0);
+
+    auto addresses = proc->line_addresses(file, call_line);
+    REQUIRE(addresses.empty() == false);
+    proc->create_breakpoint_site(addresses.front()).enable();
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == addresses.front());
+    proc->breakpoint_sites().remove_by_address(addresses.front());
+
+    // The three calls below run under one breakpoint, not step by step
+    SourceStepper stepper(*proc);
+    CHECK(stepper.step_over() == SIGTRAP);
+    CHECK(stepper.stops() < 16);
+    CHECK(function_at(*proc, proc->get_pc()) == "main");
+    auto after = proc->source_line(proc->get_pc());
+    REQUIRE(after.has_value());
+    CHECK(after->line != call_line);
+
+    // Back to the call of the second iteration and into it, past the
+    // prologue of depth1
+    for (int i = 0; i < 4 && function_at(*proc, proc->get_pc()) != "depth1"; i++)
+        REQUIRE(stepper.step_in() == SIGTRAP);
+    REQUIRE(function_at(*proc, proc->get_pc()) == "depth1");
+    CHECK(proc->get_pc() != fn[2]);
+    auto inside = proc->source_line(proc->get_pc());
+    REQUIRE(inside.has_value());
+    CHECK(inside->line == find_source_line(file, "return depth2(x) + 1;"));
+
+    CHECK(stepper.step_out() == SIGTRAP);
+    CHECK(stepper.stops() == 1);
+    CHECK(function_at(*proc, proc->get_pc()) == "main");
+    CHECK(proc->breakpoint_sites().empty());
+
+    proc->resume();
+    CHECK(proc->wait() == 16);
+    close(sockfd);
+}
@@ -0,0 +1,86 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Batched step through the dynamic loader")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    pid_t pid = proc->get_pid();
+    auto offset = get_entry_point_offset("hello");
+    auto entry = get_load_address(pid, offset);
+
+    SECTION("Count")
+    {
+        StepResult res = proc->step_instructions({1000, std::nullopt, std::nullopt});
+        CHECK(res.end == StepEnd::Count);
+        CHECK(res.steps == 1000);
+        CHECK(res.info == SIGTRAP);
+        CHECK(proc->get_state() == ProcessState::Stopped);
+    }
+
+    SECTION("Until and while")
+    {
+        StepResult res = proc->step_instructions({0, entry, std::nullopt});
+        REQUIRE(res.end == StepEnd::Until);
+        CHECK(res.steps > 1);
+        CHECK(proc->get_pc() == entry);
+
+        res = proc->step_instructions({0, std::nullopt, std::make_pair(entry, entry + 4)});
+        CHECK(res.end == StepEnd::Range);
+        CHECK(res.steps == 1);
+        CHECK(proc->get_pc() != entry);
+    }
+
+    SECTION("Breakpoint ends the batch")
+    {
+        proc->create_breakpoint_site(entry).enable();
+        StepResult res = proc->step_instructions({100000000, std::nullopt, std::nullopt});
+        REQUIRE(res.end == StepEnd::Breakpoint);
+        CHECK(proc->get_pc() == entry);
+
+        // Stepping on lifts the breakpoint like a plain step
+        res = proc->step_instructions({1, std::nullopt, std::nullopt});
+        CHECK(res.end == StepEnd::Count);
+        CHECK(proc->get_pc() != entry);
+    }
+
+    SECTION("Limits are required")
+    {
+        CHECK_THROWS_AS(proc->step_instructions({}), Error);
+    }
+
+    proc->resume();
+    proc->wait();
+    CHECK(proc->get_state() == ProcessState::Exited);
+}
@@ -0,0 +1,110 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "step_profiler.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Instruction classes")
+{
+    CHECK(classify_instruction(0xF9400020) == InsnClass::Load);    // ldr x0, [x1]
+    CHECK(classify_instruction(0x58000040) == InsnClass::Load);    // ldr x0, #8
+    CHECK(classify_instruction(0x3DC00020) == InsnClass::Load);    // ldr q0, [x1]
+    CHECK(classify_instruction(0xA8C17BFD) == InsnClass::Load);    // ldp x29, x30, [sp], #16
+    CHECK(classify_instruction(0xF9000020) == InsnClass::Store);   // str x0, [x1]
+    CHECK(classify_instruction(0xA9BF7BFD) == InsnClass::Store);   // stp x29, x30, [sp, #-16]!
+    CHECK(classify_instruction(0x14000000) == InsnClass::Branch);  // b .
+    CHECK(classify_instruction(0x94000000) == InsnClass::Branch);  // bl .
+    CHECK(classify_instruction(0xD65F03C0) == InsnClass::Branch);  // ret
+    CHECK(classify_instruction(0xD4000001) == InsnClass::System);  // svc #0
+    CHECK(classify_instruction(0xD503201F) == InsnClass::System);  // nop
+    CHECK(classify_instruction(0x1E622820) == InsnClass::Simd);    // fadd d0, d1, d2
+    CHECK(classify_instruction(0x91000420) == InsnClass::Other);   // add x0, x1, #1
+    CHECK(classify_instruction(0x8B020020) == InsnClass::Other);   // add x0, x1, x2
+}
+
+TEST_CASE("PC histogram grows and keeps counts")
+{
+    PcHistogram hist(16);
+    for (virt_addr pc = 0x1000; pc < 0x1000 + 4 * 1000; pc += 4)
+    {
+        bool inserted = false;
+        hist.find_or_insert(pc, inserted).count += pc;
+        REQUIRE(inserted);
+    }
+
+    bool inserted = true;
+    hist.find_or_insert(0x1000, inserted).count++;
+    CHECK_FALSE(inserted);
+    CHECK(hist.size() == 1000);
+
+    REQUIRE(hist.find(0x1004) != nullptr);
+    CHECK(hist.find(0x1004)->count == 0x1004);
+    CHECK(hist.find(0x1002) == nullptr);
+
+    auto sorted = hist.sorted();
+    REQUIRE(sorted.size() == 1000);
+    CHECK(sorted.front().pc == 0x1000 + 4 * 999);
+    CHECK(sorted.back().pc == 0x1000);
+    CHECK_THROWS_AS(hist.find_or_insert(0, inserted), Error);
+}
+
+TEST_CASE("Profile single steps up to the entry point")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+
+    auto entry = get_load_address(proc->get_pid(), get_entry_point_offset("hello"));
+
+    StepProfiler profiler(*proc);
+    StepResult res = profiler.run({0, entry, std::nullopt});
+    REQUIRE(res.end == StepEnd::Until);
+    CHECK(proc->get_pc() == entry);
+
+    // Every step is counted once, under its pc and its class
+    CHECK(profiler.total() == res.steps);
+    std::uint64_t by_class = 0;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(InsnClass::Count); i++)
+        by_class += profiler.class_count(static_cast<InsnClass>(i));
+    CHECK(by_class == res.steps);
+
+    std::uint64_t by_pc = 0;
+    for (const auto &entry : profiler.histogram().sorted())
+        by_pc += entry.count;
+    CHECK(by_pc == res.steps);
+
+    CHECK(profiler.class_count(InsnClass::Load) > 0);
+    CHECK(profiler.class_count(InsnClass::Store) > 0);
+    CHECK(profiler.class_count(InsnClass::Branch) > 0);
+    CHECK(profiler.histogram().find(entry) == nullptr);
+
+    proc->resume();
+    proc->wait();
+}
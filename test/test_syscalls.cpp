@@ -0,0 +1,233 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <linux/seccomp.h>
+#include <set>
+#include "process.hpp"
+#include "session.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("System call names and filter")
+{
+    CHECK(SyscallTracer::number("openat") == 56);
+    CHECK(SyscallTracer::number("write") == 64);
+    CHECK(SyscallTracer::number("clone3") == 435);
+    CHECK(SyscallTracer::number("nothing") == std::nullopt);
+    CHECK(SyscallTracer::name(93) == "exit");
+    CHECK(SyscallTracer::name(250).empty());
+    CHECK(SyscallTracer::arg_count(64) == 3);
+
+    CHECK(SyscallTracer::parse("read,write,read") == std::vector<int>{63, 64});
+    CHECK_THROWS_AS(SyscallTracer::parse("read,nothing"), Error);
+
+    // Arch check, a test per call jumping to the trace past the allow
+    auto prog = SyscallTracer::filter({63, 64, 221});
+    REQUIRE(prog.size() == 8);
+    CHECK(prog[4].k == 63);
+    CHECK(prog[4].jt == 2);
+    CHECK(prog[5].k == 64);
+    CHECK(prog[5].jt == 1);
+    CHECK(prog[6].k == SECCOMP_RET_ALLOW);
+    CHECK(prog[7].k == SECCOMP_RET_TRACE);
+}
+
+TEST_CASE("Latency histogram and descriptor totals")
+{
+    LatencyHistogram hist;
+    hist.add(0);
+    hist.add(1);
+    hist.add(3);
+    hist.add(1000);
+    hist.add(1023);
+    CHECK(hist.count == 5);
+    CHECK(hist.buckets[0] == 2);
+    CHECK(hist.buckets[1] == 1);
+    CHECK(hist.buckets[9] == 2);
+    CHECK(hist.max_ns == 1023);
+    CHECK(hist.percentile(0.5) == 4);
+    CHECK(hist.percentile(0.99) == 1023);
+
+    SyscallProfile profile;
+    auto start = std::chrono::steady_clock::now();
+    auto call = [&](int nr, int fd, std::int64_t ret, int us)
+    {
+        SyscallRecord record;
+        record.number = nr;
+        record.args[0] = static_cast<std::uint64_t>(fd);
+        record.ret = ret;
+        record.entered = start;
+        record.left = start + std::chrono::microseconds(us);
+        profile.add(record);
+    };
+    call(64, 1, 12, 5);
+    call(64, 1, 30, 7);
+    call(63, 3, -11, 2);
+    call(98, 0, 0, 100);
+
+    // Unfinished calls carry no latency
+    SyscallRecord open;
+    open.number = 63;
+    profile.add(open);
+
+    CHECK(profile.by_number().at(64).count == 2);
+    CHECK(profile.by_number().at(63).count == 1);
+    CHECK(profile.by_number().at(98).total_ns == 100000);
+
+    REQUIRE(profile.by_fd().size() == 2);
+    const FdStats &out = profile.by_fd().at({1, 64});
+    CHECK(out.bytes == 42);
+    CHECK(out.latency.count == 2);
+    CHECK(out.errors == 0);
+    CHECK(profile.by_fd().at({3, 63}).errors == 1);
+    CHECK(SyscallProfile::moves_data(98) == false);
+
+    profile.clear();
+    CHECK(profile.by_number().empty());
+}
+
+TEST_CASE("Seccomp filter stops only on traced calls")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+
+    int sockfd = -1;
+    LaunchOptions options;
+    options.comm = &sockfd;
+    options.trace_syscalls = SyscallTracer::parse("write,execve");
+    auto proc = Process::launch(exec, options);
+    REQUIRE(proc != nullptr);
+
+    // Exec cannot go through the filter
+    SyscallTracer &tracer = proc->syscalls();
+    CHECK(tracer.filtered() == std::vector<int>{64});
+    CHECK_THROWS_AS(tracer.enable({63}), Error);
+
+    tracer.enable();
+    proc->resume();
+    CHECK(proc->wait() == 0);
+    CHECK(proc->get_state() == ProcessState::Exited);
+
+    auto records = tracer.take();
+    REQUIRE(records.empty() == false);
+    CHECK(tracer.records().empty());
+
+    std::size_t written = 0;
+    for (const auto &record : records)
+    {
+        CHECK(record.number == 64);
+        CHECK(record.tid == proc->get_pid());
+        CHECK(record.args[0] == STDOUT_FILENO);
+        REQUIRE(record.ret.has_value());
+        CHECK(*record.ret > 0);
+        CHECK(record.left >= record.entered);
+        written += static_cast<std::size_t>(*record.ret);
+    }
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    CHECK(written == output.size());
+    close(sockfd);
+
+    // The profile saw the same calls
+    const SyscallProfile &profile = tracer.profile();
+    REQUIRE(profile.by_number().count(64) == 1);
+    CHECK(profile.by_number().at(64).count == records.size());
+    REQUIRE(profile.by_fd().count({STDOUT_FILENO, 64}) == 1);
+    CHECK(profile.by_fd().at({STDOUT_FILENO, 64}).bytes == written);
+}
+
+TEST_CASE("Tracing needs a launch filter")
+{
+    std::vector<std::string_view> exec =
+    {
+        "hello"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+    CHECK(proc->syscalls().filtered().empty());
+    CHECK_THROWS_AS(proc->syscalls().enable(), Error);
+    CHECK(proc->syscalls().enabled() == false);
+}
+
+TEST_CASE("Children of a filtered process are followed")
+{
+    std::vector<std::string_view> exec =
+    {
+        "forker"
+    };
+
+    // Detached, the children would see ENOSYS for every traced call
+    Session session;
+    int sockfd = -1;
+    LaunchOptions options;
+    options.comm = &sockfd;
+    options.trace_syscalls = SyscallTracer::parse("exit_group");
+    Process &proc = session.add(Process::launch(exec, options));
+    pid_t parent = proc.get_pid();
+    proc.syscalls().enable();
+
+    std::set<pid_t> followed;
+    session.on_follow([&](Process &child) { followed.insert(child.get_pid()); });
+
+    std::set<int> exit_codes;
+    proc.resume();
+    while (true)
+    {
+        std::uint8_t info = session.wait();
+        Process &current = *session.current();
+        if (current.get_state() == ProcessState::Exited)
+        {
+            if (current.get_pid() == parent)
+            {
+                CHECK(info == 7);
+                break;
+            }
+            exit_codes.insert(info);
+            continue;
+        }
+
+        // The raise of forker and its exec
+        REQUIRE(current.get_state() == ProcessState::Stopped);
+        REQUIRE(info == SIGTRAP);
+        current.resume();
+    }
+
+    CHECK(session.fork_policy() == ForkPolicy::Detach);
+    CHECK(followed.size() == 2);
+    CHECK(exit_codes == std::set<int>{1, 2});
+
+    // Each child went out through the inherited filter
+    for (pid_t pid : followed)
+    {
+        const auto &records = session.processes().at(pid)->syscalls().records();
+        REQUIRE(records.empty() == false);
+        CHECK(records.back().number == SyscallTracer::number("exit_group"));
+        CHECK(records.back().tid == pid);
+    }
+    close(sockfd);
+}
@@ -0,0 +1,250 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <set>
+#include <sys/syscall.h>
+
+#include "process.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Breakpoints are hit by every thread")
+{
+    std::vector<std::string_view> exec =
+    {
+        "threads"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    pid_t pid = proc->get_pid();
+    CHECK(proc->threads().size() == 1);
+    CHECK(proc->current_thread() == pid);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr marker;
+    std::memcpy(&marker, output.data(), sizeof(marker));
+    proc->create_breakpoint_site(marker).enable();
+
+    std::set<pid_t> hit_by;
+    while (true)
+    {
+        proc->resume();
+        std::uint8_t info = proc->wait();
+        if (proc->get_state() != ProcessState::Stopped)
+        {
+            CHECK(proc->get_state() == ProcessState::Exited);
+            CHECK(info == 4);
+            break;
+        }
+
+        REQUIRE(info == SIGTRAP);
+        pid_t tid = proc->current_thread();
+        CHECK(tid != pid);
+        CHECK(proc->get_pc() == marker);
+        hit_by.insert(tid);
+
+        // All stop, nothing else runs while one thread is reported
+        for (const auto &[id, thread] : proc->threads())
+            CHECK(thread.state == ProcessState::Stopped);
+
+        // The main thread sits elsewhere with its own registers
+        proc->select_thread(pid);
+        CHECK(proc->get_pc() != marker);
+        proc->select_thread(tid);
+        CHECK(proc->get_pc() == marker);
+    }
+
+    CHECK(hit_by.size() == 4);
+    close(sockfd);
+}
+
+TEST_CASE("Stepping moves only the current thread")
+{
+    std::vector<std::string_view> exec =
+    {
+        "threads"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr marker;
+    std::memcpy(&marker, output.data(), sizeof(marker));
+    proc->create_breakpoint_site(marker).enable();
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    pid_t tid = proc->current_thread();
+    REQUIRE(tid != proc->get_pid());
+
+    proc->select_thread(proc->get_pid());
+    virt_addr main_pc = proc->get_pc();
+    proc->select_thread(tid);
+
+    CHECK(proc->step_instruction() == SIGTRAP);
+    CHECK(proc->get_pc() == marker + 4);
+    CHECK(proc->current_thread() == tid);
+
+    proc->select_thread(proc->get_pid());
+    CHECK(proc->get_pc() == main_pc);
+
+    CHECK_THROWS_AS(proc->select_thread(1), Error);
+    close(sockfd);
+}
+
+TEST_CASE("Non-stop mode stops only the reporting thread")
+{
+    std::vector<std::string_view> exec =
+    {
+        "threads"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr marker;
+    std::memcpy(&marker, output.data(), sizeof(marker));
+    proc->create_breakpoint_site(marker).enable();
+    proc->set_non_stop(true);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    pid_t first = proc->current_thread();
+    CHECK(proc->get_pc() == marker);
+
+    // The main thread was never halted for the report
+    CHECK(proc->threads().at(proc->get_pid()).state == ProcessState::Running);
+
+    // Selecting a running thread is allowed and leaves it running
+    proc->select_thread(proc->get_pid());
+    CHECK(proc->get_state() == ProcessState::Running);
+    proc->select_thread(first);
+    CHECK(proc->get_state() == ProcessState::Stopped);
+
+    std::set<pid_t> hit_by = {first};
+    while (true)
+    {
+        // Only the current thread is continued each time
+        proc->resume();
+        std::uint8_t info = proc->wait();
+        if (proc->get_state() == ProcessState::Exited)
+        {
+            CHECK(info == 4);
+            break;
+        }
+
+        REQUIRE(info == SIGTRAP);
+        CHECK(proc->get_pc() == marker);
+        hit_by.insert(proc->current_thread());
+    }
+
+    CHECK(hit_by.size() == 4);
+    close(sockfd);
+}
+
+TEST_CASE("Injection at pc halts threads running in non-stop mode")
+{
+    std::vector<std::string_view> exec =
+    {
+        "threads"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == sizeof(virt_addr));
+
+    virt_addr marker;
+    std::memcpy(&marker, output.data(), sizeof(marker));
+    proc->create_breakpoint_site(marker).enable();
+    proc->set_non_stop(true);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == marker);
+    REQUIRE(proc->threads().at(proc->get_pid()).state == ProcessState::Running);
+
+    // Without a scratch page the stub goes over marker, which the
+    // other workers are about to run
+    REQUIRE(proc->scratch().stub_address() == 0);
+    auto code = proc->read_memory(marker, 8);
+    std::uint64_t ret = proc->inject_syscall(SYS_getpid);
+    CHECK(static_cast<pid_t>(ret) == proc->get_pid());
+    CHECK(proc->read_memory(marker, 8) == code);
+    CHECK(proc->get_pc() == marker);
+
+    // Whatever was halted for it runs again
+    CHECK(proc->threads().at(proc->get_pid()).state == ProcessState::Running);
+
+    std::set<pid_t> hit_by = {proc->current_thread()};
+    while (true)
+    {
+        proc->resume();
+        std::uint8_t info = proc->wait();
+        if (proc->get_state() == ProcessState::Exited)
+        {
+            CHECK(info == 4);
+            break;
+        }
+
+        REQUIRE(info == SIGTRAP);
+        CHECK(proc->get_pc() == marker);
+        hit_by.insert(proc->current_thread());
+    }
+
+    CHECK(hit_by.size() == 4);
+    close(sockfd);
+}
@@ -0,0 +1,230 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "unwinder.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Remembered CFI state brings the CFA back")
+{
+    // def_cfa sp+0
+    const std::vector<std::uint8_t> cie = {0x0c, 31, 0};
+
+    // An early return epilogue as GCC emits it for AArch64
+    const std::vector<std::uint8_t> fde =
+    {
+        0x41,               // stp x29, x30, [sp, -32]!
+        0x0e, 32,           // def_cfa_offset 32
+        0x9d, 4,            // offset x29, cfa-32
+        0x9e, 3,            // offset x30, cfa-24
+        0x43,               // mov x29, sp; cbz; ldp x29, x30, [sp], 32
+        0x0a,               // remember_state
+        0xde, 0xdd,         // restore x30, restore x29
+        0x0e, 0,            // def_cfa_offset 0
+        0x41,               // ret
+        0x0b,               // restore_state
+    };
+
+    auto decode = [&](virt_addr pc)
+    {
+        CfiRow row;
+        REQUIRE(CallFrameInfo::decode_instructions({cie, 0}, {fde, 0},
+            4, -8, 0, 0x1000, 0x1028, pc, row));
+        return row;
+    };
+
+    CfiRow body = decode(0x1008);
+    CHECK(body.cfa_reg == 31);
+    CHECK(body.cfa_offset == 32);
+    CHECK(body.regs[29].kind == RegisterRule::Offset);
+    CHECK(body.regs[29].value == -32);
+
+    CfiRow ret = decode(0x1010);
+    CHECK(ret.cfa_offset == 0);
+    CHECK(ret.regs[29].kind == RegisterRule::Same);
+    CHECK(ret.regs[30].kind == RegisterRule::Same);
+
+    // Past the early return the frame is as it was before the epilogue
+    CfiRow after = decode(0x1020);
+    CHECK(after.start == 0x1014);
+    CHECK(after.end == 0x1028);
+    CHECK(after.cfa_reg == 31);
+    CHECK(after.cfa_offset == 32);
+    CHECK(after.regs[29].kind == RegisterRule::Offset);
+    CHECK(after.regs[29].value == -32);
+    CHECK(after.regs[30].kind == RegisterRule::Offset);
+    CHECK(after.regs[30].value == -24);
+}
+
+TEST_CASE("Frame record backtrace")
+{
+    std::vector<std::string_view> exec =
+    {
+        "nested"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr fn[4];
+    std::memcpy(fn, output.data(), sizeof(fn));
+    virt_addr depth3 = fn[0], depth2 = fn[1], depth1 = fn[2], main_fn = fn[3];
+
+    proc->create_breakpoint_site(depth3).enable();
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == depth3);
+
+    // Past the prologue, the frame record of depth3 is in place
+    proc->step_instructions({2, std::nullopt, std::nullopt});
+
+    Unwinder &unwinder = proc->unwinder();
+    auto frames = unwinder.unwind();
+    CHECK(unwinder.last_reused() == false);
+    REQUIRE(frames.size() >= 4);
+    CHECK(frames[0].pc == proc->get_pc());
+    CHECK((frames[1].pc > depth2 && frames[1].pc < depth1));
+    CHECK((frames[2].pc > depth1 && frames[2].pc < main_fn));
+    CHECK(frames[3].pc > main_fn);
+
+    // Still in the same function, only the top frame is new
+    proc->step_instruction();
+    auto again = unwinder.unwind();
+    CHECK(unwinder.last_reused());
+    REQUIRE(again.size() == frames.size());
+    CHECK(again[0].pc == proc->get_pc());
+    for (std::size_t i = 1; i < frames.size(); i++)
+        CHECK(again[i].pc == frames[i].pc);
+
+    proc->breakpoint_sites().remove_by_address(depth3);
+    proc->resume();
+    CHECK(proc->wait() == 16);
+    close(sockfd);
+}
+
+TEST_CASE("Call frame information backtrace")
+{
+    std::vector<std::string_view> exec =
+    {
+        "nested"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr fn[4];
+    std::memcpy(fn, output.data(), sizeof(fn));
+    virt_addr depth3 = fn[0], depth2 = fn[1], depth1 = fn[2], main_fn = fn[3];
+
+    proc->create_breakpoint_site(depth3).enable();
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == depth3);
+
+    // Before the prologue x29 still heads depth2's caller chain,
+    // only CFI knows the return address is in x30
+    auto frames = proc->unwinder().unwind();
+    REQUIRE(frames.size() >= 4);
+    CHECK(frames[0].pc == depth3);
+    CHECK((frames[1].pc > depth2 && frames[1].pc < depth1));
+    CHECK((frames[2].pc > depth1 && frames[2].pc < main_fn));
+    CHECK(frames[3].pc > main_fn);
+
+    proc->breakpoint_sites().remove_by_address(depth3);
+    proc->resume();
+    CHECK(proc->wait() == 16);
+    close(sockfd);
+}
+
+TEST_CASE("Frames are not reused before the prologue of a callee")
+{
+    std::vector<std::string_view> exec =
+    {
+        "nested"
+    };
+
+    int sockfd = -1;
+    auto proc = Process::launch(exec, &sockfd);
+    REQUIRE(proc != nullptr);
+
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+
+    std::string output;
+    read_from_socket(sockfd, output);
+    REQUIRE(output.size() == 4 * sizeof(virt_addr));
+
+    virt_addr fn[4];
+    std::memcpy(fn, output.data(), sizeof(fn));
+    virt_addr depth3 = fn[0], depth2 = fn[1], depth1 = fn[2], main_fn = fn[3];
+
+    proc->create_breakpoint_site(depth2).enable();
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == depth2);
+
+    // Past the prologue, the frame record of depth2 is in place
+    proc->step_instructions({2, std::nullopt, std::nullopt});
+
+    Unwinder &unwinder = proc->unwinder();
+    auto frames = unwinder.unwind();
+    REQUIRE(frames.size() >= 3);
+    CHECK((frames[1].pc > depth1 && frames[1].pc < main_fn));
+
+    // x29 still points at the record of depth2, which must stay a frame
+    proc->breakpoint_sites().remove_by_address(depth2);
+    proc->create_breakpoint_site(depth3).enable();
+    proc->resume();
+    REQUIRE(proc->wait() == SIGTRAP);
+    REQUIRE(proc->get_pc() == depth3);
+
+    auto again = unwinder.unwind();
+    CHECK(unwinder.last_reused() == false);
+    REQUIRE(again.size() == frames.size() + 1);
+    CHECK(again[0].pc == depth3);
+    CHECK((again[1].pc > depth2 && again[1].pc < depth1));
+    CHECK((again[2].pc > depth1 && again[2].pc < main_fn));
+
+    proc->breakpoint_sites().remove_by_address(depth3);
+    proc->resume();
+    CHECK(proc->wait() == 16);
+    close(sockfd);
+}
@@ -0,0 +1,76 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Aniruddha Kawade
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include "process.hpp"
+#include "wall_sampler.hpp"
+#include "test_common.hpp"
+
+TEST_CASE("Wall clock samples halt and release the tracee")
+{
+    std::vector<std::string_view> exec =
+    {
+        "two_seconds"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+    pid_t pid = proc->get_pid();
+
+    WallClockSampler sampler(*proc, 100);
+    proc->resume();
+    sampler.run_for(std::chrono::milliseconds(300));
+
+    CHECK(sampler.interrupted() == false);
+    CHECK(sampler.rounds() > 5);
+    CHECK(sampler.samples() == sampler.rounds());
+    CHECK(sampler.round_cost() < std::chrono::milliseconds(10));
+
+    // main() is called from libc, so the walk gets past the leaf
+    bool has_caller = false;
+    for (const auto &[chain, count] : sampler.stacks())
+    {
+        REQUIRE(chain.empty() == false);
+        has_caller |= (chain.size() > 1);
+    }
+    CHECK(has_caller);
+
+    // Left running between rounds
+    CHECK(process_running(pid));
+    proc->wait();
+    CHECK(proc->get_state() == ProcessState::Exited);
+}
+
+TEST_CASE("Wall clock frequency is bounded")
+{
+    std::vector<std::string_view> exec =
+    {
+        "outta_here"
+    };
+
+    auto proc = Process::launch(exec);
+    REQUIRE(proc != nullptr);
+    CHECK_THROWS_AS(WallClockSampler(*proc, 0), Error);
+    CHECK_THROWS_AS(WallClockSampler(*proc, 1000000), Error);
+}